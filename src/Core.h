@@ -24,6 +24,19 @@
 	#define OS_UNKNOWN
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define SIMD_NEON
+#else
+    #define SIMD_NONE
+#endif
+
+// Kernels for wider instruction sets than the compiler targets are built with GCC/Clang target attributes and picked at runtime.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(SIMD_SSE2)
+    #define SIMD_DISPATCH
+#endif
+
 #ifdef OS_WINDOWS
     #define WIN32_LEAN_AND_MEAN
     #include <windows.h>
@@ -1,8 +1,39 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <new>
+#include <memory>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <bit>
+#include <tuple>
 
 #include "Core.h"
+#include "Memory.h"
+#include "Parallel.h"
+#include "FileSystem.h"
+
+#if defined(SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(SIMD_NEON)
+    #include <arm_neon.h>
+#endif
 
 typedef unsigned int uint;
 
@@ -18,6 +49,83 @@ namespace Sapphire
      */
     namespace DSA
     {
+        /*
+            @brief Implementation details of the DSA algorithms, not meant to be used directly.
+         */
+        namespace Detail
+        {
+            /*
+                @brief Vectorized kernels for arrays of integers and floats, defined in Sapphire.cpp.
+                Each kernel runs on the widest instruction set the CPU supports (AVX-512, AVX2 or SSE2), detected once at runtime.
+                Find returns size if the element is not found. MinIndex and MaxIndex take a non-empty array
+                and return the first index of the minimum or maximum, like a scalar scan would.
+             */
+            namespace Simd
+            {
+                template<typename T>
+                constexpr bool IS_SUPPORTED =
+            #ifdef SIMD_DISPATCH
+                    std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && (std::is_integral_v<T> || std::is_same_v<T, float> || std::is_same_v<T, double>) && sizeof(T) <= 8;
+            #else
+                    false;
+            #endif
+
+                // The fixed-width type the kernels take for T, with the same size, signedness and representation.
+                template<typename T>
+                using Canonical = std::conditional_t<std::is_floating_point_v<T>, T,
+                    std::conditional_t<sizeof(T) == 1, std::conditional_t<std::is_signed_v<T>, int8_t, uint8_t>,
+                    std::conditional_t<sizeof(T) == 2, std::conditional_t<std::is_signed_v<T>, int16_t, uint16_t>,
+                    std::conditional_t<sizeof(T) == 4, std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>,
+                    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>>>>;
+
+                size_t Find(const int8_t* arr, size_t size, int8_t elem);
+                size_t Find(const uint8_t* arr, size_t size, uint8_t elem);
+                size_t Find(const int16_t* arr, size_t size, int16_t elem);
+                size_t Find(const uint16_t* arr, size_t size, uint16_t elem);
+                size_t Find(const int32_t* arr, size_t size, int32_t elem);
+                size_t Find(const uint32_t* arr, size_t size, uint32_t elem);
+                size_t Find(const int64_t* arr, size_t size, int64_t elem);
+                size_t Find(const uint64_t* arr, size_t size, uint64_t elem);
+                size_t Find(const float* arr, size_t size, float elem);
+                size_t Find(const double* arr, size_t size, double elem);
+
+                size_t MinIndex(const int8_t* arr, size_t size);
+                size_t MinIndex(const uint8_t* arr, size_t size);
+                size_t MinIndex(const int16_t* arr, size_t size);
+                size_t MinIndex(const uint16_t* arr, size_t size);
+                size_t MinIndex(const int32_t* arr, size_t size);
+                size_t MinIndex(const uint32_t* arr, size_t size);
+                size_t MinIndex(const int64_t* arr, size_t size);
+                size_t MinIndex(const uint64_t* arr, size_t size);
+                size_t MinIndex(const float* arr, size_t size);
+                size_t MinIndex(const double* arr, size_t size);
+
+                size_t MaxIndex(const int8_t* arr, size_t size);
+                size_t MaxIndex(const uint8_t* arr, size_t size);
+                size_t MaxIndex(const int16_t* arr, size_t size);
+                size_t MaxIndex(const uint16_t* arr, size_t size);
+                size_t MaxIndex(const int32_t* arr, size_t size);
+                size_t MaxIndex(const uint32_t* arr, size_t size);
+                size_t MaxIndex(const int64_t* arr, size_t size);
+                size_t MaxIndex(const uint64_t* arr, size_t size);
+                size_t MaxIndex(const float* arr, size_t size);
+                size_t MaxIndex(const double* arr, size_t size);
+
+                enum class BitOp
+                {
+                    AND,
+                    OR,
+                    XOR,
+                    AND_NOT
+                };
+
+                // Word kernels of Bitset and RoaringBitmap, also defined when SIMD is unavailable, as plain loops.
+                // Bitwise sets dst[i] = a[i] op b[i], and dst may be a or b itself. PopCount counts the set bits of the words.
+                void Bitwise(BitOp op, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count);
+                size_t PopCount(const uint64_t* words, size_t count);
+            }
+        }
+
         /*
             @brief Returns the minimum of two values.
          !  Will throw an error if the value type is not comparable.
@@ -33,6 +141,7 @@ namespace Sapphire
         
         /*
             @brief Returns the index of the minimum value in an array in the given range.
+            Arrays of integers and floats are scanned with SIMD instructions, many elements at a time.
          !  Will throw an error if the value type in the array is not comparable.
             @param arr The array to search.
             @param start The start index of the range, inclusive.
@@ -48,12 +157,18 @@ namespace Sapphire
                 return -1;
             }
 
-            int minI = start;
-            for (int i = start + 1; i < end; i++)
+            if constexpr (Detail::Simd::IS_SUPPORTED<T>)
+            {
+                using C = Detail::Simd::Canonical<T>;
+                return (int)(start + Detail::Simd::MinIndex((const C*)arr + start, end - start));
+            }
+
+            uint minI = start;
+            for (uint i = start + 1; i < end; i++)
             {
                 if (arr[i] < arr[minI]) minI = i;
             }
-            return minI;
+            return (int)minI;
         }
 
         /*
@@ -84,6 +199,7 @@ namespace Sapphire
         
         /*
             @brief Returns the index of the maximum value in an array in the given range.
+            Arrays of integers and floats are scanned with SIMD instructions, many elements at a time.
          !  Will throw an error if the value type in the array is not comparable.
             @param arr The array to search.
             @param start The start index of the range, inclusive.
@@ -99,12 +215,18 @@ namespace Sapphire
                 return -1;
             }
 
-            int maxI = start;
-            for (int i = start + 1; i < end; i++)
+            if constexpr (Detail::Simd::IS_SUPPORTED<T>)
+            {
+                using C = Detail::Simd::Canonical<T>;
+                return (int)(start + Detail::Simd::MaxIndex((const C*)arr + start, end - start));
+            }
+
+            uint maxI = start;
+            for (uint i = start + 1; i < end; i++)
             {
                 if (arr[i] > arr[maxI]) maxI = i;
             }
-            return maxI;
+            return (int)maxI;
         }
 
         /*
@@ -133,9 +255,495 @@ namespace Sapphire
             *p_b = tmp;
         }
 
+        /*
+            @brief A function object that compares two values with operator<.
+            The default comparator of the DSA sorting algorithms.
+         */
+        template<typename T>
+        struct Less
+        {
+            bool operator()(const T& a, const T& b) const
+            {
+                return a < b;
+            }
+        };
+
+        /*
+            @brief A function object that compares two values with operator>.
+            Pass it to a sorting algorithm to sort in descending order.
+         */
+        template<typename T>
+        struct Greater
+        {
+            bool operator()(const T& a, const T& b) const
+            {
+                return a > b;
+            }
+        };
+
+        namespace Detail
+        {
+            // Hints the CPU to start loading the cache line holding p, without waiting for it.
+            inline void Prefetch(const void* p)
+            {
+            #if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(p);
+            #elif defined(SIMD_SSE2)
+                _mm_prefetch((const char*)p, _MM_HINT_T0);
+            #endif
+            }
+
+            // Counts the set bits of a word.
+            inline uint PopCount(uint64_t word)
+            {
+            #if defined(__GNUC__) || defined(__clang__)
+                return __builtin_popcountll(word);
+            #else
+                word = word - ((word >> 1) & 0x5555555555555555);
+                word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+                word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+                return (uint)((word * 0x0101010101010101) >> 56);
+            #endif
+            }
+
+            // Returns the index of the lowest set bit of a non-zero word.
+            inline uint TrailingZeros(uint64_t word)
+            {
+            #if defined(__GNUC__) || defined(__clang__)
+                return __builtin_ctzll(word);
+            #else
+                return PopCount((word & (0 - word)) - 1);
+            #endif
+            }
+
+            // Spreads every bit of a hash over the whole word, with the finalizer of MurmurHash3.
+            inline uint64_t MixHash(uint64_t hash)
+            {
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdULL;
+                hash ^= hash >> 33;
+                hash *= 0xc4ceb9fe1a85ec53ULL;
+                hash ^= hash >> 33;
+                return hash;
+            }
+
+            template<typename T>
+            void AppendBytes(std::string& bytes, const T& value)
+            {
+                bytes.append((const char*)&value, sizeof(T));
+            }
+
+            template<typename T>
+            T ReadBytes(const std::string& bytes, size_t offset)
+            {
+                T value;
+                std::memcpy(&value, bytes.data() + offset, sizeof(T));
+                return value;
+            }
+
+            // Returns the index of the (k + 1)th set bit of a word with more than k bits set.
+            inline uint SelectBit(uint64_t word, uint k)
+            {
+                for (uint i = 0; i < k; i++) word &= word - 1;
+                return TrailingZeros(word);
+            }
+
+            // Heaps larger than this sift with branches, which let the CPU start loading the next level before the
+            // comparisons resolve. Below it the data is cached, and conditional moves avoid the mispredictions instead.
+            constexpr size_t BRANCHLESS_HEAP_MAX_BYTES = 8 << 20;
+
+            // Target size of a BTreeMap node: a few cache lines, so a node search reads adjacent lines the prefetcher streams in.
+            constexpr size_t BTREE_NODE_BYTES = 512;
+
+            // Lookups interleaved by the batch searches, enough in flight to hide a trip to memory.
+            constexpr uint BATCH_GROUP_SIZE = 16;
+            // Below this many bytes a table is likely to be cached already, so batch lookups skip prefetching.
+            constexpr size_t BATCH_PREFETCH_MIN_BYTES = 1 << 20;
+
+            constexpr size_t INSERTION_SORT_THRESHOLD = 24;
+            constexpr size_t NINTHER_THRESHOLD = 128;
+            constexpr size_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+            constexpr size_t PARTITION_BLOCK_SIZE = 64;
+
+            // Branchless block partitioning only pays off when comparing is cheap and has no side effects.
+            template<typename T, typename Cmp>
+            constexpr bool IS_BRANCHLESS_COMPARE = std::is_arithmetic_v<T> &&
+                (std::is_same_v<Cmp, Less<T>> || std::is_same_v<Cmp, Greater<T>> || std::is_same_v<Cmp, std::less<T>> || std::is_same_v<Cmp, std::greater<T>>);
+
+            inline int Log2(size_t n)
+            {
+                int log = 0;
+                while (n >>= 1) log++;
+                return log;
+            }
+
+            template<typename T, typename Cmp>
+            void Sort2(T* a, T* b, Cmp& cmp)
+            {
+                if (cmp(*b, *a)) std::iter_swap(a, b);
+            }
+
+            template<typename T, typename Cmp>
+            void Sort3(T* a, T* b, T* c, Cmp& cmp)
+            {
+                Sort2(a, b, cmp);
+                Sort2(b, c, cmp);
+                Sort2(a, b, cmp);
+            }
+
+            template<typename T, typename Cmp>
+            void InsertionSort(T* begin, T* end, Cmp& cmp)
+            {
+                if (begin == end) return;
+
+                for (T* cur = begin + 1; cur != end; cur++)
+                {
+                    T* sift = cur;
+                    T* sift1 = cur - 1;
+                    if (cmp(*sift, *sift1))
+                    {
+                        T tmp = std::move(*sift);
+                        do
+                        {
+                            *sift-- = std::move(*sift1);
+                        } while (sift != begin && cmp(tmp, *--sift1));
+                        *sift = std::move(tmp);
+                    }
+                }
+            }
+
+            // Assumes the element before begin is not greater than any element in the range, so it can skip the bounds check.
+            template<typename T, typename Cmp>
+            void UnguardedInsertionSort(T* begin, T* end, Cmp& cmp)
+            {
+                if (begin == end) return;
+
+                for (T* cur = begin + 1; cur != end; cur++)
+                {
+                    T* sift = cur;
+                    T* sift1 = cur - 1;
+                    if (cmp(*sift, *sift1))
+                    {
+                        T tmp = std::move(*sift);
+                        do
+                        {
+                            *sift-- = std::move(*sift1);
+                        } while (cmp(tmp, *--sift1));
+                        *sift = std::move(tmp);
+                    }
+                }
+            }
+
+            // Insertion sort that gives up after moving PARTIAL_INSERTION_SORT_LIMIT elements, returning whether it finished.
+            template<typename T, typename Cmp>
+            bool PartialInsertionSort(T* begin, T* end, Cmp& cmp)
+            {
+                if (begin == end) return true;
+
+                size_t moved = 0;
+                for (T* cur = begin + 1; cur != end; cur++)
+                {
+                    T* sift = cur;
+                    T* sift1 = cur - 1;
+                    if (cmp(*sift, *sift1))
+                    {
+                        T tmp = std::move(*sift);
+                        do
+                        {
+                            *sift-- = std::move(*sift1);
+                        } while (sift != begin && cmp(tmp, *--sift1));
+                        *sift = std::move(tmp);
+                        moved += cur - sift;
+                    }
+                    if (moved > PARTIAL_INSERTION_SORT_LIMIT) return false;
+                }
+                return true;
+            }
+
+            template<typename T, typename Cmp>
+            void HeapSort(T* begin, T* end, Cmp& cmp)
+            {
+                std::make_heap(begin, end, cmp);
+                std::sort_heap(begin, end, cmp);
+            }
+
+            template<typename T>
+            void SwapOffsets(T* first, T* last, const ubyte* offsetsL, const ubyte* offsetsR, size_t count, bool useSwaps)
+            {
+                if (useSwaps)
+                {
+                    // Both sides have the same number of misplaced elements, so a cyclic permutation would not be cheaper.
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+                    }
+                }
+                else if (count > 0)
+                {
+                    T* l = first + offsetsL[0];
+                    T* r = last - offsetsR[0];
+                    T tmp(std::move(*l));
+                    *l = std::move(*r);
+                    for (size_t i = 1; i < count; i++)
+                    {
+                        l = first + offsetsL[i];
+                        *r = std::move(*l);
+                        r = last - offsetsR[i];
+                        *l = std::move(*r);
+                    }
+                    *r = std::move(tmp);
+                }
+            }
+
+            /*
+                @brief Partitions [begin, end) around *begin, putting elements equal to the pivot on the right.
+                Compares a block of elements at a time and records the misplaced ones in offset buffers,
+                so the comparisons compile to conditional increments instead of unpredictable branches (BlockQuicksort).
+                @return The pivot's final position, and whether the range was already partitioned.
+             */
+            template<typename T, typename Cmp>
+            std::pair<T*, bool> PartitionRightBranchless(T* begin, T* end, Cmp& cmp)
+            {
+                T pivot(std::move(*begin));
+                T* first = begin;
+                T* last = end;
+
+                // The median-of-3 guarantees an element >= pivot to the right, so this loop needs no bounds check.
+                while (cmp(*++first, pivot));
+                if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+                else while (!cmp(*--last, pivot));
+
+                bool alreadyPartitioned = first >= last;
+                if (!alreadyPartitioned)
+                {
+                    std::iter_swap(first, last);
+                    first++;
+
+                    alignas(64) ubyte offsetsL[PARTITION_BLOCK_SIZE];
+                    alignas(64) ubyte offsetsR[PARTITION_BLOCK_SIZE];
+                    T* baseL = first;
+                    T* baseR = last;
+                    size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+                    while (first < last)
+                    {
+                        size_t unknown = last - first;
+                        size_t splitL = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+                        size_t splitR = numR == 0 ? unknown - splitL : 0;
+
+                        size_t limitL = Min(splitL, PARTITION_BLOCK_SIZE);
+                        for (size_t i = 0; i < limitL; i++)
+                        {
+                            offsetsL[numL] = (ubyte)i;
+                            numL += !cmp(*first, pivot);
+                            first++;
+                        }
+
+                        size_t limitR = Min(splitR, PARTITION_BLOCK_SIZE);
+                        for (size_t i = 0; i < limitR; )
+                        {
+                            offsetsR[numR] = (ubyte)++i;
+                            numR += cmp(*--last, pivot);
+                        }
+
+                        size_t count = Min(numL, numR);
+                        SwapOffsets(baseL, baseR, offsetsL + startL, offsetsR + startR, count, numL == numR);
+                        numL -= count;
+                        numR -= count;
+                        startL += count;
+                        startR += count;
+                        if (numL == 0)
+                        {
+                            startL = 0;
+                            baseL = first;
+                        }
+                        if (numR == 0)
+                        {
+                            startR = 0;
+                            baseR = last;
+                        }
+                    }
+
+                    // One side still has misplaced elements, swap them past the other side's boundary.
+                    if (numL != 0)
+                    {
+                        while (numL--) std::iter_swap(baseL + offsetsL[startL + numL], --last);
+                        first = last;
+                    }
+                    if (numR != 0)
+                    {
+                        while (numR--) std::iter_swap(baseR - offsetsR[startR + numR], first++);
+                        last = first;
+                    }
+                }
+
+                T* pivotPos = first - 1;
+                *begin = std::move(*pivotPos);
+                *pivotPos = std::move(pivot);
+                return std::make_pair(pivotPos, alreadyPartitioned);
+            }
+
+            /*
+                @brief Partitions [begin, end) around *begin, putting elements equal to the pivot on the right.
+                @return The pivot's final position, and whether the range was already partitioned.
+             */
+            template<typename T, typename Cmp>
+            std::pair<T*, bool> PartitionRight(T* begin, T* end, Cmp& cmp)
+            {
+                T pivot(std::move(*begin));
+                T* first = begin;
+                T* last = end;
+
+                while (cmp(*++first, pivot));
+                if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+                else while (!cmp(*--last, pivot));
+
+                bool alreadyPartitioned = first >= last;
+                while (first < last)
+                {
+                    std::iter_swap(first, last);
+                    while (cmp(*++first, pivot));
+                    while (!cmp(*--last, pivot));
+                }
+
+                T* pivotPos = first - 1;
+                *begin = std::move(*pivotPos);
+                *pivotPos = std::move(pivot);
+                return std::make_pair(pivotPos, alreadyPartitioned);
+            }
+
+            /*
+                @brief Partitions [begin, end) around *begin, putting elements equal to the pivot on the left.
+                Used when the pivot equals the element before the range, so every element equal to it is already in place.
+                @return The pivot's final position.
+             */
+            template<typename T, typename Cmp>
+            T* PartitionLeft(T* begin, T* end, Cmp& cmp)
+            {
+                T pivot(std::move(*begin));
+                T* first = begin;
+                T* last = end;
+
+                while (cmp(pivot, *--last));
+                if (last + 1 == end) while (first < last && !cmp(pivot, *++first));
+                else while (!cmp(pivot, *++first));
+
+                while (first < last)
+                {
+                    std::iter_swap(first, last);
+                    while (cmp(pivot, *--last));
+                    while (!cmp(pivot, *++first));
+                }
+
+                T* pivotPos = last;
+                *begin = std::move(*pivotPos);
+                *pivotPos = std::move(pivot);
+                return pivotPos;
+            }
+
+            /*
+                @brief The pattern-defeating quicksort loop.
+                Recurses into the smaller partition and loops on the larger one, so the stack depth is O(log n).
+                @param badAllowed How many highly unbalanced partitions are tolerated before falling back to heap sort.
+                @param leftmost Whether the range starts at the beginning of the array, otherwise the element before it is a lower bound.
+             */
+            template<bool Branchless, typename T, typename Cmp>
+            void PdqSortLoop(T* begin, T* end, Cmp& cmp, int badAllowed, bool leftmost)
+            {
+                while (true)
+                {
+                    size_t size = end - begin;
+                    if (size < INSERTION_SORT_THRESHOLD)
+                    {
+                        if (leftmost) InsertionSort(begin, end, cmp);
+                        else UnguardedInsertionSort(begin, end, cmp);
+                        return;
+                    }
+
+                    // Move the median of 3 (or Tukey's ninther for large ranges) to the front as the pivot.
+                    size_t half = size / 2;
+                    if (size > NINTHER_THRESHOLD)
+                    {
+                        Sort3(begin, begin + half, end - 1, cmp);
+                        Sort3(begin + 1, begin + (half - 1), end - 2, cmp);
+                        Sort3(begin + 2, begin + (half + 1), end - 3, cmp);
+                        Sort3(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+                        std::iter_swap(begin, begin + half);
+                    }
+                    else Sort3(begin + half, begin, end - 1, cmp);
+
+                    // If the pivot equals the element before the range, the range has many equal elements:
+                    // put them all on the left in one pass, they need no further sorting.
+                    if (!leftmost && !cmp(*(begin - 1), *begin))
+                    {
+                        begin = PartitionLeft(begin, end, cmp) + 1;
+                        continue;
+                    }
+
+                    std::pair<T*, bool> result = Branchless ? PartitionRightBranchless(begin, end, cmp) : PartitionRight(begin, end, cmp);
+                    T* pivotPos = result.first;
+                    size_t sizeL = pivotPos - begin;
+                    size_t sizeR = end - (pivotPos + 1);
+
+                    if (sizeL < size / 8 || sizeR < size / 8)
+                    {
+                        if (--badAllowed == 0)
+                        {
+                            HeapSort(begin, end, cmp);
+                            return;
+                        }
+
+                        // Shuffle some elements around to break up patterns that produce bad pivots.
+                        if (sizeL >= INSERTION_SORT_THRESHOLD)
+                        {
+                            std::iter_swap(begin, begin + sizeL / 4);
+                            std::iter_swap(pivotPos - 1, pivotPos - sizeL / 4);
+                            if (sizeL > NINTHER_THRESHOLD)
+                            {
+                                std::iter_swap(begin + 1, begin + (sizeL / 4 + 1));
+                                std::iter_swap(begin + 2, begin + (sizeL / 4 + 2));
+                                std::iter_swap(pivotPos - 2, pivotPos - (sizeL / 4 + 1));
+                                std::iter_swap(pivotPos - 3, pivotPos - (sizeL / 4 + 2));
+                            }
+                        }
+                        if (sizeR >= INSERTION_SORT_THRESHOLD)
+                        {
+                            std::iter_swap(pivotPos + 1, pivotPos + (1 + sizeR / 4));
+                            std::iter_swap(end - 1, end - sizeR / 4);
+                            if (sizeR > NINTHER_THRESHOLD)
+                            {
+                                std::iter_swap(pivotPos + 2, pivotPos + (2 + sizeR / 4));
+                                std::iter_swap(pivotPos + 3, pivotPos + (3 + sizeR / 4));
+                                std::iter_swap(end - 2, end - (1 + sizeR / 4));
+                                std::iter_swap(end - 3, end - (2 + sizeR / 4));
+                            }
+                        }
+                    }
+                    else if (result.second && PartialInsertionSort(begin, pivotPos, cmp) && PartialInsertionSort(pivotPos + 1, end, cmp))
+                    {
+                        // No swaps were needed to partition, and both sides were (nearly) sorted already.
+                        return;
+                    }
+
+                    if (sizeL < sizeR)
+                    {
+                        PdqSortLoop<Branchless>(begin, pivotPos, cmp, badAllowed, leftmost);
+                        begin = pivotPos + 1;
+                        leftmost = false;
+                    }
+                    else
+                    {
+                        PdqSortLoop<Branchless>(pivotPos + 1, end, cmp, badAllowed, false);
+                        end = pivotPos;
+                    }
+                }
+            }
+        }
+
         /*
             @brief Searches an array for a given element using linear search.
             Works for all arrays, ideal for unsorted arrays.
+            Arrays of integers and floats are searched with SIMD instructions, many elements at a time.
             Runtime complexity: O(n)
             @param arr The array to search.
             @param size The size of the array.
@@ -145,9 +753,16 @@ namespace Sapphire
         template<typename T>
         int LinearSearch(T* arr, uint size, T elem)
         {
-            for (int i = 0; i < size; i++)
+            if constexpr (Detail::Simd::IS_SUPPORTED<T>)
+            {
+                using C = Detail::Simd::Canonical<T>;
+                size_t i = Detail::Simd::Find((const C*)arr, size, (C)elem);
+                return i == size ? -1 : (int)i;
+            }
+
+            for (uint i = 0; i < size; i++)
             {
-                if (arr[i] == elem) return i;
+                if (arr[i] == elem) return (int)i;
             }
             return -1;
         }
@@ -178,6 +793,131 @@ namespace Sapphire
             return -1;
         }
 
+        /*
+            @brief Searches a sorted array for many elements at once using binary search.
+            The searches advance in lockstep in groups, and each prefetches its next probe before the group moves on,
+            so the cache misses of a whole group overlap instead of stalling one search at a time.
+            Much faster than calling BinarySearch in a loop once the array does not fit in the cache.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(m log n)
+            @param arr The array to search.
+            @param size The size of the array.
+            @param elems The elements to search for.
+            @param count The number of elements to search for.
+            @param indices Receives, for each element, the index of its first occurrence in the array or -1 if it is not found.
+            @return The number of elements found.
+         */
+        template<typename T>
+        uint BinarySearchBatch(const T* arr, uint size, const T* elems, uint count, int* indices)
+        {
+            if (size == 0)
+            {
+                for (uint i = 0; i < count; i++) indices[i] = -1;
+                return 0;
+            }
+
+            uint found = 0;
+            uint bases[Detail::BATCH_GROUP_SIZE];
+            for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+            {
+                uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                const T* keys = elems + start;
+                for (uint k = 0; k < group; k++)
+                {
+                    bases[k] = 0;
+                    Detail::Prefetch(arr + size / 2);
+                }
+
+                // Every search in the group has the same remaining length, so they all probe at the same depth.
+                for (uint n = size; n > 1; )
+                {
+                    uint half = n / 2;
+                    n -= half;
+                    for (uint k = 0; k < group; k++)
+                    {
+                        uint base = arr[bases[k] + half] < keys[k] ? bases[k] + half : bases[k];
+                        bases[k] = base;
+                        Detail::Prefetch(arr + base + n / 2);
+                    }
+                }
+
+                for (uint k = 0; k < group; k++)
+                {
+                    uint i = bases[k] + (arr[bases[k]] < keys[k]);
+                    bool match = i < size && arr[i] == keys[k];
+                    indices[start + k] = match ? (int)i : -1;
+                    found += match;
+                }
+            }
+            return found;
+        }
+
+        namespace Detail
+        {
+            // The branchless search behind LowerBound and UpperBound. Prefetching both possible next probes hides the cache misses
+            // of arrays that do not fit in the cache, but costs more than it saves on arrays that do.
+            template<bool Upper, bool Prefetching, typename T>
+            uint BoundSearch(const T* arr, uint size, const T& elem)
+            {
+                uint base = 0;
+                for (uint n = size; n > 1; )
+                {
+                    uint half = n / 2;
+                    n -= half;
+                    if constexpr (Prefetching)
+                    {
+                        Prefetch(arr + base + n / 2);
+                        Prefetch(arr + base + half + n / 2);
+                    }
+                    bool right = Upper ? !(elem < arr[base + half]) : arr[base + half] < elem;
+                    base = right ? base + half : base;
+                }
+                return base + (Upper ? !(elem < arr[base]) : arr[base] < elem);
+            }
+
+            template<bool Upper, typename T>
+            uint BoundSearch(const T* arr, uint size, const T& elem)
+            {
+                if (size == 0) return 0;
+                if ((size_t)size * sizeof(T) > BATCH_PREFETCH_MIN_BYTES) return BoundSearch<Upper, true>(arr, size, elem);
+                return BoundSearch<Upper, false>(arr, size, elem);
+            }
+        }
+
+        /*
+            @brief Finds the first element of a sorted array that is not less than a given element.
+            Uses the same branchless search as BinarySearchBatch: each step picks the half with a conditional move
+            instead of a branch, so there are no mispredictions, and on arrays larger than the cache
+            both possible next probes are prefetched.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(log n)
+            @param arr The sorted array to search.
+            @param size The size of the array.
+            @param elem The element to search for.
+            @return The index of the first element >= elem, or size if there is none.
+         */
+        template<typename T>
+        uint LowerBound(const T* arr, uint size, const T& elem)
+        {
+            return Detail::BoundSearch<false>(arr, size, elem);
+        }
+
+        /*
+            @brief Finds the first element of a sorted array that is greater than a given element.
+            Uses the same branchless search as LowerBound.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(log n)
+            @param arr The sorted array to search.
+            @param size The size of the array.
+            @param elem The element to search for.
+            @return The index of the first element > elem, or size if there is none.
+         */
+        template<typename T>
+        uint UpperBound(const T* arr, uint size, const T& elem)
+        {
+            return Detail::BoundSearch<true>(arr, size, elem);
+        }
+
         /*
             @brief Searches an array for a given element using interpolation search.
             Only works for sorted arrays, ideal for uniformly distributed arrays.
@@ -216,7 +956,7 @@ namespace Sapphire
             @return True if the element is found, false otherwise.
          */
         template<typename T>
-        int Contains(T* arr, uint size, T elem)
+        bool Contains(T* arr, uint size, T elem)
         {
             return LinearSearch(arr, size, elem) != -1;
         }
@@ -260,94 +1000,595 @@ namespace Sapphire
             }
         }
 
-        /*
-            @brief Merges two sorted arrays into one sorted array.
-         !  Will throw an error if the value type in the array is not comparable.
-            Used as a helper function for MergeSort.
-            @param leftArr The left array to merge.
-            @param rightArr The right array to merge.
-            @param arr The array to merge into.
-            @param size The size of the arrays.
-         */
-        template<typename T>
-        void Merge(T* leftArr, T* rightArr, T* arr, uint size)
+        namespace Detail
         {
-            int leftSize = size / 2;
-            int rightSize = size - leftSize;
-            int i = 0, l = 0, r = 0;
+            constexpr size_t MIN_MERGE = 32;
+            constexpr size_t MIN_GALLOP = 7;
+            constexpr int MAX_RUN_STACK = 64;
 
-            while (l < leftSize && r < rightSize)
+            /*
+                @brief A stable, natural, galloping merge sort (TimSort).
+                Finds the runs already present in the array, widens short runs with binary insertion sort,
+                and merges them in a balanced order using one scratch buffer of at most half the array.
+                Merging switches to galloping (exponential search) while one run keeps winning,
+                so nearly-sorted arrays sort in close to linear time.
+             */
+            template<typename T, typename Cmp>
+            class MergeSorter
             {
-                if (leftArr[l] < rightArr[r])
+            public:
+                MergeSorter(T* arr, size_t size, T* buffer, Cmp& cmp) : m_arr(arr), m_size(size), m_buf(buffer), m_cmp(cmp)
                 {
-                    arr[i] = leftArr[l];
-                    i++;
-                    l++;
+                    m_ownsBuf = false;
+                    m_minGallop = MIN_GALLOP;
+                    m_runCount = 0;
                 }
-                else
+
+                MergeSorter(const MergeSorter&) = delete;
+                MergeSorter& operator=(const MergeSorter&) = delete;
+
+                ~MergeSorter()
                 {
-                    arr[i] = rightArr[r];
-                    i++;
-                    r++;
+                    if (m_ownsBuf) Memory::HeapAllocator<T>().deallocate(m_buf, m_size / 2);
                 }
-            }
 
-            while (l < leftSize)
-            {
-                arr[i] = leftArr[l];
-                i++;
-                l++;
-            }
+                void sort()
+                {
+                    if (m_size < 2) return;
+
+                    if (m_size < MIN_MERGE)
+                    {
+                        BinaryInsertionSort(m_arr, m_arr + m_size, m_arr + countRunAndMakeAscending(m_arr, m_arr + m_size), m_cmp);
+                        return;
+                    }
+
+                    size_t minRun = MinRunLength(m_size);
+                    T* lo = m_arr;
+                    size_t remaining = m_size;
+                    do
+                    {
+                        size_t runLen = countRunAndMakeAscending(lo, lo + remaining);
+                        if (runLen < minRun)
+                        {
+                            size_t force = Min(remaining, minRun);
+                            BinaryInsertionSort(lo, lo + force, lo + runLen, m_cmp);
+                            runLen = force;
+                        }
+
+                        m_runs[m_runCount++] = { (size_t)(lo - m_arr), runLen };
+                        mergeCollapse();
+
+                        lo += runLen;
+                        remaining -= runLen;
+                    } while (remaining != 0);
+
+                    while (m_runCount > 1)
+                    {
+                        int n = m_runCount - 2;
+                        if (n > 0 && m_runs[n - 1].len < m_runs[n + 1].len) n--;
+                        mergeAt(n);
+                    }
+                }
+
+            private:
+                struct Run
+                {
+                    size_t start;
+                    size_t len;
+                };
+
+                // Moves the elements left in the scratch buffer back into the array and destroys the buffer's contents,
+                // both when a merge finishes and when a comparison throws, so no element is ever lost.
+                struct BufferGuard
+                {
+                    T*& src;
+                    size_t& count;
+                    T* dest;
+                    T* buf;
+                    size_t bufCount;
+                    bool fromEnd;
+
+                    ~BufferGuard()
+                    {
+                        T* to = fromEnd ? dest - count : dest;
+                        std::move(src, src + count, to);
+                        std::destroy(buf, buf + bufCount);
+                    }
+                };
+
+                T* m_arr;
+                size_t m_size;
+                T* m_buf;
+                Cmp& m_cmp;
+                bool m_ownsBuf;
+                size_t m_minGallop;
+                Run m_runs[MAX_RUN_STACK];
+                int m_runCount;
+
+                static size_t MinRunLength(size_t n)
+                {
+                    size_t r = 0;
+                    while (n >= MIN_MERGE)
+                    {
+                        r |= n & 1;
+                        n >>= 1;
+                    }
+                    return n + r;
+                }
+
+                // Sorts [begin, end) given that [begin, sorted) is already sorted, inserting after equal elements to stay stable.
+                static void BinaryInsertionSort(T* begin, T* end, T* sorted, Cmp& cmp)
+                {
+                    if (sorted == begin) sorted++;
+                    for (; sorted < end; sorted++)
+                    {
+                        T pivot(std::move(*sorted));
+                        T* left = begin;
+                        T* right = sorted;
+                        while (left < right)
+                        {
+                            T* mid = left + (right - left) / 2;
+                            if (cmp(pivot, *mid)) right = mid;
+                            else left = mid + 1;
+                        }
+                        std::move_backward(left, sorted, sorted + 1);
+                        *left = std::move(pivot);
+                    }
+                }
+
+                // Returns the length of the run starting at begin, reversing it if it is strictly descending.
+                size_t countRunAndMakeAscending(T* begin, T* end)
+                {
+                    T* runEnd = begin + 1;
+                    if (runEnd == end) return 1;
+
+                    if (m_cmp(*runEnd++, *begin))
+                    {
+                        while (runEnd < end && m_cmp(*runEnd, *(runEnd - 1))) runEnd++;
+                        std::reverse(begin, runEnd);
+                    }
+                    else
+                    {
+                        while (runEnd < end && !m_cmp(*runEnd, *(runEnd - 1))) runEnd++;
+                    }
+
+                    return runEnd - begin;
+                }
+
+                // Merges runs until the stack lengths satisfy len[i - 2] > len[i - 1] + len[i] and len[i - 1] > len[i],
+                // which keeps merges balanced and the stack depth logarithmic.
+                void mergeCollapse()
+                {
+                    while (m_runCount > 1)
+                    {
+                        int n = m_runCount - 2;
+                        if ((n > 0 && m_runs[n - 1].len <= m_runs[n].len + m_runs[n + 1].len) ||
+                            (n > 1 && m_runs[n - 2].len <= m_runs[n].len + m_runs[n - 1].len))
+                        {
+                            if (m_runs[n - 1].len < m_runs[n + 1].len) n--;
+                        }
+                        else if (m_runs[n].len > m_runs[n + 1].len) break;
+                        mergeAt(n);
+                    }
+                }
+
+                // Returns the position in the sorted range a[0, len) to insert key before any equal elements, searching out from hint.
+                ptrdiff_t gallopLeft(const T& key, const T* a, ptrdiff_t len, ptrdiff_t hint)
+                {
+                    ptrdiff_t lastOfs = 0, ofs = 1;
+                    if (m_cmp(a[hint], key))
+                    {
+                        ptrdiff_t maxOfs = len - hint;
+                        while (ofs < maxOfs && m_cmp(a[hint + ofs], key))
+                        {
+                            lastOfs = ofs;
+                            ofs = (ofs << 1) + 1;
+                        }
+                        if (ofs > maxOfs) ofs = maxOfs;
+                        lastOfs += hint;
+                        ofs += hint;
+                    }
+                    else
+                    {
+                        ptrdiff_t maxOfs = hint + 1;
+                        while (ofs < maxOfs && !m_cmp(a[hint - ofs], key))
+                        {
+                            lastOfs = ofs;
+                            ofs = (ofs << 1) + 1;
+                        }
+                        if (ofs > maxOfs) ofs = maxOfs;
+                        ptrdiff_t tmp = lastOfs;
+                        lastOfs = hint - ofs;
+                        ofs = hint - tmp;
+                    }
+
+                    lastOfs++;
+                    while (lastOfs < ofs)
+                    {
+                        ptrdiff_t mid = lastOfs + (ofs - lastOfs) / 2;
+                        if (m_cmp(a[mid], key)) lastOfs = mid + 1;
+                        else ofs = mid;
+                    }
+                    return ofs;
+                }
+
+                // Returns the position in the sorted range a[0, len) to insert key after any equal elements, searching out from hint.
+                ptrdiff_t gallopRight(const T& key, const T* a, ptrdiff_t len, ptrdiff_t hint)
+                {
+                    ptrdiff_t lastOfs = 0, ofs = 1;
+                    if (m_cmp(key, a[hint]))
+                    {
+                        ptrdiff_t maxOfs = hint + 1;
+                        while (ofs < maxOfs && m_cmp(key, a[hint - ofs]))
+                        {
+                            lastOfs = ofs;
+                            ofs = (ofs << 1) + 1;
+                        }
+                        if (ofs > maxOfs) ofs = maxOfs;
+                        ptrdiff_t tmp = lastOfs;
+                        lastOfs = hint - ofs;
+                        ofs = hint - tmp;
+                    }
+                    else
+                    {
+                        ptrdiff_t maxOfs = len - hint;
+                        while (ofs < maxOfs && !m_cmp(key, a[hint + ofs]))
+                        {
+                            lastOfs = ofs;
+                            ofs = (ofs << 1) + 1;
+                        }
+                        if (ofs > maxOfs) ofs = maxOfs;
+                        lastOfs += hint;
+                        ofs += hint;
+                    }
+
+                    lastOfs++;
+                    while (lastOfs < ofs)
+                    {
+                        ptrdiff_t mid = lastOfs + (ofs - lastOfs) / 2;
+                        if (m_cmp(key, a[mid])) ofs = mid;
+                        else lastOfs = mid + 1;
+                    }
+                    return ofs;
+                }
+
+                T* buffer()
+                {
+                    if (m_buf == nullptr)
+                    {
+                        m_buf = Memory::HeapAllocator<T>().allocate(m_size / 2);
+                        m_ownsBuf = true;
+                    }
+                    return m_buf;
+                }
+
+                // Merges the runs at stack positions i and i + 1.
+                void mergeAt(int i)
+                {
+                    T* base1 = m_arr + m_runs[i].start;
+                    size_t len1 = m_runs[i].len;
+                    T* base2 = m_arr + m_runs[i + 1].start;
+                    size_t len2 = m_runs[i + 1].len;
+
+                    m_runs[i].len = len1 + len2;
+                    if (i == m_runCount - 3) m_runs[i + 1] = m_runs[i + 2];
+                    m_runCount--;
+
+                    // Elements of run 1 that are not greater than run 2's first element, and elements of run 2 that are
+                    // not less than run 1's last element, are already in place.
+                    size_t k = gallopRight(*base2, base1, len1, 0);
+                    base1 += k;
+                    len1 -= k;
+                    if (len1 == 0) return;
+
+                    len2 = gallopLeft(base1[len1 - 1], base2, len2, len2 - 1);
+                    if (len2 == 0) return;
+
+                    if (len1 <= len2) mergeLo(base1, len1, base2, len2);
+                    else mergeHi(base1, len1, base2, len2);
+                }
+
+                // Merges two adjacent runs left to right, buffering the first (smaller) run.
+                void mergeLo(T* base1, size_t len1, T* base2, size_t len2)
+                {
+                    T* buf = buffer();
+                    std::uninitialized_move(base1, base1 + len1, buf);
+
+                    T* cursor1 = buf;
+                    T* cursor2 = base2;
+                    T* dest = base1;
+                    size_t minGallop = m_minGallop;
+                    {
+                        BufferGuard guard{ cursor1, len1, dest, buf, len1, false };
+
+                        *dest++ = std::move(*cursor2++);
+                        if (--len2 == 0)
+                        {
+                            guard.dest = dest;
+                            return;
+                        }
+                        if (len1 == 1)
+                        {
+                            dest = std::move(cursor2, cursor2 + len2, dest);
+                            guard.dest = dest;
+                            return;
+                        }
+
+                        while (true)
+                        {
+                            size_t count1 = 0, count2 = 0;
+                            guard.dest = dest;
+
+                            // Merge one element at a time until one run starts winning consistently.
+                            do
+                            {
+                                if (m_cmp(*cursor2, *cursor1))
+                                {
+                                    *dest++ = std::move(*cursor2++);
+                                    count2++;
+                                    count1 = 0;
+                                    guard.dest = dest;
+                                    if (--len2 == 0) goto done;
+                                }
+                                else
+                                {
+                                    *dest++ = std::move(*cursor1++);
+                                    len1--;
+                                    count1++;
+                                    count2 = 0;
+                                    guard.dest = dest;
+                                    if (len1 == 1) goto done;
+                                }
+                            } while ((count1 | count2) < minGallop);
+
+                            // Then gallop, moving whole stretches at once, until neither run wins often enough.
+                            do
+                            {
+                                count1 = gallopRight(*cursor2, cursor1, len1, 0);
+                                if (count1 != 0)
+                                {
+                                    dest = std::move(cursor1, cursor1 + count1, dest);
+                                    cursor1 += count1;
+                                    len1 -= count1;
+                                    guard.dest = dest;
+                                    if (len1 <= 1) goto done;
+                                }
+                                *dest++ = std::move(*cursor2++);
+                                guard.dest = dest;
+                                if (--len2 == 0) goto done;
+
+                                count2 = gallopLeft(*cursor1, cursor2, len2, 0);
+                                if (count2 != 0)
+                                {
+                                    dest = std::move(cursor2, cursor2 + count2, dest);
+                                    cursor2 += count2;
+                                    len2 -= count2;
+                                    guard.dest = dest;
+                                    if (len2 == 0) goto done;
+                                }
+                                *dest++ = std::move(*cursor1++);
+                                len1--;
+                                guard.dest = dest;
+                                if (len1 == 1) goto done;
+
+                                if (minGallop > 0) minGallop--;
+                            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+                            minGallop += 2;
+                        }
+
+                    done:
+                        m_minGallop = Max(minGallop, (size_t)1);
+                        if (len1 == 1)
+                        {
+                            dest = std::move(cursor2, cursor2 + len2, dest);
+                            guard.dest = dest;
+                        }
+                    }
+                }
+
+                // Merges two adjacent runs right to left, buffering the second (smaller) run.
+                void mergeHi(T* base1, size_t len1, T* base2, size_t len2)
+                {
+                    T* buf = buffer();
+                    std::uninitialized_move(base2, base2 + len2, buf);
+
+                    // Cursors point one past the next element to take, and dest one past the next slot to fill.
+                    T* cursor1 = base1 + len1;
+                    T* bufStart = buf;
+                    T* cursor2 = buf + len2;
+                    T* dest = base2 + len2;
+                    size_t minGallop = m_minGallop;
+                    {
+                        BufferGuard guard{ bufStart, len2, dest, buf, len2, true };
+
+                        *--dest = std::move(*--cursor1);
+                        guard.dest = dest;
+                        if (--len1 == 0) return;
+                        if (len2 == 1)
+                        {
+                            dest = std::move_backward(cursor1 - len1, cursor1, dest);
+                            guard.dest = dest;
+                            return;
+                        }
+
+                        while (true)
+                        {
+                            size_t count1 = 0, count2 = 0;
+
+                            do
+                            {
+                                if (m_cmp(*(cursor2 - 1), *(cursor1 - 1)))
+                                {
+                                    *--dest = std::move(*--cursor1);
+                                    count1++;
+                                    count2 = 0;
+                                    guard.dest = dest;
+                                    if (--len1 == 0) goto done;
+                                }
+                                else
+                                {
+                                    *--dest = std::move(*--cursor2);
+                                    len2--;
+                                    count2++;
+                                    count1 = 0;
+                                    guard.dest = dest;
+                                    if (len2 == 1) goto done;
+                                }
+                            } while ((count1 | count2) < minGallop);
+
+                            do
+                            {
+                                count1 = len1 - gallopRight(*(cursor2 - 1), base1, len1, len1 - 1);
+                                if (count1 != 0)
+                                {
+                                    dest = std::move_backward(cursor1 - count1, cursor1, dest);
+                                    cursor1 -= count1;
+                                    len1 -= count1;
+                                    guard.dest = dest;
+                                    if (len1 == 0) goto done;
+                                }
+                                *--dest = std::move(*--cursor2);
+                                len2--;
+                                guard.dest = dest;
+                                if (len2 == 1) goto done;
+
+                                count2 = len2 - gallopLeft(*(cursor1 - 1), buf, len2, len2 - 1);
+                                if (count2 != 0)
+                                {
+                                    dest = std::move_backward(cursor2 - count2, cursor2, dest);
+                                    cursor2 -= count2;
+                                    len2 -= count2;
+                                    guard.dest = dest;
+                                    if (len2 <= 1) goto done;
+                                }
+                                *--dest = std::move(*--cursor1);
+                                guard.dest = dest;
+                                if (--len1 == 0) goto done;
+
+                                if (minGallop > 0) minGallop--;
+                            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+                            minGallop += 2;
+                        }
+
+                    done:
+                        m_minGallop = Max(minGallop, (size_t)1);
+                        if (len2 == 1)
+                        {
+                            dest = std::move_backward(cursor1 - len1, cursor1, dest);
+                            guard.dest = dest;
+                        }
+                    }
+                }
+            };
+        }
 
-            while (r < rightSize)
+        /*
+            @brief Merges two sorted arrays into one sorted array, moving the elements.
+            Stable: equal elements keep their order, with those from the left array first.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n)
+            @param left The left array to merge.
+            @param leftSize The size of the left array.
+            @param right The right array to merge.
+            @param rightSize The size of the right array.
+            @param arr The array to merge into, with room for leftSize + rightSize elements.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void Merge(T* left, uint leftSize, T* right, uint rightSize, T* arr, Cmp cmp)
+        {
+            uint l = 0, r = 0;
+            while (l < leftSize && r < rightSize)
             {
-                arr[i] = rightArr[r];
-                i++;
-                r++;
+                if (cmp(right[r], left[l])) *arr++ = std::move(right[r++]);
+                else *arr++ = std::move(left[l++]);
             }
+
+            arr = std::move(left + l, left + leftSize, arr);
+            std::move(right + r, right + rightSize, arr);
+        }
+
+        /*
+            @brief Merges two sorted arrays into one sorted array, moving the elements.
+         !  Will throw an error if the value type in the array is not comparable.
+            @param leftArr The left array to merge, of size size / 2.
+            @param rightArr The right array to merge, of size size - size / 2.
+            @param arr The array to merge into.
+            @param size The size of the arrays.
+         */
+        template<typename T>
+        void Merge(T* leftArr, T* rightArr, T* arr, uint size)
+        {
+            Merge(leftArr, size / 2, rightArr, size - size / 2, arr, Less<T>());
+        }
+
+        /*
+            @brief Sorts an array using a stable, natural merge sort (TimSort).
+            Merges the runs already present in the array, galloping through long stretches,
+            so nearly-sorted arrays sort in close to linear time.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param buffer Uninitialized storage for at least size / 2 elements to merge through.
+            Pass nullptr to have one allocated (only if the array is not already sorted).
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void MergeSort(T* arr, uint size, std::type_identity_t<T>* buffer, Cmp cmp)
+        {
+            Detail::MergeSorter<T, Cmp>(arr, size, buffer, cmp).sort();
         }
 
         /*
-            @brief Sorts an array using the merge sort algorithm.
-            Ideal for larger arrays.
+            @brief Sorts an array in ascending order using a stable, natural merge sort (TimSort).
          !  Will throw an error if the value type in the array is not comparable.
-            Runtime complexity: O(n log n)
+            Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
             Space complexity: O(n)
             @param arr The array to sort.
             @param size The size of the array.
+            @param buffer Uninitialized storage for at least size / 2 elements to merge through.
+            Pass nullptr to have one allocated (only if the array is not already sorted).
          */
         template<typename T>
-        void MergeSort(T* arr, uint size)
+        void MergeSort(T* arr, uint size, std::type_identity_t<T>* buffer)
         {
-            if (size <= 1) return;
-
-            int mid = size / 2;
-            int* leftArr = new int[mid];
-            int* rightArr = new int[size - mid];
-
-            int i = 0, j = 0;
-
-            for (; i < size; i++)
-            {
-                if (i < mid) leftArr[i] = arr[i];
-                else 
-                {
-                    rightArr[j] = arr[i];
-                    j++;
-                }
-            }
+            MergeSort(arr, size, buffer, Less<T>());
+        }
 
-            MergeSort(leftArr, mid);
-            MergeSort(rightArr, size - mid);
-            Merge(leftArr, rightArr, arr, size);
+        /*
+            @brief Sorts an array using a stable, natural merge sort (TimSort).
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void MergeSort(T* arr, uint size, Cmp cmp) requires std::is_invocable_v<Cmp&, const T&, const T&>
+        {
+            MergeSort(arr, size, (T*)nullptr, cmp);
+        }
 
-            delete[] leftArr;
-            delete[] rightArr;
+        /*
+            @brief Sorts an array in ascending order using a stable, natural merge sort (TimSort).
+            Ideal for larger arrays, and for arrays that are already partly sorted.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+         */
+        template<typename T>
+        void MergeSort(T* arr, uint size)
+        {
+            MergeSort(arr, size, (T*)nullptr, Less<T>());
         }
 
         /*
-            @brief Partitions an array and generates a pivot.
-            Used as a helper function for QuickSort.
+            @brief Partitions an array around its last element, using the Lomuto scheme.
          !  Will throw an error if the value type in the array is not comparable.
             @param arr The array to partition.
             @param start The start index of the partition.
@@ -374,925 +1615,11592 @@ namespace Sapphire
         }
 
         /*
-            @brief Sorts an array using the quick sort algorithm.
-            Ideal for smaller arrays.
+            @brief Sorts an array using pattern-defeating quick sort (pdqsort).
+            Picks median-of-3 or ninther pivots, partitions arithmetic types branchlessly in blocks,
+            finishes small ranges with insertion sort, and falls back to heap sort after too many bad partitions.
+            Sorted, reversed and all-equal arrays take linear time.
+            Not stable.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n log n) worst case
+            Space complexity: O(log n)
+            @param arr The array to sort.
+            @param start The start index of the array.
+            @param end The end index of the array, inclusive.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void QuickSort(T* arr, int start, int end, Cmp cmp)
+        {
+            if (start >= end) return;
+            size_t size = (size_t)(end - start) + 1;
+            Detail::PdqSortLoop<Detail::IS_BRANCHLESS_COMPARE<T, Cmp>>(arr + start, arr + end + 1, cmp, Detail::Log2(size), true);
+        }
+
+        /*
+            @brief Sorts an array in ascending order using pattern-defeating quick sort (pdqsort).
+            Ideal for most arrays.
          !  Will throw an error if the value type in the array is not comparable.
-            Runtime complexity: O(n log n)
+            Runtime complexity: O(n log n) worst case
             Space complexity: O(log n)
             @param arr The array to sort.
             @param start The start index of the array.
-            @param end The end index of the array.
+            @param end The end index of the array, inclusive.
          */
         template<typename T>
         void QuickSort(T* arr, int start, int end) 
         {
-            if (start < end) 
-            {
-                int pivot = Partition(arr, start, end);
-                QuickSort(arr, start, pivot - 1);
-                QuickSort(arr, pivot + 1, end);
-            }
+            QuickSort(arr, start, end, Less<T>());
         }
 
         /*
-            @brief Sorts an array using the quick sort algorithm.
-            Ideal for smaller arrays.
-         !  Will throw an error if the value type in the array is not comparable.
-            Runtime complexity: O(n log n)
+            @brief Sorts an array using pattern-defeating quick sort (pdqsort).
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n log n) worst case
             Space complexity: O(log n)
             @param arr The array to sort.
             @param size The size of the array.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
          */
-        template<typename T>
-        void QuickSort(T* arr, uint size)
+        template<typename T, typename Cmp>
+        void QuickSort(T* arr, uint size, Cmp cmp)
         {
-             QuickSort(arr, 0, size - 1);
+            if (size > 1) QuickSort(arr, 0, (int)size - 1, cmp);
         }
 
         /*
-            @brief A class to represent a fixed-size array.
+            @brief Sorts an array in ascending order using pattern-defeating quick sort (pdqsort).
+            Ideal for most arrays.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n log n) worst case
+            Space complexity: O(log n)
+            @param arr The array to sort.
+            @param size The size of the array.
          */
         template<typename T>
-        class Array
+        void QuickSort(T* arr, uint size)
         {
-        public:
-            /*
-                @brief Creates an empty array.
-             */
-            Array()
-            {
-                m_arr = new T[0];
-                m_size = 0;
-            }
+            QuickSort(arr, size, Less<T>());
+        }
+
+        namespace Detail
+        {
+            // Partitions that keep more than 7/8 of the range tolerated before selection switches to median of medians.
+            constexpr int SELECT_BAD_ALLOWED = 4;
+            // Below n / PARTIAL_SORT_HEAP_DIVISOR elements, keeping a heap of the best k in one pass beats selecting them.
+            constexpr size_t PARTIAL_SORT_HEAP_DIVISOR = 1024;
 
             /*
-                @brief Creates an array of a given size.
-                @param size The size of the array.
+                @brief Moves the median of medians of groups of 5 to the front of [begin, end), for a pivot that
+                leaves at least 3/10 of the range on each side.
+                The group medians are gathered at the front and their median found with SelectLoop, which keeps selection O(n).
              */
-            Array(uint size)
+            template<bool Branchless, typename T, typename Cmp>
+            void SelectLoop(T* begin, T* nth, T* end, Cmp& cmp, bool leftmost);
+
+            template<bool Branchless, typename T, typename Cmp>
+            void MedianOfMedians(T* begin, T* end, Cmp& cmp)
             {
-                m_arr = new T[size];
-                m_size = size;
+                size_t groups = (size_t)(end - begin) / 5;
+                for (size_t i = 0; i < groups; i++)
+                {
+                    T* group = begin + i * 5;
+                    InsertionSort(group, group + 5, cmp);
+                    std::iter_swap(begin + i, group + 2);
+                }
+                SelectLoop<Branchless>(begin, begin + groups / 2, begin + groups, cmp, true);
+                std::iter_swap(begin, begin + groups / 2);
             }
 
-            
             /*
-                @brief Creates an array from a given array.
-                @param arr The array to copy.
-                @param size The size of the array.
+                @brief Introselect on the pdqsort partitions: puts the element that belongs at nth in its place,
+                with no greater element before it and no smaller element after it.
+                Picks median-of-3 or ninther pivots, and switches to median of medians after too many partitions
+                that keep most of the range, so it takes O(n) time even on adversarial input.
+                @param leftmost Whether the range starts at the beginning of the array, otherwise the element before it is a lower bound.
              */
-            Array(T* arr, uint size)
+            template<bool Branchless, typename T, typename Cmp>
+            void SelectLoop(T* begin, T* nth, T* end, Cmp& cmp, bool leftmost)
             {
-                m_arr = new T[size];
-                m_size = size;
-                for (int i = 0; i < size; i++)
+                int badAllowed = SELECT_BAD_ALLOWED;
+                while (true)
                 {
-                    m_arr[i] = arr[i];
+                    size_t size = end - begin;
+                    if (size < INSERTION_SORT_THRESHOLD)
+                    {
+                        if (leftmost) InsertionSort(begin, end, cmp);
+                        else UnguardedInsertionSort(begin, end, cmp);
+                        return;
+                    }
+
+                    // Median of medians leaves two elements not less than the pivot in the pivot's group,
+                    // which the unguarded scans of the partitions rely on just like they do on the median of 3.
+                    size_t half = size / 2;
+                    if (badAllowed == 0) MedianOfMedians<Branchless>(begin, end, cmp);
+                    else if (size > NINTHER_THRESHOLD)
+                    {
+                        Sort3(begin, begin + half, end - 1, cmp);
+                        Sort3(begin + 1, begin + (half - 1), end - 2, cmp);
+                        Sort3(begin + 2, begin + (half + 1), end - 3, cmp);
+                        Sort3(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+                        std::iter_swap(begin, begin + half);
+                    }
+                    else Sort3(begin + half, begin, end - 1, cmp);
+
+                    // Every element equal to the pivot and the element before the range goes on the left,
+                    // where they are all in their sorted place already.
+                    if (!leftmost && !cmp(*(begin - 1), *begin))
+                    {
+                        T* pivotPos = PartitionLeft(begin, end, cmp);
+                        if (nth <= pivotPos) return;
+                        begin = pivotPos + 1;
+                        continue;
+                    }
+
+                    T* pivotPos = (Branchless ? PartitionRightBranchless(begin, end, cmp) : PartitionRight(begin, end, cmp)).first;
+                    if (pivotPos == nth) return;
+
+                    size_t kept = nth < pivotPos ? pivotPos - begin : end - (pivotPos + 1);
+                    if (kept > size - size / 8 && badAllowed > 0) badAllowed--;
+
+                    if (nth < pivotPos) end = pivotPos;
+                    else
+                    {
+                        begin = pivotPos + 1;
+                        leftmost = false;
+                    }
                 }
             }
+        }
+
+        /*
+            @brief Rearranges an array so that the element at index n is the one that would be there if the array were sorted.
+            No element before it goes after it, and no element after it goes before it, but both sides are left unsorted.
+            Uses introselect with a median-of-medians fallback.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n)
+            Space complexity: O(log n)
+            @param arr The array to rearrange.
+            @param size The size of the array.
+            @param n The index of the element to put in its sorted place.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void NthElement(T* arr, uint size, uint n, Cmp cmp)
+        {
+            if (n >= size)
+            {
+                Sapphire::Warn("DSA::NthElement() --> index " + std::to_string(n) + " is out of range, the array is left unchanged");
+                return;
+            }
+            Detail::SelectLoop<Detail::IS_BRANCHLESS_COMPARE<T, Cmp>>(arr, arr + n, arr + size, cmp, true);
+        }
+
+        /*
+            @brief Rearranges an array so that the element at index n is the one that would be there if the array were sorted in ascending order.
+            Ideal for finding medians and percentiles without sorting.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n)
+            Space complexity: O(log n)
+            @param arr The array to rearrange.
+            @param size The size of the array.
+            @param n The index of the element to put in its sorted place.
+         */
+        template<typename T>
+        void NthElement(T* arr, uint size, uint n)
+        {
+            NthElement(arr, size, n, Less<T>());
+        }
+
+        /*
+            @brief Sorts the first k elements of an array, leaving the rest in an unspecified order.
+            After it, the first k elements are the ones that go first according to the comparator, in order.
+            For a small k, keeps a heap of the best k elements in one pass over the array,
+            otherwise selects the k-th element with NthElement and sorts the elements before it.
+            Not stable.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+            Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+            Space complexity: O(log n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param k The number of elements to sort, the whole array if it is not smaller than the size.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void PartialSort(T* arr, uint size, uint k, Cmp cmp)
+        {
+            if (k == 0) return;
+            if (k <= size / Detail::PARTIAL_SORT_HEAP_DIVISOR)
+            {
+                std::partial_sort(arr, arr + k, arr + size, cmp);
+                return;
+            }
+            if (k < size) Detail::SelectLoop<Detail::IS_BRANCHLESS_COMPARE<T, Cmp>>(arr, arr + (k - 1), arr + size, cmp, true);
+            QuickSort(arr, Min(k, size), cmp);
+        }
+
+        /*
+            @brief Sorts the k smallest elements of an array in ascending order at its front, leaving the rest in an unspecified order.
+            Ideal for getting the top results of a large array without sorting all of it.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+            Space complexity: O(log n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param k The number of elements to sort, the whole array if it is not smaller than the size.
+         */
+        template<typename T>
+        void PartialSort(T* arr, uint size, uint k)
+        {
+            PartialSort(arr, size, k, Less<T>());
+        }
+
+        namespace Detail
+        {
+            constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+            // Scans are memory bound, so they need larger arrays and chunks than sorting before threads pay off.
+            constexpr size_t PARALLEL_SCAN_THRESHOLD = 1 << 17;
+            constexpr size_t PARALLEL_SCAN_CHUNK = 1 << 15;
 
             /*
-                @brief Creates an array from a given array object.
-                @param arr The array to copy.
+                @brief Finds the first index of the minimum (or maximum if IsMax) of an array on the threads of the default pool.
+                Chunks are reduced on their own and combined in order, keeping the earlier index on ties,
+                so the result is the same as a sequential scan's, including for NaNs.
              */
-            Array(const Array<T>& arr)
+            template<bool IsMax, typename T>
+            int ParallelExtremum(T* arr, uint size, uint threads)
             {
-                m_arr = new T[arr.m_size];
-                m_size = arr.m_size;
-                for (int i = 0; i < m_size; i++)
+                constexpr uint NONE = (uint)-1;
+                auto better = [](const T& a, const T& b) { return IsMax ? a > b : a < b; };
+
+                size_t chunks = (size + PARALLEL_SCAN_CHUNK - 1) / PARALLEL_SCAN_CHUNK;
+                std::unique_ptr<uint[]> results(new uint[chunks]);
+                Parallel::Detail::RunTasks(threads, chunks, [&](size_t chunk)
+                {
+                    uint first = (uint)(chunk * PARALLEL_SCAN_CHUNK);
+                    uint last = (uint)Min((size_t)size, first + PARALLEL_SCAN_CHUNK);
+
+                    // A NaN only wins at index 0, so a chunk further in must not let its leading NaNs hide the rest of it.
+                    if constexpr (std::is_floating_point_v<T>)
+                    {
+                        if (first != 0) while (first < last && arr[first] != arr[first]) first++;
+                    }
+                    results[chunk] = first == last ? NONE : (uint)(IsMax ? MaxIndex(arr, first, last) : MinIndex(arr, first, last));
+                });
+
+                uint best = results[0];
+                for (size_t i = 1; i < chunks; i++)
                 {
-                    m_arr[i] = arr.m_arr[i];
+                    if (results[i] != NONE && better(arr[results[i]], arr[best])) best = results[i];
                 }
+                return (int)best;
             }
-            
+
             /*
-                @brief Creates an array from a given initializer list.
-                @param list The initializer list to copy.
+                @brief Finds how many elements of left come before position k in the stable merge of left and right.
+                Lets a merge be cut into independent pieces that produce the same output as one sequential merge.
              */
-            Array(std::initializer_list<T> list)
+            template<typename T, typename Cmp>
+            size_t MergeSplit(const T* left, size_t leftSize, const T* right, size_t rightSize, size_t k, Cmp& cmp)
             {
-                m_size = list.size();
-                m_arr = new T[m_size];
-                int i = 0;
-                for (T elem : list)
+                size_t lo = k > rightSize ? k - rightSize : 0;
+                size_t hi = Min(k, leftSize);
+                while (lo < hi)
                 {
-                    m_arr[i] = elem;
-                    i++;
+                    size_t mid = lo + (hi - lo) / 2;
+                    if (!cmp(right[k - mid - 1], left[mid])) lo = mid + 1;
+                    else hi = mid;
                 }
+                return lo;
             }
 
             /*
-                @brief Destroys the array object and frees the memory.
+                @brief Sorts an array by sorting chunks on separate threads and merging them in parallel rounds.
+                Each round cuts every merge into pieces at stable split points, so all threads stay busy up to the last merge.
+                Elements ping-pong between the array and one scratch buffer of the same size.
              */
-            ~Array()
+            template<typename T, typename Cmp>
+            void ParallelMergeSort(T* arr, size_t size, uint threads, bool stable, Cmp& cmp)
             {
-                if (m_arr != nullptr) delete[] m_arr;
-            }
+                // Use a chunk count with an odd number of merge rounds, so that the result ends up back in the array.
+                // The count is capped by the size before fixing the parity, so the parity is never changed afterwards.
+                // The last doubling may leave some chunks empty, which the merges handle like any other chunk.
+                size_t target = Min((size_t)threads, size);
+                size_t chunks = 1;
+                int rounds = 0;
+                while (chunks < target)
+                {
+                    chunks *= 2;
+                    rounds++;
+                }
+                if (rounds % 2 == 0)
+                {
+                    chunks *= 2;
+                    rounds++;
+                }
 
-            /*
+                Memory::HeapAllocator<T> alloc;
+                T* buf = alloc.allocate(size);
+                auto bound = [&](size_t chunk) { return size * chunk / chunks; };
+
+                // The array is moved into the buffer and its chunks are sorted there, so every buffer slot holds a live object.
+                Parallel::Detail::RunTasks(threads, chunks, [&](size_t i)
+                {
+                    std::uninitialized_move(arr + bound(i), arr + bound(i + 1), buf + bound(i));
+                });
+
+                try
+                {
+                    Parallel::Detail::RunTasks(threads, chunks, [&](size_t i)
+                    {
+                        size_t lo = bound(i), hi = bound(i + 1);
+                        if (stable) MergeSort(buf + lo, (uint)(hi - lo), cmp);
+                        else QuickSort(buf + lo, (uint)(hi - lo), cmp);
+                    });
+
+                    T* src = buf;
+                    T* dest = arr;
+                    for (size_t width = 1; width < chunks; width *= 2)
+                    {
+                        size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+                        size_t pieces = Max((size_t)threads * 2 / pairs, (size_t)1);
+
+                        auto range = [&](size_t pair, size_t& lo, size_t& mid, size_t& hi)
+                        {
+                            lo = bound(Min(pair * 2 * width, chunks));
+                            mid = bound(Min(pair * 2 * width + width, chunks));
+                            hi = bound(Min(pair * 2 * width + 2 * width, chunks));
+                        };
+
+                        // Find every split point before merging, as merging moves elements out of the ranges being searched.
+                        std::unique_ptr<size_t[]> splits(new size_t[pairs * (pieces + 1)]);
+                        Parallel::Detail::RunTasks(threads, pairs * (pieces + 1), [&](size_t task)
+                        {
+                            size_t lo, mid, hi;
+                            range(task / (pieces + 1), lo, mid, hi);
+                            size_t k = (hi - lo) * (task % (pieces + 1)) / pieces;
+                            splits[task] = MergeSplit(src + lo, mid - lo, src + mid, hi - mid, k, cmp);
+                        });
+
+                        Parallel::Detail::RunTasks(threads, pairs * pieces, [&](size_t task)
+                        {
+                            size_t pair = task / pieces, piece = task % pieces;
+                            size_t lo, mid, hi;
+                            range(pair, lo, mid, hi);
+
+                            size_t begin = (hi - lo) * piece / pieces;
+                            size_t end = (hi - lo) * (piece + 1) / pieces;
+                            size_t l1 = splits[pair * (pieces + 1) + piece];
+                            size_t l2 = splits[pair * (pieces + 1) + piece + 1];
+
+                            Merge(src + lo + l1, (uint)(l2 - l1), src + mid + (begin - l1), (uint)((end - l2) - (begin - l1)), dest + lo + begin, cmp);
+                        });
+
+                        std::swap(src, dest);
+                    }
+                }
+                catch (...)
+                {
+                    std::destroy(buf, buf + size);
+                    alloc.deallocate(buf, size);
+                    throw;
+                }
+
+                std::destroy(buf, buf + size);
+                alloc.deallocate(buf, size);
+            }
+        }
+
+        /*
+            @brief Sorts an array on multiple threads, using a parallel merge sort.
+            Chunks of the array are sorted concurrently, then merged in rounds that are themselves split across the threads.
+            When stable, the result is the same as MergeSort's, whatever the number of threads.
+         !  Will throw an error if the value type in the array is not comparable with the comparator.
+         !  The comparator is called from several threads at once.
+         !  If the comparator throws, the contents of the array are unspecified.
+            Runtime complexity: O(n log n / p + n)
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool.
+            @param stable Whether equal elements keep their relative order.
+            @param cmp A function taking two elements and returning true if the first goes before the second.
+         */
+        template<typename T, typename Cmp>
+        void ParallelSort(T* arr, uint size, uint threads, bool stable, Cmp cmp)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+
+            if (threads == 1 || size < Detail::PARALLEL_SORT_THRESHOLD)
+            {
+                if (stable) MergeSort(arr, size, cmp);
+                else QuickSort(arr, size, cmp);
+                return;
+            }
+
+            Detail::ParallelMergeSort(arr, size, threads, stable, cmp);
+        }
+
+        /*
+            @brief Sorts an array in ascending order on multiple threads, using a parallel merge sort.
+            Ideal for very large arrays.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n log n / p + n)
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+            @param stable Whether equal elements keep their relative order.
+            False by default.
+         */
+        template<typename T>
+        void ParallelSort(T* arr, uint size, uint threads = 0, bool stable = false)
+        {
+            ParallelSort(arr, size, threads, stable, Less<T>());
+        }
+
+        /*
+            @brief Returns the index of the minimum value in an array, scanning chunks of it on multiple threads.
+            Returns the same index as MinIndex, whatever the number of threads.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n / p)
+            @param arr The array to search.
+            @param size The size of the array.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+            @return The index of the minimum value in the array.
+         */
+        template<typename T>
+        int ParallelMinIndex(T* arr, uint size, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SCAN_THRESHOLD) return MinIndex(arr, size);
+            return Detail::ParallelExtremum<false>(arr, size, threads);
+        }
+
+        /*
+            @brief Returns the index of the maximum value in an array, scanning chunks of it on multiple threads.
+            Returns the same index as MaxIndex, whatever the number of threads.
+         !  Will throw an error if the value type in the array is not comparable.
+            Runtime complexity: O(n / p)
+            @param arr The array to search.
+            @param size The size of the array.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+            @return The index of the maximum value in the array.
+         */
+        template<typename T>
+        int ParallelMaxIndex(T* arr, uint size, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SCAN_THRESHOLD) return MaxIndex(arr, size);
+            return Detail::ParallelExtremum<true>(arr, size, threads);
+        }
+
+        /*
+            @brief Searches an array for a given element, scanning chunks of it on multiple threads.
+            Chunks are handed out from the front, and chunks past an occurrence that was already found are skipped,
+            so the search stops early like LinearSearch and returns the same index.
+            Runtime complexity: O(n / p)
+            @param arr The array to search.
+            @param size The size of the array.
+            @param elem The element to search for.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+            @return The index of the first occurrence of the element in the array, or -1 if the element is not found.
+         */
+        template<typename T>
+        int ParallelLinearSearch(T* arr, uint size, T elem, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SCAN_THRESHOLD) return LinearSearch(arr, size, elem);
+
+            std::atomic<uint> found(size);
+            size_t chunks = (size + Detail::PARALLEL_SCAN_CHUNK - 1) / Detail::PARALLEL_SCAN_CHUNK;
+            Parallel::Detail::RunTasks(threads, chunks, [&](size_t chunk)
+            {
+                uint first = (uint)(chunk * Detail::PARALLEL_SCAN_CHUNK);
+                if (first >= found.load(std::memory_order_relaxed)) return;
+
+                uint last = (uint)Min((size_t)size, first + Detail::PARALLEL_SCAN_CHUNK);
+                int index = LinearSearch(arr + first, last - first, elem);
+                if (index == -1) return;
+
+                uint current = found.load(std::memory_order_relaxed);
+                while (first + index < current && !found.compare_exchange_weak(current, first + index, std::memory_order_relaxed)) {}
+            });
+
+            uint index = found.load();
+            return index == size ? -1 : (int)index;
+        }
+
+        /*
+            @brief Checks if an array contains a given element, scanning chunks of it on multiple threads.
+            Every thread stops as soon as any of them finds the element.
+            Runtime complexity: O(n / p)
+            @param arr The array to search.
+            @param size The size of the array.
+            @param elem The element to search for.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+            @return True if the element is found, false otherwise.
+         */
+        template<typename T>
+        bool ParallelContains(T* arr, uint size, T elem, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SCAN_THRESHOLD) return Contains(arr, size, elem);
+
+            std::atomic<bool> found(false);
+            size_t chunks = (size + Detail::PARALLEL_SCAN_CHUNK - 1) / Detail::PARALLEL_SCAN_CHUNK;
+            Parallel::Detail::RunTasks(threads, chunks, [&](size_t chunk)
+            {
+                if (found.load(std::memory_order_relaxed)) return;
+
+                uint first = (uint)(chunk * Detail::PARALLEL_SCAN_CHUNK);
+                uint last = (uint)Min((size_t)size, first + Detail::PARALLEL_SCAN_CHUNK);
+                if (Contains(arr + first, last - first, elem)) found.store(true, std::memory_order_relaxed);
+            });
+            return found.load();
+        }
+
+        namespace Detail
+        {
+            constexpr size_t RADIX_SORT_THRESHOLD = 256;
+            constexpr size_t RADIX_MSD_THRESHOLD = 1 << 16;
+            constexpr size_t RADIX = 256;
+
+            template<typename K>
+            using RadixBits = std::conditional_t<sizeof(K) == 1, uint8_t,
+                std::conditional_t<sizeof(K) == 2, uint16_t,
+                std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>>>;
+
+            /*
+                @brief Maps a key to an unsigned integer with the same order, so that it can be sorted byte by byte.
+                Signed integers get their sign bit flipped. Negative floats get all their bits flipped, as their bits order them backwards,
+                and positive floats get their sign bit set, so that they go above every negative float.
+             */
+            template<typename K>
+            RadixBits<K> RadixKey(K key)
+            {
+                static_assert(std::is_arithmetic_v<K> && !std::is_same_v<K, bool> && sizeof(K) <= 8, "Radix sort keys must be integers or floats of at most 64 bits");
+
+                using U = RadixBits<K>;
+                constexpr U SIGN = (U)((U)1 << (sizeof(K) * 8 - 1));
+                if constexpr (std::is_floating_point_v<K>)
+                {
+                    static_assert(sizeof(K) == 4 || sizeof(K) == 8, "Only 32 and 64-bit floats can be radix sorted");
+                    U bits;
+                    std::memcpy(&bits, &key, sizeof(K));
+                    return (bits & SIGN) ? (U)~bits : (U)(bits | SIGN);
+                }
+                else if constexpr (std::is_signed_v<K>) return (U)((U)key ^ SIGN);
+                else return (U)key;
+            }
+
+            template<typename T, typename KeyFn>
+            using RadixKeyOf = std::decay_t<std::invoke_result_t<KeyFn&, const T&>>;
+
+            /*
+                @brief Moves src[begin, end) into dest, at the offsets of the buckets of each element's digit at shift.
+                Construct is true when dest is uninitialized storage.
+             */
+            template<bool Construct, typename T, typename KeyFn>
+            void RadixScatter(T* src, T* dest, size_t begin, size_t end, size_t* offsets, int shift, KeyFn& keyFn)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    size_t bucket = (size_t)(RadixKey(keyFn(src[i])) >> shift) & (RADIX - 1);
+                    T* to = dest + offsets[bucket]++;
+                    if constexpr (Construct) new (to) T(std::move(src[i]));
+                    else *to = std::move(src[i]);
+                }
+            }
+
+            /*
+                @brief Counts how many keys fall in each bucket, for each of the low digits bytes of the keys, in one pass.
+             */
+            template<typename T, typename KeyFn>
+            void RadixCount(const T* arr, size_t size, int digits, size_t (*counts)[RADIX], KeyFn& keyFn)
+            {
+                for (int d = 0; d < digits; d++) std::fill(counts[d], counts[d] + RADIX, 0);
+                for (size_t i = 0; i < size; i++)
+                {
+                    auto key = RadixKey(keyFn(arr[i]));
+                    for (int d = 0; d < digits; d++) counts[d][(key >> (d * 8)) & (RADIX - 1)]++;
+                }
+            }
+
+            /*
+                @brief Sorts an array by bytes [0, top] of its keys with LSD radix sort, one byte per pass,
+                ping-ponging the elements between the array and scratch, which must be as large as the array.
+                Skips the bytes that are the same in every key.
+                @param counts The bucket counts of each byte, from RadixCount().
+                @param scratchLive Whether scratch holds live objects. Set to true if elements get moved into it.
+                @return Where the sorted elements ended up, either arr or scratch.
+             */
+            template<typename T, typename KeyFn>
+            T* RadixSortLsd(T* arr, T* scratch, size_t size, int top, size_t (*counts)[RADIX], bool& scratchLive, KeyFn& keyFn)
+            {
+                auto firstKey = RadixKey(keyFn(arr[0]));
+                T* src = arr;
+                T* dest = scratch;
+                for (int d = 0; d <= top; d++)
+                {
+                    if (counts[d][(firstKey >> (d * 8)) & (RADIX - 1)] == size) continue;
+
+                    size_t offsets[RADIX];
+                    size_t offset = 0;
+                    for (size_t b = 0; b < RADIX; b++)
+                    {
+                        offsets[b] = offset;
+                        offset += counts[d][b];
+                    }
+
+                    if (dest == scratch && !scratchLive)
+                    {
+                        RadixScatter<true>(src, dest, 0, size, offsets, d * 8, keyFn);
+                        scratchLive = true;
+                    }
+                    else RadixScatter<false>(src, dest, 0, size, offsets, d * 8, keyFn);
+                    std::swap(src, dest);
+                }
+
+                return src;
+            }
+
+            /*
+                @brief Sorts the elements in a by the low digits bytes of their keys, leaving them in b if toB, or else in a.
+                Both ranges hold live objects. Ranges that fit in cache are sorted with LSD passes,
+                larger ones are split by their most significant differing byte into b, and each bucket is sorted back into a.
+             */
+            template<typename T, typename KeyFn>
+            void RadixSortRange(T* a, T* b, size_t size, int digits, bool toB, KeyFn& keyFn)
+            {
+                using U = RadixBits<RadixKeyOf<T, KeyFn>>;
+                T* target = toB ? b : a;
+                if (size < 2 || digits == 0)
+                {
+                    if (toB) std::move(a, a + size, b);
+                    return;
+                }
+
+                size_t counts[sizeof(U)][RADIX];
+                RadixCount(a, size, digits, counts, keyFn);
+
+                U firstKey = RadixKey(keyFn(a[0]));
+                int top = digits - 1;
+                while (top >= 0 && counts[top][(firstKey >> (top * 8)) & (RADIX - 1)] == size) top--;
+
+                if (top < 0 || size < RADIX_MSD_THRESHOLD)
+                {
+                    bool scratchLive = true;
+                    T* sorted = top < 0 ? a : RadixSortLsd(a, b, size, top, counts, scratchLive, keyFn);
+                    if (sorted != target) std::move(sorted, sorted + size, target);
+                    return;
+                }
+
+                size_t starts[RADIX + 1];
+                size_t offsets[RADIX];
+                size_t offset = 0;
+                for (size_t i = 0; i < RADIX; i++)
+                {
+                    starts[i] = offsets[i] = offset;
+                    offset += counts[top][i];
+                }
+                starts[RADIX] = size;
+
+                RadixScatter<false>(a, b, 0, size, offsets, top * 8, keyFn);
+                for (size_t i = 0; i < RADIX; i++)
+                {
+                    RadixSortRange(b + starts[i], a + starts[i], starts[i + 1] - starts[i], top, !toB, keyFn);
+                }
+            }
+
+            /*
+                @brief Sorts an array by an integer or float key, on up to threads threads.
+                Arrays that fit in cache are sorted with LSD passes. Larger ones are split by the most significant byte
+                that differs between keys (MSD), recursively, until the buckets fit in cache for LSD passes over the remaining bytes,
+                as scattering a large array once per byte would miss the cache and TLB on almost every element.
+                The first MSD pass scatters one chunk per thread, with the chunks' offsets laid out in chunk order,
+                and the buckets are then sorted concurrently, so the sort stays stable whatever the number of threads.
+             */
+            template<typename T, typename KeyFn>
+            void RadixSortImpl(T* arr, size_t size, KeyFn& keyFn, uint threads)
+            {
+                using U = RadixBits<RadixKeyOf<T, KeyFn>>;
+                constexpr int DIGITS = sizeof(U);
+
+                Memory::HeapAllocator<T> alloc;
+                T* buf = alloc.allocate(size);
+                bool bufLive = false;
+
+                if (size < RADIX_MSD_THRESHOLD)
+                {
+                    size_t counts[DIGITS][RADIX];
+                    RadixCount(arr, size, DIGITS, counts, keyFn);
+                    T* sorted = RadixSortLsd(arr, buf, size, DIGITS - 1, counts, bufLive, keyFn);
+                    if (sorted != arr) std::move(buf, buf + size, arr);
+                }
+                else
+                {
+                    size_t chunks = Min((size_t)threads, size / RADIX_SORT_THRESHOLD);
+                    auto bound = [&](size_t chunk) { return size * chunk / chunks; };
+
+                    // counts[chunk][digit][bucket], filled for every digit by one pass over each chunk.
+                    std::unique_ptr<size_t[][RADIX]> counts(new size_t[chunks * DIGITS][RADIX]);
+                    auto count = [&](size_t c)
+                    {
+                        RadixCount(arr + bound(c), bound(c + 1) - bound(c), DIGITS, counts.get() + c * DIGITS, keyFn);
+                    };
+                    if (chunks == 1) count(0);
+                    else Parallel::Detail::RunTasks(threads, chunks, count);
+
+                    // Find the most significant byte that is not the same in every key.
+                    U firstKey = RadixKey(keyFn(arr[0]));
+                    int top = DIGITS - 1;
+                    for (; top >= 0; top--)
+                    {
+                        size_t firstBucket = (firstKey >> (top * 8)) & (RADIX - 1);
+                        size_t total = 0;
+                        for (size_t c = 0; c < chunks; c++) total += counts[c * DIGITS + top][firstBucket];
+                        if (total != size) break;
+                    }
+
+                    if (top >= 0)
+                    {
+                        size_t starts[RADIX + 1];
+                        std::unique_ptr<size_t[]> offsets(new size_t[chunks * RADIX]);
+                        size_t offset = 0;
+                        for (size_t b = 0; b < RADIX; b++)
+                        {
+                            starts[b] = offset;
+                            for (size_t c = 0; c < chunks; c++)
+                            {
+                                offsets[c * RADIX + b] = offset;
+                                offset += counts[c * DIGITS + top][b];
+                            }
+                        }
+                        starts[RADIX] = size;
+
+                        auto scatter = [&](size_t c)
+                        {
+                            RadixScatter<true>(arr, buf, bound(c), bound(c + 1), offsets.get() + c * RADIX, top * 8, keyFn);
+                        };
+                        if (chunks == 1) scatter(0);
+                        else Parallel::Detail::RunTasks(threads, chunks, scatter);
+                        bufLive = true;
+
+                        auto sortBucket = [&](size_t b)
+                        {
+                            RadixSortRange(buf + starts[b], arr + starts[b], starts[b + 1] - starts[b], top, true, keyFn);
+                        };
+                        if (chunks == 1) for (size_t b = 0; b < RADIX; b++) sortBucket(b);
+                        else Parallel::Detail::RunTasks(threads, RADIX, sortBucket);
+                    }
+                }
+
+                if (bufLive) std::destroy(buf, buf + size);
+                alloc.deallocate(buf, size);
+            }
+        }
+
+        /*
+            @brief Sorts an array of records by an integer or float key, using LSD radix sort.
+            Sorts one byte of the key per pass, skipping the bytes that are the same in every key.
+            Stable. Floats are ordered by value, with -0 before +0 and NaNs at the ends.
+            Ideal for large arrays of records with numeric keys, like IDs and timestamps.
+         !  The key function must return an integer or float of at most 64 bits, and must not throw.
+            Runtime complexity: O(n * k), where k is the number of bytes in the key
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param keyFn A function taking an element and returning its key.
+         */
+        template<typename T, typename KeyFn>
+        void RadixSortByKey(T* arr, uint size, KeyFn keyFn)
+        {
+            if (size < Detail::RADIX_SORT_THRESHOLD)
+            {
+                MergeSort(arr, size, [&](const T& a, const T& b) { return Detail::RadixKey(keyFn(a)) < Detail::RadixKey(keyFn(b)); });
+                return;
+            }
+
+            Detail::RadixSortImpl(arr, size, keyFn, 1);
+        }
+
+        /*
+            @brief Sorts an array of integers or floats in ascending order, using LSD radix sort.
+            Sorts one byte per pass, skipping the bytes that are the same in every element.
+            Ideal for large arrays of numbers.
+         !  Only works for integers and floats of at most 64 bits.
+            Runtime complexity: O(n * k), where k is the size of the type in bytes
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+         */
+        template<typename T>
+        void RadixSort(T* arr, uint size)
+        {
+            if (size < Detail::RADIX_SORT_THRESHOLD)
+            {
+                QuickSort(arr, size, [](const T& a, const T& b) { return Detail::RadixKey(a) < Detail::RadixKey(b); });
+                return;
+            }
+
+            auto identity = [](const T& elem) { return elem; };
+            Detail::RadixSortImpl(arr, size, identity, 1);
+        }
+
+        /*
+            @brief Sorts an array of records by an integer or float key on multiple threads, using LSD radix sort.
+            Each pass counts and scatters one chunk of the array per thread. Stable, whatever the number of threads.
+         !  The key function must return an integer or float of at most 64 bits, and must not throw.
+         !  The key function is called from several threads at once.
+            Runtime complexity: O(n * k / p), where k is the number of bytes in the key
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param keyFn A function taking an element and returning its key.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+         */
+        template<typename T, typename KeyFn>
+        void ParallelRadixSortByKey(T* arr, uint size, KeyFn keyFn, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SORT_THRESHOLD)
+            {
+                RadixSortByKey(arr, size, keyFn);
+                return;
+            }
+
+            Detail::RadixSortImpl(arr, size, keyFn, threads);
+        }
+
+        /*
+            @brief Sorts an array of integers or floats in ascending order on multiple threads, using LSD radix sort.
+            Ideal for very large arrays of numbers.
+         !  Only works for integers and floats of at most 64 bits.
+            Runtime complexity: O(n * k / p), where k is the size of the type in bytes
+            Space complexity: O(n)
+            @param arr The array to sort.
+            @param size The size of the array.
+            @param threads The number of threads to use, including the calling thread.
+            0 uses every thread of the default pool, and is the default.
+         */
+        template<typename T>
+        void ParallelRadixSort(T* arr, uint size, uint threads = 0)
+        {
+            if (threads == 0) threads = Parallel::GetDefaultPool().getThreadCount();
+            if (threads == 1 || size < Detail::PARALLEL_SORT_THRESHOLD)
+            {
+                RadixSort(arr, size);
+                return;
+            }
+
+            auto identity = [](const T& elem) { return elem; };
+            Detail::RadixSortImpl(arr, size, identity, threads);
+        }
+
+        /*
+            @brief A class to represent a fixed-size array.
+            @param A The allocator to allocate the elements with.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class Array
+        {
+        public:
+            /*
+                @brief Creates an empty array.
+                @param alloc The allocator to use.
+             */
+            Array(const A& alloc = A()) : m_alloc(alloc)
+            {
+                m_arr = nullptr;
+                m_size = 0;
+            }
+
+            /*
+                @brief Creates an array of a given size.
+                The elements are value-initialized.
+                @param size The size of the array.
+                @param alloc The allocator to use.
+             */
+            Array(uint size, const A& alloc = A()) : Array(alloc)
+            {
+                m_arr = allocate(size);
+                for (; m_size < size; m_size++)
+                {
+                    new (m_arr + m_size) T();
+                }
+            }
+
+            
+            /*
+                @brief Creates an array from a given array.
+                @param arr The array to copy.
+                @param size The size of the array.
+                @param alloc The allocator to use.
+             */
+            Array(T* arr, uint size, const A& alloc = A()) : Array(alloc)
+            {
+                copyFrom(arr, size);
+            }
+
+            /*
+                @brief Creates an array from a given array object.
+                @param arr The array to copy.
+             */
+            Array(const Array<T, A>& arr) : Array(std::allocator_traits<A>::select_on_container_copy_construction(arr.m_alloc))
+            {
+                copyFrom(arr.m_arr, arr.m_size);
+            }
+
+            /*
+                @brief Creates an array by taking the contents of another array.
+                The other array is left empty.
+                @param arr The array to move from.
+             */
+            Array(Array<T, A>&& arr) noexcept : Array(arr.m_alloc)
+            {
+                std::swap(m_arr, arr.m_arr);
+                std::swap(m_size, arr.m_size);
+            }
+            
+            /*
+                @brief Creates an array from a given initializer list.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            Array(std::initializer_list<T> list, const A& alloc = A()) : Array(alloc)
+            {
+                copyFrom(list.begin(), list.size());
+            }
+
+            /*
+                @brief Destroys the array object and frees the memory.
+             */
+            ~Array()
+            {
+                destroy();
+            }
+
+            /*
                 @brief Searches an array for a given element using linear search.
                 Works for all arrays, ideal for unsorted arrays.
                 Runtime complexity: O(n)
-                @param elem The element to search for.
-                @return The index of the element in the array, or -1 if the element is not found.
+                @param elem The element to search for.
+                @return The index of the element in the array, or -1 if the element is not found.
+             */
+            int linearSearch(T elem)
+            {
+                return LinearSearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Searches an array for a given element using binary search.
+                Only works for sorted arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log n)
+                @param elem The element to search for.
+                @return The index of the element in the array, or -1 if the element is not found.
+             */
+            int binarySearch(T elem)
+            {
+                return BinarySearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Searches an array for a given element using interpolation search.
+                Only works for sorted arrays, ideal for uniformly distributed arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log log n), worst case O(n)
+                @param elem The element to search for.
+                @return The index of the element in the array, or -1 if the element is not found.
+             */
+            int interpolationSearch(T elem)
+            {
+                return InterpolationSearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Checks if an array contains a given element.
+                Uses linear search.
+                @param elem The element to search for.
+                @return True if the element is found, false otherwise.
+             */
+            bool contains(T elem)
+            {
+                return linearSearch(elem) != -1;
+            }
+
+            /*
+                @brief Sorts an array using the bubble sort algorithm.
+             
+             !  Will throw an error if the value type in the array is not comparable.!  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void bubbleSort()
+            {
+                BubbleSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array using the selection sort algorithm.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void selectionSort()
+            {
+                SelectionSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array in ascending order using a stable, natural merge sort (TimSort).
+                Ideal for larger arrays, and for arrays that are already partly sorted.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+             */
+            void mergeSort()
+            {
+                MergeSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array using a stable, natural merge sort (TimSort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void mergeSort(Cmp cmp)
+            {
+                MergeSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Sorts an array of integers or floats in ascending order, using LSD radix sort.
+                Ideal for large arrays of numbers.
+             !  Only works for integers and floats of at most 64 bits.
+                Runtime complexity: O(n * k), where k is the size of the type in bytes
+                Space complexity: O(n)
+             */
+            void radixSort()
+            {
+                RadixSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array by an integer or float key, using LSD radix sort.
+                Stable.
+             !  The key function must return an integer or float of at most 64 bits, and must not throw.
+                Runtime complexity: O(n * k), where k is the number of bytes in the key
+                Space complexity: O(n)
+                @param keyFn A function taking an element and returning its key.
+             */
+            template<typename KeyFn>
+            void radixSortByKey(KeyFn keyFn)
+            {
+                RadixSortByKey(m_arr, m_size, keyFn);
+            }
+
+            /*
+                @brief Sorts an array in ascending order on multiple threads, using a parallel merge sort.
+                Ideal for very large arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool, and is the default.
+                @param stable Whether equal elements keep their relative order.
+                False by default.
+             */
+            void parallelSort(uint threads = 0, bool stable = false)
+            {
+                ParallelSort(m_arr, m_size, threads, stable);
+            }
+
+            /*
+                @brief Sorts an array on multiple threads, using a parallel merge sort.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+             !  The comparator is called from several threads at once.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool.
+                @param stable Whether equal elements keep their relative order.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void parallelSort(uint threads, bool stable, Cmp cmp)
+            {
+                ParallelSort(m_arr, m_size, threads, stable, cmp);
+            }
+
+            /*
+                @brief Sorts an array in ascending order using pattern-defeating quick sort (pdqsort).
+                Ideal for most arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+             */
+            void quickSort()
+            {
+                QuickSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array using pattern-defeating quick sort (pdqsort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void quickSort(Cmp cmp)
+            {
+                QuickSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Rearranges the array so that the element at index n is the one that would be there if it were sorted in ascending order.
+                No element before it is greater, and no element after it is smaller.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+             */
+            void nthElement(uint n)
+            {
+                NthElement(m_arr, m_size, n);
+            }
+
+            /*
+                @brief Rearranges the array so that the element at index n is the one that would be there if it were sorted.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void nthElement(uint n, Cmp cmp)
+            {
+                NthElement(m_arr, m_size, n, cmp);
+            }
+
+            /*
+                @brief Sorts the k smallest elements of the array in ascending order at its front, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+             */
+            void partialSort(uint k)
+            {
+                PartialSort(m_arr, m_size, k);
+            }
+
+            /*
+                @brief Sorts the first k elements of the array according to a comparator, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void partialSort(uint k, Cmp cmp)
+            {
+                PartialSort(m_arr, m_size, k, cmp);
+            }
+
+            /*
+                @brief Returns the size of the array.
+                @return The number of elements in the array.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the underlying array/pointer.
+                @return The array data.
+             */
+            T* data()
+            {
+                return m_arr;
+            }
+
+            const T* data() const
+            {
+                return m_arr;
+            }
+
+            T& operator[](int index)
+            {
+                if (index < 0 || index >= m_size)
+                {
+                    Sapphire::Err("DSA::Array --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                    throw std::runtime_error("Sapphire: DSA::Array --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                }
+                return m_arr[index];
+            }
+
+            Array<T, A>& operator=(const Array<T, A>& other)
+            {
+                if (this == &other) return *this;
+                destroy();
+                copyFrom(other.m_arr, other.m_size);
+                return *this;
+            }
+
+            Array<T, A>& operator=(Array<T, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+                if (m_alloc == other.m_alloc)
+                {
+                    std::swap(m_arr, other.m_arr);
+                    std::swap(m_size, other.m_size);
+                }
+                else
+                {
+                    destroy();
+                    m_arr = allocate(other.m_size);
+                    for (; m_size < other.m_size; m_size++)
+                    {
+                        new (m_arr + m_size) T(std::move(other.m_arr[m_size]));
+                    }
+                }
+                return *this;
+            }
+
+            friend bool operator==(const Array<T, A>& arr1, const Array<T, A>& arr2)
+            {
+                if (arr1.m_size != arr2.m_size) return false;
+                for (int i = 0; i < arr1.m_size; i++)
+                {
+                    if (arr1.m_arr[i] != arr2.m_arr[i]) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const Array<T, A>& arr1, const Array<T, A>& arr2)
+            {
+                return !(arr1 == arr2);
+            }
+            
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+                using pointer = T*;
+                using reference = T&;
+
+                Iterator(pointer ptr) : m_ptr(ptr) {}
+                
+                reference operator*() const 
+                { 
+                    return *m_ptr; 
+                }
+                
+                pointer operator->() 
+                {
+                    return m_ptr; 
+                }
+
+                Iterator& operator++() 
+                {
+                    m_ptr++; return *this;
+                }
+
+                Iterator operator++(int) 
+                {
+                    Iterator tmp = *this; ++(*this); return tmp; 
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2) 
+                { 
+                    return it1.m_ptr == it2.m_ptr; 
+                };
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
+                {
+                    return it1.m_ptr != it2.m_ptr; 
+                };
+
+            private:
+                pointer m_ptr;
+            };
+
+            Iterator begin() 
+            {
+                return Iterator(m_arr); 
+            }
+
+            Iterator end() 
+            {
+                return Iterator(m_arr + m_size); 
+            }
+
+        private:
+            T* m_arr;
+            uint m_size;
+            [[no_unique_address]] A m_alloc;
+
+            T* allocate(uint size)
+            {
+                return size == 0 ? nullptr : std::allocator_traits<A>::allocate(m_alloc, size);
+            }
+
+            void copyFrom(const T* arr, uint size)
+            {
+                m_arr = allocate(size);
+                for (; m_size < size; m_size++)
+                {
+                    new (m_arr + m_size) T(arr[m_size]);
+                }
+            }
+
+            void destroy()
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (uint i = 0; i < m_size; i++)
+                    {
+                        m_arr[i].~T();
+                    }
+                }
+                if (m_arr != nullptr) std::allocator_traits<A>::deallocate(m_alloc, m_arr, m_size);
+                m_arr = nullptr;
+                m_size = 0;
+            }
+        };
+
+        /*
+            @brief A class to represent a dynamic array, known as std::vector in C++ and ArrayList in Java and some other languages.
+            Capacity beyond the size is left uninitialized, so reserving space does not construct any elements.
+            @param A The allocator to allocate the elements with.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class ArrayList
+        {
+        public:
+            /*
+                @brief Creates an empty array list.
+                Does not allocate until the first element is added.
+                @param alloc The allocator to use.
+             */
+            ArrayList(const A& alloc = A()) : m_alloc(alloc)
+            {
+                m_cap = 0;
+                m_arr = nullptr;
+                m_size = 0;
+            }
+
+            /*
+                @brief Creates an array list of a given size.
+                The elements are value-initialized.
+                @param size The size of the array list.
+                @param alloc The allocator to use.
+             */
+            ArrayList(uint size, const A& alloc = A()) : ArrayList(alloc)
+            {
+                reserve(Max((uint)(size * 1.5), (uint)10));
+                for (; m_size < size; m_size++)
+                {
+                    new (m_arr + m_size) T();
+                }
+            }
+
+            /*
+                @brief Creates an array list from a given array.
+                @param size The size of the array list.
+                @param arr The array to copy.
+                @param alloc The allocator to use.
+             */
+            ArrayList(T* arr, uint size, const A& alloc = A()) : ArrayList(alloc)
+            {
+                reserve(Max((uint)(size * 1.5), (uint)10));
+                for (; m_size < size; m_size++)
+                {
+                    new (m_arr + m_size) T(arr[m_size]);
+                }
+            }
+
+            /*
+                @brief Creates an array list from a given array list object.
+                @param arr The array list to copy.
+             */
+            ArrayList(const ArrayList<T, A>& arr) : ArrayList(std::allocator_traits<A>::select_on_container_copy_construction(arr.m_alloc))
+            {
+                reserve(arr.m_cap);
+                for (; m_size < arr.m_size; m_size++)
+                {
+                    new (m_arr + m_size) T(arr.m_arr[m_size]);
+                }
+            }
+
+            /*
+                @brief Creates an array list by taking the contents of another array list.
+                The other array list is left empty, without any capacity.
+                @param arr The array list to move from.
+             */
+            ArrayList(ArrayList<T, A>&& arr) noexcept : ArrayList(arr.m_alloc)
+            {
+                std::swap(m_cap, arr.m_cap);
+                std::swap(m_arr, arr.m_arr);
+                std::swap(m_size, arr.m_size);
+            }
+
+            /*
+                @brief Creates an array list from a given initializer list.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            ArrayList(std::initializer_list<T> list, const A& alloc = A()) : ArrayList(alloc)
+            {
+                reserve(Max((uint)(list.size() * 1.5), (uint)10));
+                for (const T& elem : list)
+                {
+                    new (m_arr + m_size) T(elem);
+                    m_size++;
+                }
+            }
+
+            /*
+                @brief Destroys the array list object and frees the memory.
+             */
+            ~ArrayList()
+            {
+                DestroyRange(m_arr, 0, m_size);
+                deallocate();
+            }
+
+            /*
+                @brief Searches an array list for a given element using linear search.
+                Works for all arrays, ideal for unsorted arrays.
+                Runtime complexity: O(n)
+                @param elem The element to search for.
+                @return The index of the element in the array list, or -1 if the element is not found.
+             */
+            int linearSearch(T elem)
+            {
+                return LinearSearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Searches an array list for a given element using binary search.
+                Only works for sorted arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log n)
+                @param elem The element to search for.
+                @return The index of the element in the array list, or -1 if the element is not found.
+             */
+            int binarySearch(T elem)
+            {
+                return BinarySearch(m_arr, m_size, elem);
+            }
+
+
+            /*
+                @brief Searches an array list for a given element using interpolation search.
+                Only works for sorted arrays, ideal for uniformly distributed arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log log n), worst case O(n)
+                @param elem The element to search for.
+                @return The index of the element in the array list, or -1 if the element is not found.
+             */
+            int interpolationSearch(T elem)
+            {
+                return InterpolationSearch(m_arr, m_size, elem);
+            }
+
+
+            /*
+                @brief Checks if an array list contains a given element.
+                Uses linear search.
+             !  Will throw an error if the value type in the array is not comparable.
+                @param elem The element to search for.
+                @return True if the element is found, false otherwise.
+             */
+            int contains(T elem)
+            {
+                return linearSearch(elem) != -1;
+            }
+
+            /*
+                @brief Sorts an array list using the bubble sort algorithm.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void bubbleSort()
+            {
+                BubbleSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array list using the selection sort algorithm.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void selectionSort()
+            {
+                SelectionSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array list in ascending order using a stable, natural merge sort (TimSort).
+                Ideal for larger arrays, and for arrays that are already partly sorted.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+             */
+            void mergeSort()
+            {
+                MergeSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array list using a stable, natural merge sort (TimSort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void mergeSort(Cmp cmp)
+            {
+                MergeSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Sorts an array list of integers or floats in ascending order, using LSD radix sort.
+                Ideal for large arrays of numbers.
+             !  Only works for integers and floats of at most 64 bits.
+                Runtime complexity: O(n * k), where k is the size of the type in bytes
+                Space complexity: O(n)
+             */
+            void radixSort()
+            {
+                RadixSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array list by an integer or float key, using LSD radix sort.
+                Stable.
+             !  The key function must return an integer or float of at most 64 bits, and must not throw.
+                Runtime complexity: O(n * k), where k is the number of bytes in the key
+                Space complexity: O(n)
+                @param keyFn A function taking an element and returning its key.
+             */
+            template<typename KeyFn>
+            void radixSortByKey(KeyFn keyFn)
+            {
+                RadixSortByKey(m_arr, m_size, keyFn);
+            }
+
+            /*
+                @brief Sorts an array list in ascending order on multiple threads, using a parallel merge sort.
+                Ideal for very large arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool, and is the default.
+                @param stable Whether equal elements keep their relative order.
+                False by default.
+             */
+            void parallelSort(uint threads = 0, bool stable = false)
+            {
+                ParallelSort(m_arr, m_size, threads, stable);
+            }
+
+            /*
+                @brief Sorts an array list on multiple threads, using a parallel merge sort.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+             !  The comparator is called from several threads at once.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool.
+                @param stable Whether equal elements keep their relative order.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void parallelSort(uint threads, bool stable, Cmp cmp)
+            {
+                ParallelSort(m_arr, m_size, threads, stable, cmp);
+            }
+
+            /*
+                @brief Sorts an array list in ascending order using pattern-defeating quick sort (pdqsort).
+                Ideal for most arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+             */
+            void quickSort()
+            {
+                QuickSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts an array list using pattern-defeating quick sort (pdqsort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void quickSort(Cmp cmp)
+            {
+                QuickSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Rearranges the array list so that the element at index n is the one that would be there if it were sorted in ascending order.
+                No element before it is greater, and no element after it is smaller.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+             */
+            void nthElement(uint n)
+            {
+                NthElement(m_arr, m_size, n);
+            }
+
+            /*
+                @brief Rearranges the array list so that the element at index n is the one that would be there if it were sorted.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void nthElement(uint n, Cmp cmp)
+            {
+                NthElement(m_arr, m_size, n, cmp);
+            }
+
+            /*
+                @brief Sorts the k smallest elements of the array list in ascending order at its front, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+             */
+            void partialSort(uint k)
+            {
+                PartialSort(m_arr, m_size, k);
+            }
+
+            /*
+                @brief Sorts the first k elements of the array list according to a comparator, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void partialSort(uint k, Cmp cmp)
+            {
+                PartialSort(m_arr, m_size, k, cmp);
+            }
+
+            /*
+                @brief Returns the size of the array list.
+                @return The number of elements in the array list.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Removes all elements from the array list.
+                Keeps the capacity so the array list can be refilled without reallocating.
+             */
+            void clear()
+            {
+                DestroyRange(m_arr, 0, m_size);
+                m_size = 0;
+            }
+
+            /*
+                @brief Returns a copy of the allocator the array list uses.
+                @return The allocator.
+             */
+            A getAllocator() const
+            {
+                return m_alloc;
+            }
+
+            /*
+                @brief Returns the number of elements the array list can hold before it has to grow.
+                @return The capacity of the array list.
+             */
+            uint capacity() const
+            {
+                return m_cap;
+            }
+
+            /*
+                @brief Makes room for a number of elements so that adding them does not reallocate.
+             *  Does not construct any elements.
+                @param cap The number of elements to make room for.
+             */
+            void reserve(uint cap)
+            {
+                if (cap > m_cap) reallocate(cap);
+            }
+
+            /*
+                @brief Frees any capacity that is not being used by elements.
+             */
+            void shrinkToFit()
+            {
+                if (m_cap > m_size) reallocate(m_size);
+            }
+
+            /*
+                @brief Constructs an element in place at the end of the array list.
+                Doubles the capacity when full, moving each element into the new storage once.
+                Runtime complexity: O(1) amortized
+                @param args The arguments to construct the element with.
+                @return A reference to the new element.
+             */
+            template<typename... Args>
+            T& emplace(Args&&... args)
+            {
+                if (m_size == m_cap)
+                {
+                    // Build the element before growing, in case the arguments refer to an element of this list.
+                    T elem(std::forward<Args>(args)...);
+                    grow(m_size + 1);
+                    new (m_arr + m_size) T(std::move(elem));
+                }
+                else new (m_arr + m_size) T(std::forward<Args>(args)...);
+
+                m_size++;
+                return m_arr[m_size - 1];
+            }
+
+            /*
+                @brief Adds an element to the end of the array list.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void add(const T& elem)
+            {
+                emplace(elem);
+            }
+
+            /*
+                @brief Adds an element to the end of the array list, moving from it.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void add(T&& elem)
+            {
+                emplace(std::move(elem));
+            }
+
+            /*
+                @brief Inserts an element at a given index in the array list.
+                Shifts the following elements up in place, with memmove for trivially copyable types.
+                Runtime complexity: O(n - index)
+                @param elem The element to insert.
+                @param index The index to insert the element at.
+             */
+            void insert(T elem, int index)
+            {
+                if (index < 0 || index > m_size) OutOfBounds(index, m_size);
+                if (m_size == m_cap) grow(m_size + 1);
+
+                if constexpr (TRIVIAL)
+                {
+                    std::memmove(m_arr + index + 1, m_arr + index, (m_size - index) * sizeof(T));
+                    new (m_arr + index) T(std::move(elem));
+                }
+                else if (index == m_size) new (m_arr + m_size) T(std::move(elem));
+                else
+                {
+                    new (m_arr + m_size) T(std::move(m_arr[m_size - 1]));
+                    for (uint i = m_size - 1; i > (uint)index; i--)
+                    {
+                        m_arr[i] = std::move(m_arr[i - 1]);
+                    }
+                    m_arr[index] = std::move(elem);
+                }
+                m_size++;
+            }
+
+            /*
+                @brief Inserts a range of elements at a given index in the array list.
+                The following elements are shifted up once for the whole range.
+                Runtime complexity: O(n - index + count)
+                @param arr The elements to insert.
+                @param count The number of elements to insert.
+                @param index The index to insert the first element at.
+             */
+            void insertRange(const T* arr, uint count, int index)
+            {
+                if (index < 0 || index > m_size) OutOfBounds(index, m_size);
+                if (count == 0) return;
+
+                // Growing would free the source range if it lies inside this list, so copy it out first.
+                if (!std::less<const T*>()(arr, m_arr) && std::less<const T*>()(arr, m_arr + m_size))
+                {
+                    ArrayList<T, A> copy((T*)arr, count, m_alloc);
+                    insertRange(copy.data(), count, index);
+                    return;
+                }
+
+                if (m_size + count > m_cap) grow(m_size + count);
+
+                if constexpr (TRIVIAL)
+                {
+                    std::memmove(m_arr + index + count, m_arr + index, (m_size - index) * sizeof(T));
+                    std::memcpy(m_arr + index, arr, count * sizeof(T));
+                    m_size += count;
+                }
+                else
+                {
+                    uint oldSize = m_size;
+                    for (uint i = 0; i < count; i++)
+                    {
+                        new (m_arr + m_size) T(arr[i]);
+                        m_size++;
+                    }
+                    std::rotate(m_arr + index, m_arr + oldSize, m_arr + m_size);
+                }
+            }
+
+            /*
+                @brief Inserts all elements of another array list at a given index in the array list.
+                Runtime complexity: O(n - index + count)
+                @param list The array list to insert.
+                @param index The index to insert the first element at.
+             */
+            void insertRange(const ArrayList<T, A>& list, int index)
+            {
+                insertRange(list.m_arr, list.m_size, index);
+            }
+
+            /*
+                @brief Removes an element at a given index in the array list.
+                Shifts the following elements down in place, with memmove for trivially copyable types.
+                Runtime complexity: O(n - index)
+                @param index The index to remove the element at.
+             */
+            void remove(int index)
+            {
+                if (index < 0 || index >= m_size) OutOfBounds(index, m_size);
+                removeRange(index, index + 1);
+            }
+
+            /*
+                @brief Removes a range of elements from the array list.
+                The following elements are shifted down once for the whole range.
+                Runtime complexity: O(n - start)
+                @param start The start index of the range, inclusive.
+                @param end The end index of the range, exclusive.
+             */
+            void removeRange(int start, int end)
+            {
+                if (start < 0 || start > m_size) OutOfBounds(start, m_size);
+                if (end < start || end > m_size) OutOfBounds(end, m_size);
+                if (start == end) return;
+
+                if constexpr (TRIVIAL)
+                {
+                    std::memmove(m_arr + start, m_arr + end, (m_size - end) * sizeof(T));
+                }
+                else
+                {
+                    std::move(m_arr + end, m_arr + m_size, m_arr + start);
+                    DestroyRange(m_arr, m_size - (end - start), m_size);
+                }
+                m_size -= end - start;
+            }
+
+            /*
+                @brief Removes the last element in the array list.
+                Runtime complexity: O(1)
+                @return The removed element.
+             */
+            T pop()
+            {
+                if (m_size == 0)
+                {
+                    Sapphire::Err("DSA::ArrayList --> cannot pop from an empty array list");
+                    throw std::runtime_error("Sapphire: DSA::ArrayList --> cannot pop from an empty array list");
+                }
+
+                m_size--;
+                T elem = std::move(m_arr[m_size]);
+                m_arr[m_size].~T();
+                return elem;
+            }
+
+            /*
+                @brief Removes all elements that satisfy a predicate.
+                Compacts the kept elements in a single pass, preserving their order.
+                Runtime complexity: O(n)
+                @param pred A function taking an element and returning true if it should be removed.
+                @return The number of elements removed.
+             */
+            template<typename Pred>
+            uint removeIf(Pred pred)
+            {
+                uint kept = 0;
+                for (uint i = 0; i < m_size; i++)
+                {
+                    if (pred(m_arr[i])) continue;
+                    if (kept != i) m_arr[kept] = std::move(m_arr[i]);
+                    kept++;
+                }
+
+                uint removed = m_size - kept;
+                DestroyRange(m_arr, kept, m_size);
+                m_size = kept;
+                return removed;
+            }
+
+            /*
+                @brief Keeps only the elements that satisfy a predicate.
+                Compacts the kept elements in a single pass, preserving their order.
+                Runtime complexity: O(n)
+                @param pred A function taking an element and returning true if it should be kept.
+                @return The number of elements removed.
+             */
+            template<typename Pred>
+            uint retain(Pred pred)
+            {
+                return removeIf([&pred](const T& elem) { return !pred(elem); });
+            }
+
+            /*
+                @brief Removes all occurrences of a given element in the array list.
+                Runtime complexity: O(n)
+                @param elem The element to remove.
+             */
+            void removeAll(T elem)
+            {
+                removeIf([&elem](const T& other) { return other == elem; });
+            }
+
+            /*
+                @brief Returns the underlying array/pointer.
+                @return The array list data.
+             */
+            T* data()
+            {
+                return m_arr;
+            }
+
+            /*
+                @brief Returns the underlying array/pointer.
+                @return The array list data.
+             */
+            const T* data() const
+            {
+                return m_arr;
+            }
+
+            T& operator[](int index)
+            {
+                if (index < 0 || index >= m_size) OutOfBounds(index, m_size);
+                return m_arr[index];
+            }
+
+            ArrayList<T, A>& operator=(const ArrayList<T, A>& other)
+            {
+                if (this == &other) return *this;
+                clear();
+                reserve(other.m_size);
+                for (; m_size < other.m_size; m_size++)
+                {
+                    new (m_arr + m_size) T(other.m_arr[m_size]);
+                }
+                return *this;
+            }
+
+            ArrayList<T, A>& operator=(ArrayList<T, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+                if (m_alloc == other.m_alloc)
+                {
+                    std::swap(m_cap, other.m_cap);
+                    std::swap(m_arr, other.m_arr);
+                    std::swap(m_size, other.m_size);
+                    other.clear();
+                }
+                else
+                {
+                    // Storage from another allocator cannot be adopted, so move the elements over instead.
+                    clear();
+                    reserve(other.m_size);
+                    for (; m_size < other.m_size; m_size++)
+                    {
+                        new (m_arr + m_size) T(std::move(other.m_arr[m_size]));
+                    }
+                    other.clear();
+                }
+                return *this;
+            }
+
+            friend bool operator==(const ArrayList<T, A>& arr1, const ArrayList<T, A>& arr2)
+            {
+                if (arr1.m_size != arr2.m_size) return false;
+                for (int i = 0; i < arr1.m_size; i++)
+                {
+                    if (arr1.m_arr[i] != arr2.m_arr[i]) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const ArrayList<T, A>& arr1, const ArrayList<T, A>& arr2)
+            {
+                return !(arr1 == arr2);
+            }
+
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+                using pointer = T*;
+                using reference = T&;
+
+                Iterator(pointer ptr) : m_ptr(ptr) {}
+                
+                reference operator*() const 
+                { 
+                    return *m_ptr; 
+                }
+                
+                pointer operator->() 
+                {
+                    return m_ptr; 
+                }
+
+                Iterator& operator++() 
+                {
+                    m_ptr++; return *this;
+                }
+
+                Iterator operator++(int) 
+                {
+                    Iterator tmp = *this; ++(*this); return tmp; 
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2) 
+                { 
+                    return it1.m_ptr == it2.m_ptr; 
+                };
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
+                {
+                    return it1.m_ptr != it2.m_ptr; 
+                };
+
+            private:
+                pointer m_ptr;
+            };
+
+            Iterator begin() 
+            {
+                return Iterator(m_arr); 
+            }
+
+            Iterator end() 
+            {
+                return Iterator(m_arr + m_size); 
+            }
+
+        private:
+            uint m_cap;
+            T* m_arr;
+            uint m_size;
+
+            [[no_unique_address]] A m_alloc;
+
+            // Trivially copyable elements can be shifted with memmove, and relocated with realloc if the allocator supports it.
+            static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+            static constexpr bool RELOCATE_WITH_REALLOC = TRIVIAL && requires(A& alloc, T* p, size_t n) { alloc.reallocate(p, n, n); };
+
+            void deallocate()
+            {
+                if (m_arr != nullptr) std::allocator_traits<A>::deallocate(m_alloc, m_arr, m_cap);
+                m_arr = nullptr;
+                m_cap = 0;
+            }
+
+            [[noreturn]] static void OutOfBounds(int index, uint size)
+            {
+                Sapphire::Err("DSA::ArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+                throw std::runtime_error("Sapphire: DSA::ArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+            }
+
+            static void DestroyRange(T* arr, uint start, uint end)
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (uint i = start; i < end; i++)
+                    {
+                        arr[i].~T();
+                    }
+                }
+            }
+
+            /*
+                @brief Moves the elements into storage of a given capacity.
+                Each element is moved exactly once, or the whole block is relocated by realloc for trivially copyable types.
+                @param cap The new capacity, which must be at least the size.
+             */
+            void reallocate(uint cap)
+            {
+                if (cap == 0)
+                {
+                    deallocate();
+                    return;
+                }
+
+                if constexpr (RELOCATE_WITH_REALLOC)
+                {
+                    if (m_arr != nullptr)
+                    {
+                        m_arr = m_alloc.reallocate(m_arr, m_cap, cap);
+                        m_cap = cap;
+                        return;
+                    }
+                }
+
+                T* arr = std::allocator_traits<A>::allocate(m_alloc, cap);
+                if constexpr (TRIVIAL)
+                {
+                    if (m_size != 0) std::memcpy(arr, m_arr, m_size * sizeof(T));
+                }
+                else
+                {
+                    uint i = 0;
+                    try
+                    {
+                        for (; i < m_size; i++)
+                        {
+                            new (arr + i) T(std::move_if_noexcept(m_arr[i]));
+                        }
+                    }
+                    catch (...)
+                    {
+                        // A throwing copy leaves the old elements untouched, so only the new storage is undone.
+                        DestroyRange(arr, 0, i);
+                        std::allocator_traits<A>::deallocate(m_alloc, arr, cap);
+                        throw;
+                    }
+                    DestroyRange(m_arr, 0, m_size);
+                }
+                deallocate();
+                m_arr = arr;
+                m_cap = cap;
+            }
+
+            void grow(uint minCap)
+            {
+                reallocate(Max(Max(m_cap * 2, minCap), (uint)10));
+            }
+        };
+
+        /*
+            @brief A class to represent a dynamic array that stores its first N elements inline, inside the object.
+            It only allocates on the heap once it grows past N elements, so short lists cost no heap traffic to create or destroy.
+            Has the same interface as ArrayList.
+            @param A The allocator to allocate the elements with once they spill to the heap.
+         *  Moving a list that is still inline moves its elements one by one, so pointers into it do not survive a move.
+         */
+        template<typename T, uint N, typename A = Memory::HeapAllocator<T>>
+        class SmallArrayList
+        {
+            static_assert(N > 0, "DSA::SmallArrayList needs room for at least one inline element");
+
+        public:
+            /*
+                @brief Creates an empty small array list, using the inline storage.
+                @param alloc The allocator to use once the elements spill to the heap.
+             */
+            SmallArrayList(const A& alloc = A()) : m_alloc(alloc)
+            {
+                m_arr = inlineData();
+                m_cap = N;
+                m_size = 0;
+            }
+
+            /*
+                @brief Creates a small array list of a given size.
+                The elements are value-initialized.
+                @param size The size of the small array list.
+                @param alloc The allocator to use once the elements spill to the heap.
+             */
+            SmallArrayList(uint size, const A& alloc = A()) : SmallArrayList(alloc)
+            {
+                reserve(size);
+                for (uint i = 0; i < size; i++)
+                {
+                    new (m_arr + i) T();
+                }
+                m_size = size;
+            }
+
+            /*
+                @brief Creates a small array list from a given array.
+                @param arr The array to copy.
+                @param size The size of the array.
+                @param alloc The allocator to use once the elements spill to the heap.
+             */
+            SmallArrayList(T* arr, uint size, const A& alloc = A()) : SmallArrayList(alloc)
+            {
+                insertRange(arr, size, 0);
+            }
+
+            /*
+                @brief Creates a small array list from a given small array list object.
+                @param arr The small array list to copy.
+             */
+            SmallArrayList(const SmallArrayList<T, N, A>& arr) : SmallArrayList(std::allocator_traits<A>::select_on_container_copy_construction(arr.m_alloc))
+            {
+                insertRange(arr.m_arr, arr.m_size, 0);
+            }
+
+            /*
+                @brief Creates a small array list by taking the contents of another small array list.
+                Steals the heap storage if the other list has spilled, otherwise moves the inline elements.
+                The other small array list is left empty.
+                @param arr The small array list to move from.
+             */
+            SmallArrayList(SmallArrayList<T, N, A>&& arr) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallArrayList(arr.m_alloc)
+            {
+                takeFrom(arr);
+            }
+
+            /*
+                @brief Creates a small array list from a given initializer list.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use once the elements spill to the heap.
+             */
+            SmallArrayList(std::initializer_list<T> list, const A& alloc = A()) : SmallArrayList(alloc)
+            {
+                insertRange(list.begin(), list.size(), 0);
+            }
+
+            /*
+                @brief Destroys the small array list object and frees any heap memory.
+             */
+            ~SmallArrayList()
+            {
+                DestroyRange(m_arr, 0, m_size);
+                deallocate();
+            }
+
+            /*
+                @brief Searches a small array list for a given element using linear search.
+                Works for all arrays, ideal for unsorted arrays.
+                Runtime complexity: O(n)
+                @param elem The element to search for.
+                @return The index of the element in the small array list, or -1 if the element is not found.
+             */
+            int linearSearch(T elem)
+            {
+                return LinearSearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Searches a small array list for a given element using binary search.
+                Only works for sorted arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log n)
+                @param elem The element to search for.
+                @return The index of the element in the small array list, or -1 if the element is not found.
+             */
+            int binarySearch(T elem)
+            {
+                return BinarySearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Searches a small array list for a given element using interpolation search.
+                Only works for sorted arrays, ideal for uniformly distributed arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(log log n), worst case O(n)
+                @param elem The element to search for.
+                @return The index of the element in the small array list, or -1 if the element is not found.
+             */
+            int interpolationSearch(T elem)
+            {
+                return InterpolationSearch(m_arr, m_size, elem);
+            }
+
+            /*
+                @brief Checks if a small array list contains a given element.
+                Uses linear search.
+                @param elem The element to search for.
+                @return True if the element is found, false otherwise.
+             */
+            bool contains(T elem)
+            {
+                return linearSearch(elem) != -1;
+            }
+
+            /*
+                @brief Sorts a small array list using the bubble sort algorithm.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void bubbleSort()
+            {
+                BubbleSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts a small array list using the selection sort algorithm.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n^2)
+             */
+            void selectionSort()
+            {
+                SelectionSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts a small array list in ascending order using a stable, natural merge sort (TimSort).
+                Ideal for larger arrays, and for arrays that are already partly sorted.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+             */
+            void mergeSort()
+            {
+                MergeSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts a small array list using a stable, natural merge sort (TimSort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n), O(n) for sorted or reversed arrays
+                Space complexity: O(n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void mergeSort(Cmp cmp)
+            {
+                MergeSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Sorts a small array list of integers or floats in ascending order, using LSD radix sort.
+                Ideal for large arrays of numbers.
+             !  Only works for integers and floats of at most 64 bits.
+                Runtime complexity: O(n * k), where k is the size of the type in bytes
+                Space complexity: O(n)
+             */
+            void radixSort()
+            {
+                RadixSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts a small array list by an integer or float key, using LSD radix sort.
+                Stable.
+             !  The key function must return an integer or float of at most 64 bits, and must not throw.
+                Runtime complexity: O(n * k), where k is the number of bytes in the key
+                Space complexity: O(n)
+                @param keyFn A function taking an element and returning its key.
+             */
+            template<typename KeyFn>
+            void radixSortByKey(KeyFn keyFn)
+            {
+                RadixSortByKey(m_arr, m_size, keyFn);
+            }
+
+            /*
+                @brief Sorts a small array list in ascending order on multiple threads, using a parallel merge sort.
+                Ideal for very large arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool, and is the default.
+                @param stable Whether equal elements keep their relative order.
+                False by default.
+             */
+            void parallelSort(uint threads = 0, bool stable = false)
+            {
+                ParallelSort(m_arr, m_size, threads, stable);
+            }
+
+            /*
+                @brief Sorts a small array list on multiple threads, using a parallel merge sort.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+             !  The comparator is called from several threads at once.
+                Runtime complexity: O(n log n / p + n)
+                Space complexity: O(n)
+                @param threads The number of threads to use, including the calling thread.
+                0 uses every thread of the default pool.
+                @param stable Whether equal elements keep their relative order.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void parallelSort(uint threads, bool stable, Cmp cmp)
+            {
+                ParallelSort(m_arr, m_size, threads, stable, cmp);
+            }
+
+            /*
+                @brief Sorts a small array list in ascending order using pattern-defeating quick sort (pdqsort).
+                Ideal for most arrays.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+             */
+            void quickSort()
+            {
+                QuickSort(m_arr, m_size);
+            }
+
+            /*
+                @brief Sorts a small array list using pattern-defeating quick sort (pdqsort).
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log n) worst case
+                Space complexity: O(log n)
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void quickSort(Cmp cmp)
+            {
+                QuickSort(m_arr, m_size, cmp);
+            }
+
+            /*
+                @brief Rearranges the small array list so that the element at index n is the one that would be there if it were sorted in ascending order.
+                No element before it is greater, and no element after it is smaller.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+             */
+            void nthElement(uint n)
+            {
+                NthElement(m_arr, m_size, n);
+            }
+
+            /*
+                @brief Rearranges the small array list so that the element at index n is the one that would be there if it were sorted.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n)
+                @param n The index of the element to put in its sorted place.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void nthElement(uint n, Cmp cmp)
+            {
+                NthElement(m_arr, m_size, n, cmp);
+            }
+
+            /*
+                @brief Sorts the k smallest elements of the small array list in ascending order at its front, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+             */
+            void partialSort(uint k)
+            {
+                PartialSort(m_arr, m_size, k);
+            }
+
+            /*
+                @brief Sorts the first k elements of the small array list according to a comparator, leaving the rest in an unspecified order.
+             !  Will throw an error if the value type in the array is not comparable with the comparator.
+                Runtime complexity: O(n log k) for a small k, O(n + k log k) otherwise
+                @param k The number of elements to sort.
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void partialSort(uint k, Cmp cmp)
+            {
+                PartialSort(m_arr, m_size, k, cmp);
+            }
+
+            /*
+                @brief Returns the size of the small array list.
+                @return The number of elements in the small array list.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the number of elements the small array list can hold before it has to grow.
+                @return The capacity of the small array list, at least N.
+             */
+            uint capacity() const
+            {
+                return m_cap;
+            }
+
+            /*
+                @brief Removes all elements from the small array list.
+                Keeps the capacity so the small array list can be refilled without reallocating.
+             */
+            void clear()
+            {
+                DestroyRange(m_arr, 0, m_size);
+                m_size = 0;
+            }
+
+            /*
+                @brief Returns a copy of the allocator the small array list uses.
+                @return The allocator.
+             */
+            A getAllocator() const
+            {
+                return m_alloc;
+            }
+
+            /*
+                @brief Checks if the elements are still stored inline.
+                @return True if the small array list has not spilled to the heap, false otherwise.
+             */
+            bool isInline() const
+            {
+                return m_arr == inlineData();
+            }
+
+            /*
+                @brief Makes room for a number of elements so that adding them does not reallocate.
+             *  Does not construct any elements.
+                @param cap The number of elements to make room for.
+             */
+            void reserve(uint cap)
+            {
+                if (cap > m_cap) reallocate(cap);
+            }
+
+            /*
+                @brief Frees any heap capacity that is not being used by elements.
+                Moves the elements back inline if they fit.
+             */
+            void shrinkToFit()
+            {
+                if (!isInline() && m_cap > m_size) reallocate(m_size);
+            }
+
+            /*
+                @brief Constructs an element in place at the end of the small array list.
+                Runtime complexity: O(1) amortized
+                @param args The arguments to construct the element with.
+                @return A reference to the new element.
+             */
+            template<typename... Args>
+            T& emplace(Args&&... args)
+            {
+                if (m_size == m_cap)
+                {
+                    // Build the element before growing, in case the arguments refer to an element of this list.
+                    T elem(std::forward<Args>(args)...);
+                    reallocate(m_cap * 2);
+                    new (m_arr + m_size) T(std::move(elem));
+                }
+                else new (m_arr + m_size) T(std::forward<Args>(args)...);
+
+                m_size++;
+                return m_arr[m_size - 1];
+            }
+
+            /*
+                @brief Adds an element to the end of the small array list.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void add(const T& elem)
+            {
+                emplace(elem);
+            }
+
+            /*
+                @brief Adds an element to the end of the small array list, moving from it.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void add(T&& elem)
+            {
+                emplace(std::move(elem));
+            }
+
+            /*
+                @brief Inserts an element at a given index in the small array list.
+                Runtime complexity: O(n - index)
+                @param elem The element to insert.
+                @param index The index to insert the element at.
+             */
+            void insert(T elem, int index)
+            {
+                if (index < 0 || index > m_size) OutOfBounds(index, m_size);
+                emplace(std::move(elem));
+                std::rotate(m_arr + index, m_arr + m_size - 1, m_arr + m_size);
+            }
+
+            /*
+                @brief Inserts a range of elements at a given index in the small array list.
+                Runtime complexity: O(n - index + count)
+                @param arr The elements to insert.
+                @param count The number of elements to insert.
+                @param index The index to insert the first element at.
+             */
+            void insertRange(const T* arr, uint count, int index)
+            {
+                if (index < 0 || index > m_size) OutOfBounds(index, m_size);
+                if (count == 0) return;
+
+                // Growing would free the source range if it lies inside this list, so copy it out first.
+                if (!std::less<const T*>()(arr, m_arr) && std::less<const T*>()(arr, m_arr + m_size))
+                {
+                    ArrayList<T, A> copy((T*)arr, count, m_alloc);
+                    insertRange(copy.data(), count, index);
+                    return;
+                }
+
+                if (m_size + count > m_cap) reallocate(Max(m_cap * 2, m_size + count));
+
+                uint oldSize = m_size;
+                for (uint i = 0; i < count; i++)
+                {
+                    new (m_arr + m_size) T(arr[i]);
+                    m_size++;
+                }
+                std::rotate(m_arr + index, m_arr + oldSize, m_arr + m_size);
+            }
+
+            /*
+                @brief Removes an element at a given index in the small array list.
+                Runtime complexity: O(n - index)
+                @param index The index to remove the element at.
+             */
+            void remove(int index)
+            {
+                if (index < 0 || index >= m_size) OutOfBounds(index, m_size);
+                removeRange(index, index + 1);
+            }
+
+            /*
+                @brief Removes a range of elements from the small array list.
+                Runtime complexity: O(n - start)
+                @param start The start index of the range, inclusive.
+                @param end The end index of the range, exclusive.
+             */
+            void removeRange(int start, int end)
+            {
+                if (start < 0 || start > m_size) OutOfBounds(start, m_size);
+                if (end < start || end > m_size) OutOfBounds(end, m_size);
+                if (start == end) return;
+
+                std::move(m_arr + end, m_arr + m_size, m_arr + start);
+                DestroyRange(m_arr, m_size - (end - start), m_size);
+                m_size -= end - start;
+            }
+
+            /*
+                @brief Removes the last element in the small array list.
+                Runtime complexity: O(1)
+                @return The removed element.
+             */
+            T pop()
+            {
+                if (m_size == 0)
+                {
+                    Sapphire::Err("DSA::SmallArrayList --> cannot pop from an empty array list");
+                    throw std::runtime_error("Sapphire: DSA::SmallArrayList --> cannot pop from an empty array list");
+                }
+
+                m_size--;
+                T elem = std::move(m_arr[m_size]);
+                m_arr[m_size].~T();
+                return elem;
+            }
+
+            /*
+                @brief Removes all elements that satisfy a predicate, compacting the rest in a single pass.
+                Runtime complexity: O(n)
+                @param pred A function taking an element and returning true if it should be removed.
+                @return The number of elements removed.
+             */
+            template<typename Pred>
+            uint removeIf(Pred pred)
+            {
+                uint kept = 0;
+                for (uint i = 0; i < m_size; i++)
+                {
+                    if (pred(m_arr[i])) continue;
+                    if (kept != i) m_arr[kept] = std::move(m_arr[i]);
+                    kept++;
+                }
+
+                uint removed = m_size - kept;
+                DestroyRange(m_arr, kept, m_size);
+                m_size = kept;
+                return removed;
+            }
+
+            /*
+                @brief Keeps only the elements that satisfy a predicate, compacting them in a single pass.
+                Runtime complexity: O(n)
+                @param pred A function taking an element and returning true if it should be kept.
+                @return The number of elements removed.
+             */
+            template<typename Pred>
+            uint retain(Pred pred)
+            {
+                return removeIf([&pred](const T& elem) { return !pred(elem); });
+            }
+
+            /*
+                @brief Removes all occurrences of a given element in the small array list.
+                Runtime complexity: O(n)
+                @param elem The element to remove.
+             */
+            void removeAll(T elem)
+            {
+                removeIf([&elem](const T& other) { return other == elem; });
+            }
+
+            /*
+                @brief Returns the underlying array/pointer.
+                @return The small array list data.
+             */
+            T* data()
+            {
+                return m_arr;
+            }
+
+            /*
+                @brief Returns the underlying array/pointer.
+                @return The small array list data.
+             */
+            const T* data() const
+            {
+                return m_arr;
+            }
+
+            T& operator[](int index)
+            {
+                if (index < 0 || index >= m_size) OutOfBounds(index, m_size);
+                return m_arr[index];
+            }
+
+            SmallArrayList<T, N, A>& operator=(const SmallArrayList<T, N, A>& other)
+            {
+                if (this == &other) return *this;
+                DestroyRange(m_arr, 0, m_size);
+                m_size = 0;
+                insertRange(other.m_arr, other.m_size, 0);
+                return *this;
+            }
+
+            SmallArrayList<T, N, A>& operator=(SmallArrayList<T, N, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value && std::is_nothrow_move_constructible_v<T>)
+            {
+                if (this == &other) return *this;
+                DestroyRange(m_arr, 0, m_size);
+                deallocate();
+                m_size = 0;
+                takeFrom(other);
+                return *this;
+            }
+
+            friend bool operator==(const SmallArrayList<T, N, A>& arr1, const SmallArrayList<T, N, A>& arr2)
+            {
+                if (arr1.m_size != arr2.m_size) return false;
+                for (uint i = 0; i < arr1.m_size; i++)
+                {
+                    if (arr1.m_arr[i] != arr2.m_arr[i]) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const SmallArrayList<T, N, A>& arr1, const SmallArrayList<T, N, A>& arr2)
+            {
+                return !(arr1 == arr2);
+            }
+
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+                using pointer = T*;
+                using reference = T&;
+
+                Iterator(pointer ptr) : m_ptr(ptr) {}
+                
+                reference operator*() const 
+                { 
+                    return *m_ptr; 
+                }
+                
+                pointer operator->() 
+                {
+                    return m_ptr; 
+                }
+
+                Iterator& operator++() 
+                {
+                    m_ptr++; return *this;
+                }
+
+                Iterator operator++(int) 
+                {
+                    Iterator tmp = *this; ++(*this); return tmp; 
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2) 
+                { 
+                    return it1.m_ptr == it2.m_ptr; 
+                };
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
+                {
+                    return it1.m_ptr != it2.m_ptr; 
+                };
+
+            private:
+                pointer m_ptr;
+            };
+
+            Iterator begin() 
+            {
+                return Iterator(m_arr); 
+            }
+
+            Iterator end() 
+            {
+                return Iterator(m_arr + m_size); 
+            }
+
+        private:
+            T* m_arr;
+            uint m_cap;
+            uint m_size;
+            alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+            [[no_unique_address]] A m_alloc;
+
+            static constexpr bool RELOCATE_WITH_REALLOC = std::is_trivially_copyable_v<T> && requires(A& alloc, T* p, size_t n) { alloc.reallocate(p, n, n); };
+
+            T* inlineData()
+            {
+                return reinterpret_cast<T*>(m_inline);
+            }
+
+            const T* inlineData() const
+            {
+                return reinterpret_cast<const T*>(m_inline);
+            }
+
+            T* allocate(uint cap)
+            {
+                return std::allocator_traits<A>::allocate(m_alloc, cap);
+            }
+
+            void deallocate()
+            {
+                if (!isInline()) std::allocator_traits<A>::deallocate(m_alloc, m_arr, m_cap);
+                m_arr = inlineData();
+                m_cap = N;
+            }
+
+            static void DestroyRange(T* arr, uint start, uint end)
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (uint i = start; i < end; i++)
+                    {
+                        arr[i].~T();
+                    }
+                }
+            }
+
+            [[noreturn]] static void OutOfBounds(int index, uint size)
+            {
+                Sapphire::Err("DSA::SmallArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+                throw std::runtime_error("Sapphire: DSA::SmallArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+            }
+
+            /*
+                @brief Moves the elements into storage of a given capacity.
+                Capacities up to N use the inline storage, larger ones use the heap.
+                @param cap The new capacity, which must be at least the size.
+             */
+            void reallocate(uint cap)
+            {
+                bool wasInline = isInline();
+                if (cap <= N)
+                {
+                    if (wasInline) return;
+                    cap = N;
+                }
+
+                if constexpr (RELOCATE_WITH_REALLOC)
+                {
+                    if (!wasInline && cap > N)
+                    {
+                        m_arr = m_alloc.reallocate(m_arr, m_cap, cap);
+                        m_cap = cap;
+                        return;
+                    }
+                }
+
+                T* arr = cap == N ? inlineData() : allocate(cap);
+                uint i = 0;
+                try
+                {
+                    for (; i < m_size; i++)
+                    {
+                        new (arr + i) T(std::move_if_noexcept(m_arr[i]));
+                    }
+                }
+                catch (...)
+                {
+                    // Inline storage has nothing to free.
+                    DestroyRange(arr, 0, i);
+                    if (cap != N) std::allocator_traits<A>::deallocate(m_alloc, arr, cap);
+                    throw;
+                }
+                DestroyRange(m_arr, 0, m_size);
+                deallocate();
+                m_arr = arr;
+                m_cap = cap;
+            }
+
+            void takeFrom(SmallArrayList<T, N, A>& other)
+            {
+                // Heap storage can only be adopted if this list's allocator can free it.
+                if (other.isInline() || !(m_alloc == other.m_alloc))
+                {
+                    reserve(other.m_size);
+                    for (uint i = 0; i < other.m_size; i++)
+                    {
+                        new (m_arr + i) T(std::move(other.m_arr[i]));
+                    }
+                    m_size = other.m_size;
+                    DestroyRange(other.m_arr, 0, other.m_size);
+                    other.deallocate();
+                }
+                else
+                {
+                    m_arr = other.m_arr;
+                    m_cap = other.m_cap;
+                    m_size = other.m_size;
+                    other.m_arr = other.inlineData();
+                    other.m_cap = N;
+                }
+                other.m_size = 0;
+            }
+        };
+
+        /*
+            @brief A class to represent a double-ended queue, known as std::deque in C++ and ArrayDeque in Java.
+            The elements are kept in a ring buffer whose capacity is a power of two, so adding or removing at either end
+            is O(1) and never shifts the other elements, which makes it the container to use as a FIFO queue or sliding window.
+            The elements occupy at most two contiguous runs of the buffer, exposed by firstData() and secondData(),
+            so the array functions of this namespace can run on them directly.
+            @param A The allocator to allocate the elements with.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class ArrayDeque
+        {
+        public:
+            /*
+                @brief Creates an empty array deque.
+                Does not allocate until the first element is added.
+                @param alloc The allocator to use.
+             */
+            ArrayDeque(const A& alloc = A()) : m_alloc(alloc)
+            {
+                m_arr = nullptr;
+                m_cap = 0;
+                m_head = 0;
+                m_size = 0;
+            }
+
+            /*
+                @brief Creates an array deque from a given initializer list.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            ArrayDeque(std::initializer_list<T> list, const A& alloc = A()) : ArrayDeque(alloc)
+            {
+                reserve((uint)list.size());
+                for (const T& elem : list)
+                {
+                    new (m_arr + m_size) T(elem);
+                    m_size++;
+                }
+            }
+
+            /*
+                @brief Creates an array deque from a given array deque object.
+                The copy starts at the beginning of its buffer, so its elements are contiguous.
+                @param other The array deque to copy.
+             */
+            ArrayDeque(const ArrayDeque<T, A>& other) : ArrayDeque(std::allocator_traits<A>::select_on_container_copy_construction(other.m_alloc))
+            {
+                reserve(other.m_size);
+                for (; m_size < other.m_size; m_size++)
+                {
+                    new (m_arr + m_size) T(other.m_arr[other.slot(m_size)]);
+                }
+            }
+
+            /*
+                @brief Creates an array deque by taking the contents of another array deque.
+                The other array deque is left empty, without any capacity.
+                @param other The array deque to move from.
+             */
+            ArrayDeque(ArrayDeque<T, A>&& other) noexcept : ArrayDeque(other.m_alloc)
+            {
+                swap(other);
+            }
+
+            /*
+                @brief Destroys the array deque object and frees the memory.
+             */
+            ~ArrayDeque()
+            {
+                clear();
+                if (m_arr != nullptr) std::allocator_traits<A>::deallocate(m_alloc, m_arr, m_cap);
+            }
+
+            /*
+                @brief Constructs an element in place at the back of the array deque.
+                Runtime complexity: O(1) amortized
+                @param args The arguments to construct the element with.
+                @return A reference to the new element.
+             */
+            template<typename... Args>
+            T& emplaceBack(Args&&... args)
+            {
+                if (m_size == m_cap)
+                {
+                    // Build the element before growing, in case the arguments refer to an element of this deque.
+                    T elem(std::forward<Args>(args)...);
+                    grow();
+                    return emplaceBack(std::move(elem));
+                }
+
+                T* elem = new (m_arr + slot(m_size)) T(std::forward<Args>(args)...);
+                m_size++;
+                return *elem;
+            }
+
+            /*
+                @brief Constructs an element in place at the front of the array deque.
+                Runtime complexity: O(1) amortized
+                @param args The arguments to construct the element with.
+                @return A reference to the new element.
+             */
+            template<typename... Args>
+            T& emplaceFront(Args&&... args)
+            {
+                if (m_size == m_cap)
+                {
+                    T elem(std::forward<Args>(args)...);
+                    grow();
+                    return emplaceFront(std::move(elem));
+                }
+
+                uint head = (m_head - 1) & (m_cap - 1);
+                T* elem = new (m_arr + head) T(std::forward<Args>(args)...);
+                m_head = head;
+                m_size++;
+                return *elem;
+            }
+
+            /*
+                @brief Adds an element to the back of the array deque.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void pushBack(const T& elem)
+            {
+                emplaceBack(elem);
+            }
+
+            /*
+                @brief Adds an element to the back of the array deque, moving from it.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void pushBack(T&& elem)
+            {
+                emplaceBack(std::move(elem));
+            }
+
+            /*
+                @brief Adds an element to the front of the array deque.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void pushFront(const T& elem)
+            {
+                emplaceFront(elem);
+            }
+
+            /*
+                @brief Adds an element to the front of the array deque, moving from it.
+                Runtime complexity: O(1) amortized
+                @param elem The element to add.
+             */
+            void pushFront(T&& elem)
+            {
+                emplaceFront(std::move(elem));
+            }
+
+            /*
+                @brief Removes the last element in the array deque.
+             !  Throws std::runtime_error if the array deque is empty.
+                Runtime complexity: O(1)
+                @return The removed element.
+             */
+            T popBack()
+            {
+                if (m_size == 0) Empty("pop from");
+
+                T* last = m_arr + slot(m_size - 1);
+                T elem = std::move(*last);
+                last->~T();
+                m_size--;
+                return elem;
+            }
+
+            /*
+                @brief Removes the first element in the array deque.
+             !  Throws std::runtime_error if the array deque is empty.
+                Runtime complexity: O(1)
+                @return The removed element.
+             */
+            T popFront()
+            {
+                if (m_size == 0) Empty("pop from");
+
+                T* first = m_arr + m_head;
+                T elem = std::move(*first);
+                first->~T();
+                m_head = (m_head + 1) & (m_cap - 1);
+                m_size--;
+                return elem;
+            }
+
+            /*
+                @brief Returns the first element in the array deque.
+             !  Throws std::runtime_error if the array deque is empty.
+                @return A reference to the first element.
+             */
+            T& front()
+            {
+                if (m_size == 0) Empty("get the front of");
+                return m_arr[m_head];
+            }
+
+            /*
+                @brief Returns the last element in the array deque.
+             !  Throws std::runtime_error if the array deque is empty.
+                @return A reference to the last element.
+             */
+            T& back()
+            {
+                if (m_size == 0) Empty("get the back of");
+                return m_arr[slot(m_size - 1)];
+            }
+
+            /*
+                @brief Returns the number of elements in the array deque.
+                @return The size of the array deque.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the number of elements the array deque can hold before it has to grow.
+                @return The capacity of the array deque, 0 or a power of two.
+             */
+            uint capacity() const
+            {
+                return m_cap;
+            }
+
+            /*
+                @brief Makes room for a number of elements so that adding them does not reallocate.
+                The capacity is rounded up to a power of two.
+                @param cap The number of elements to make room for.
+             */
+            void reserve(uint cap)
+            {
+                if (cap <= m_cap) return;
+                if (cap > MAX_CAPACITY) TooLarge(cap);
+                uint newCap = 8;
+                while (newCap < cap) newCap <<= 1;
+                reallocate(newCap);
+            }
+
+            /*
+                @brief Removes all elements from the array deque, keeping its capacity.
+             */
+            void clear()
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (uint i = 0; i < m_size; i++)
+                    {
+                        m_arr[slot(i)].~T();
+                    }
+                }
+                m_head = 0;
+                m_size = 0;
+            }
+
+            /*
+                @brief Returns the first contiguous run of elements, starting at the front.
+                Together with secondData(), covers every element in order.
+                @return A pointer to the front element, or nullptr if the array deque has never allocated.
+             */
+            T* firstData()
+            {
+                return m_arr == nullptr ? nullptr : m_arr + m_head;
+            }
+
+            /*
+                @brief Returns the number of elements in the run returned by firstData().
+                @return The size of the first run.
+             */
+            uint firstSize() const
+            {
+                return m_cap - m_head < m_size ? m_cap - m_head : m_size;
+            }
+
+            /*
+                @brief Returns the second contiguous run of elements, which follows the first one when the elements wrap around the buffer.
+                @return A pointer to the start of the buffer, or nullptr if the array deque has never allocated.
+             */
+            T* secondData()
+            {
+                return m_arr;
+            }
+
+            /*
+                @brief Returns the number of elements in the run returned by secondData().
+                @return The size of the second run, 0 if the elements are contiguous.
+             */
+            uint secondSize() const
+            {
+                return m_size - firstSize();
+            }
+
+            /*
+                @brief Rearranges the elements so that they are contiguous, in order.
+                Trivially copyable elements are rotated in place, others are moved into a new buffer.
+                Runtime complexity: O(n) if the elements wrap around, O(1) otherwise
+                @return A pointer to the first of size() contiguous elements.
+             */
+            T* makeContiguous()
+            {
+                if (secondSize() == 0) return firstData();
+
+                if constexpr (std::is_trivially_copyable_v<T>) std::rotate(m_arr, m_arr + m_head, m_arr + m_cap);
+                else reallocate(m_cap);
+                m_head = 0;
+                return m_arr;
+            }
+
+            /*
+                @brief Searches the array deque for a given element using linear search.
+                Runtime complexity: O(n)
+                @param elem The element to search for.
+                @return The index of the element from the front, or -1 if the element is not found.
+             */
+            int linearSearch(T elem)
+            {
+                uint first = firstSize();
+                if (first == 0) return -1;
+
+                int index = LinearSearch(firstData(), first, elem);
+                if (index != -1 || secondSize() == 0) return index;
+
+                index = LinearSearch(secondData(), secondSize(), elem);
+                return index == -1 ? -1 : (int)first + index;
+            }
+
+            /*
+                @brief Checks if the array deque contains a given element.
+                Runtime complexity: O(n)
+                @param elem The element to search for.
+                @return True if the element is found, false otherwise.
+             */
+            bool contains(T elem)
+            {
+                return linearSearch(elem) != -1;
+            }
+
+            /*
+                @brief Sorts the array deque in ascending order using pattern-defeating quick sort (pdqsort).
+                The elements are made contiguous first.
+             !  Will throw an error if the value type in the array deque is not comparable.
+                Runtime complexity: O(n log n) worst case
+             */
+            void quickSort()
+            {
+                if (m_size != 0) QuickSort(makeContiguous(), m_size);
+            }
+
+            /*
+                @brief Sorts the array deque using pattern-defeating quick sort (pdqsort).
+                The elements are made contiguous first.
+                Runtime complexity: O(n log n) worst case
+                @param cmp A function taking two elements and returning true if the first goes before the second.
+             */
+            template<typename Cmp>
+            void quickSort(Cmp cmp)
+            {
+                if (m_size != 0) QuickSort(makeContiguous(), m_size, cmp);
+            }
+
+            T& operator[](int index)
+            {
+                if (index < 0 || (uint)index >= m_size) OutOfBounds(index, m_size);
+                return m_arr[slot(index)];
+            }
+
+            ArrayDeque<T, A>& operator=(const ArrayDeque<T, A>& other)
+            {
+                if (this == &other) return *this;
+                clear();
+                reserve(other.m_size);
+                for (; m_size < other.m_size; m_size++)
+                {
+                    new (m_arr + m_size) T(other.m_arr[other.slot(m_size)]);
+                }
+                return *this;
+            }
+
+            ArrayDeque<T, A>& operator=(ArrayDeque<T, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+                if (m_alloc == other.m_alloc)
+                {
+                    swap(other);
+                    other.clear();
+                }
+                else
+                {
+                    // Storage from another allocator cannot be adopted, so move the elements over instead.
+                    clear();
+                    reserve(other.m_size);
+                    for (; m_size < other.m_size; m_size++)
+                    {
+                        new (m_arr + m_size) T(std::move(other.m_arr[other.slot(m_size)]));
+                    }
+                    other.clear();
+                }
+                return *this;
+            }
+
+            friend bool operator==(const ArrayDeque<T, A>& deque1, const ArrayDeque<T, A>& deque2)
+            {
+                if (deque1.m_size != deque2.m_size) return false;
+                for (uint i = 0; i < deque1.m_size; i++)
+                {
+                    if (deque1.m_arr[deque1.slot(i)] != deque2.m_arr[deque2.slot(i)]) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const ArrayDeque<T, A>& deque1, const ArrayDeque<T, A>& deque2)
+            {
+                return !(deque1 == deque2);
+            }
+
+            class Iterator
+            {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+                using pointer = T*;
+                using reference = T&;
+
+                Iterator() : m_arr(nullptr), m_mask(0), m_head(0), m_index(0) {}
+                Iterator(pointer arr, uint mask, uint head, difference_type index) : m_arr(arr), m_mask(mask), m_head(head), m_index(index) {}
+
+                reference operator*() const
+                {
+                    return m_arr[(m_head + m_index) & m_mask];
+                }
+
+                pointer operator->() const
+                {
+                    return m_arr + ((m_head + m_index) & m_mask);
+                }
+
+                reference operator[](difference_type offset) const
+                {
+                    return m_arr[(m_head + m_index + offset) & m_mask];
+                }
+
+                Iterator& operator++()
+                {
+                    m_index++; return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator tmp = *this; ++(*this); return tmp;
+                }
+
+                Iterator& operator--()
+                {
+                    m_index--; return *this;
+                }
+
+                Iterator operator--(int)
+                {
+                    Iterator tmp = *this; --(*this); return tmp;
+                }
+
+                Iterator& operator+=(difference_type offset)
+                {
+                    m_index += offset; return *this;
+                }
+
+                Iterator& operator-=(difference_type offset)
+                {
+                    m_index -= offset; return *this;
+                }
+
+                friend Iterator operator+(Iterator it, difference_type offset)
+                {
+                    return it += offset;
+                }
+
+                friend Iterator operator+(difference_type offset, Iterator it)
+                {
+                    return it += offset;
+                }
+
+                friend Iterator operator-(Iterator it, difference_type offset)
+                {
+                    return it -= offset;
+                }
+
+                friend difference_type operator-(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index - it2.m_index;
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index == it2.m_index;
+                }
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index != it2.m_index;
+                }
+
+                friend bool operator<(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index < it2.m_index;
+                }
+
+                friend bool operator>(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index > it2.m_index;
+                }
+
+                friend bool operator<=(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index <= it2.m_index;
+                }
+
+                friend bool operator>=(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_index >= it2.m_index;
+                }
+
+            private:
+                pointer m_arr;
+                uint m_mask;
+                uint m_head;
+                difference_type m_index;
+            };
+
+            Iterator begin()
+            {
+                return Iterator(m_arr, m_cap - 1, m_head, 0);
+            }
+
+            Iterator end()
+            {
+                return Iterator(m_arr, m_cap - 1, m_head, m_size);
+            }
+
+        private:
+            T* m_arr;
+            uint m_cap;
+            uint m_head;
+            uint m_size;
+
+            [[no_unique_address]] A m_alloc;
+
+            // The largest power of two a uint can hold.
+            static constexpr uint MAX_CAPACITY = 1u << 31;
+
+            // The buffer index of the element at a given position from the front.
+            uint slot(uint index) const
+            {
+                return (m_head + index) & (m_cap - 1);
+            }
+
+            [[noreturn]] static void Empty(const std::string& action)
+            {
+                Sapphire::Err("DSA::ArrayDeque --> cannot " + action + " an empty array deque");
+                throw std::runtime_error("Sapphire: DSA::ArrayDeque --> cannot " + action + " an empty array deque");
+            }
+
+            [[noreturn]] static void OutOfBounds(int index, uint size)
+            {
+                Sapphire::Err("DSA::ArrayDeque --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+                throw std::runtime_error("Sapphire: DSA::ArrayDeque --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+            }
+
+            [[noreturn]] static void TooLarge(ulonglong cap)
+            {
+                Sapphire::Err("DSA::ArrayDeque --> cannot hold more than " + std::to_string(MAX_CAPACITY) + " elements (requested: " + std::to_string(cap) + ")");
+                throw std::length_error("Sapphire: DSA::ArrayDeque --> cannot hold more than " + std::to_string(MAX_CAPACITY) + " elements (requested: " + std::to_string(cap) + ")");
+            }
+
+            void swap(ArrayDeque<T, A>& other)
+            {
+                std::swap(m_arr, other.m_arr);
+                std::swap(m_cap, other.m_cap);
+                std::swap(m_head, other.m_head);
+                std::swap(m_size, other.m_size);
+            }
+
+            /*
+                @brief Moves the elements, in order, to the start of a new buffer of a given capacity.
+                Trivially copyable elements are copied in at most two blocks.
+                @param cap The new capacity, a power of two at least the size.
+             */
+            void reallocate(uint cap)
+            {
+                T* arr = std::allocator_traits<A>::allocate(m_alloc, cap);
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    uint first = firstSize();
+                    if (first != 0) std::memcpy(arr, m_arr + m_head, first * sizeof(T));
+                    if (m_size != first) std::memcpy(arr + first, m_arr, (m_size - first) * sizeof(T));
+                }
+                else
+                {
+                    uint i = 0;
+                    try
+                    {
+                        for (; i < m_size; i++)
+                        {
+                            new (arr + i) T(std::move_if_noexcept(m_arr[slot(i)]));
+                        }
+                    }
+                    catch (...)
+                    {
+                        for (uint j = 0; j < i; j++)
+                        {
+                            arr[j].~T();
+                        }
+                        std::allocator_traits<A>::deallocate(m_alloc, arr, cap);
+                        throw;
+                    }
+                    for (uint i = 0; i < m_size; i++)
+                    {
+                        m_arr[slot(i)].~T();
+                    }
+                }
+                if (m_arr != nullptr) std::allocator_traits<A>::deallocate(m_alloc, m_arr, m_cap);
+                m_arr = arr;
+                m_cap = cap;
+                m_head = 0;
+            }
+
+            void grow()
+            {
+                if (m_cap == MAX_CAPACITY) TooLarge((ulonglong)m_cap + 1);
+                reallocate(m_cap == 0 ? 8 : m_cap * 2);
+            }
+        };
+
+        /*
+            @brief A read-only index over sorted keys, laid out as a static B+ tree for fast searching.
+            The keys are stored in sorted order in the bottom layer, with layers of separator keys above them,
+            in nodes of 16 keys, so each step down the tree reads one or two adjacent cache lines
+            and picks the child by counting the keys below the search key without branching.
+            Compared to a binary search, which misses the cache on almost every probe of a large array,
+            a search touches one node per layer, and the upper layers stay in cache.
+            Ideal for large lookup tables that are built once and searched often.
+         !  The keys must be sorted in ascending order, and are copied into the index.
+            Space complexity: O(n), about 1/16 more than the keys
+            @param A The allocator to allocate the keys with.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class SortedIndex
+        {
+        public:
+            /*
+                @brief Creates an empty index.
+                @param alloc The allocator to use.
+             */
+            SortedIndex(const A& alloc = A()) : m_keys(alloc)
+            {
+                m_size = 0;
+                m_height = 0;
+            }
+
+            /*
+                @brief Creates an index over sorted keys.
+                Runtime complexity: O(n)
+                @param keys The sorted keys.
+                @param size The number of keys.
+                @param alloc The allocator to use.
+             */
+            SortedIndex(const T* keys, uint size, const A& alloc = A()) : SortedIndex(alloc)
+            {
+                build(keys, size);
+            }
+
+            /*
+                @brief Creates an index over a sorted array.
+                Runtime complexity: O(n)
+                @param arr The sorted array.
+                @param alloc The allocator to use.
+             */
+            template<typename A2>
+            SortedIndex(const Array<T, A2>& arr, const A& alloc = A()) : SortedIndex(alloc)
+            {
+                build(arr.data(), arr.size());
+            }
+
+            /*
+                @brief Creates an index over a sorted array list.
+                Runtime complexity: O(n)
+                @param list The sorted array list.
+                @param alloc The allocator to use.
+             */
+            template<typename A2>
+            SortedIndex(const ArrayList<T, A2>& list, const A& alloc = A()) : SortedIndex(alloc)
+            {
+                build(list.data(), list.size());
+            }
+
+            /*
+                @brief Gets the index of a key in the sorted keys.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key equal to the given key, or -1 if the key is not found.
+             */
+            int find(const T& key) const
+            {
+                uint i = lowerBound(key);
+                return i < m_size && !(key < m_keys.data()[i]) ? (int)i : -1;
+            }
+
+            /*
+                @brief Checks if the index contains a key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const T& key) const
+            {
+                return find(key) != -1;
+            }
+
+            /*
+                @brief Gets the index of the first key that is not less than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key >= the given key, or size() if there is none.
+             */
+            uint lowerBound(const T& key) const
+            {
+                if (m_size == 0 || m_keys.data()[m_size - 1] < key) return m_size;
+                return search<false>(key);
+            }
+
+            /*
+                @brief Gets the index of the first key that is greater than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key > the given key, or size() if there is none.
+             */
+            uint upperBound(const T& key) const
+            {
+                if (m_size == 0 || !(key < m_keys.data()[m_size - 1])) return m_size;
+                return search<true>(key);
+            }
+
+            /*
+                @brief Gets the number of keys that are less than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to rank.
+                @return The number of keys < the given key.
+             */
+            uint rank(const T& key) const
+            {
+                return lowerBound(key);
+            }
+
+            /*
+                @brief Returns the number of keys in the index.
+                @return The number of keys.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Gets the key at a position in sorted order.
+                @param index The position of the key.
+                @return The key.
+             */
+            const T& operator[](uint index) const
+            {
+                if (index >= m_size)
+                {
+                    Sapphire::Err("DSA::SortedIndex --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                    throw std::runtime_error("Sapphire: DSA::SortedIndex --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                }
+                return m_keys.data()[index];
+            }
+
+        private:
+            static constexpr uint NODE_KEYS = 16;
+            static constexpr uint MAX_LAYERS = 16;
+
+            // The bottom layer, at offset 0, holds the keys in order. Layer h > 0 holds, for each node, the first key
+            // under each of its children but the first, so a node of layer h has NODE_KEYS + 1 children in layer h - 1.
+            // Nodes are padded with the largest key, which a search never counts as it checks against the largest key first.
+            ArrayList<T, A> m_keys;
+            uint m_layerOffsets[MAX_LAYERS];
+            uint m_size;
+            uint m_height;
+
+            void build(const T* keys, uint size)
+            {
+                m_size = size;
+                if (size == 0) return;
+
+                uint layerNodes[MAX_LAYERS];
+                layerNodes[0] = (size + NODE_KEYS - 1) / NODE_KEYS;
+                m_layerOffsets[0] = 0;
+                m_height = 1;
+                uint total = layerNodes[0] * NODE_KEYS;
+                while (layerNodes[m_height - 1] > 1)
+                {
+                    layerNodes[m_height] = (layerNodes[m_height - 1] + NODE_KEYS) / (NODE_KEYS + 1);
+                    m_layerOffsets[m_height] = total;
+                    total += layerNodes[m_height] * NODE_KEYS;
+                    m_height++;
+                }
+
+                m_keys.reserve(total);
+                m_keys.insertRange(keys, size, 0);
+                const T& largest = keys[size - 1];
+                while (m_keys.size() < layerNodes[0] * NODE_KEYS) m_keys.add(largest);
+
+                // Child j + 1 of a node of layer h starts at leaf node child * (NODE_KEYS + 1)^(h - 1).
+                size_t leavesPerChild = 1;
+                for (uint h = 1; h < m_height; h++)
+                {
+                    for (size_t node = 0; node < layerNodes[h]; node++)
+                    {
+                        for (size_t j = 0; j < NODE_KEYS; j++)
+                        {
+                            size_t leaf = (node * (NODE_KEYS + 1) + j + 1) * leavesPerChild;
+                            m_keys.add(leaf < layerNodes[0] ? keys[leaf * NODE_KEYS] : largest);
+                        }
+                    }
+                    leavesPerChild *= NODE_KEYS + 1;
+                }
+            }
+
+            // Counts the keys of a node that are less than key, or not greater than key when Upper.
+            template<bool Upper>
+            static uint CountBelow(const T* node, const T& key)
+            {
+                uint count = 0;
+                for (uint j = 0; j < NODE_KEYS; j++)
+                {
+                    if constexpr (Upper) count += !(key < node[j]);
+                    else count += node[j] < key;
+                }
+                return count;
+            }
+
+            // Assumes the key is not greater than the largest key (or less than it when Upper), so the result is in bounds.
+            template<bool Upper>
+            uint search(const T& key) const
+            {
+                const T* keys = m_keys.data();
+                size_t node = 0;
+                for (uint h = m_height - 1; h > 0; h--)
+                {
+                    node = node * (NODE_KEYS + 1) + CountBelow<Upper>(keys + m_layerOffsets[h] + node * NODE_KEYS, key);
+
+                    // Nodes of larger keys span two cache lines, start loading both.
+                    const T* child = keys + m_layerOffsets[h - 1] + node * NODE_KEYS;
+                    Detail::Prefetch(child);
+                    Detail::Prefetch(child + NODE_KEYS - 1);
+                }
+                return (uint)(node * NODE_KEYS + CountBelow<Upper>(keys + node * NODE_KEYS, key));
+            }
+        };
+
+        /*
+            @brief An accumulator that keeps the k elements that go first according to a comparator, out of a stream of elements.
+            With the default comparator, it keeps the k largest elements.
+            The elements are kept in a bounded heap whose top is the element that would be dropped next,
+            so an element that does not make it costs one comparison, and one that does costs O(log k).
+            Ideal for getting the top results of input that is too large to store, or that arrives over time.
+            Space complexity: O(k)
+            @param Cmp A function object taking two elements and returning true if the first goes before the second.
+            @param A The allocator to allocate the elements with.
+         */
+        template<typename T, typename Cmp = Greater<T>, typename A = Memory::HeapAllocator<T>>
+        class TopK
+        {
+        public:
+            /*
+                @brief Creates an empty accumulator.
+                @param k The number of elements to keep.
+                @param cmp The comparator to use.
+                @param alloc The allocator to use.
+             */
+            TopK(uint k, Cmp cmp = Cmp(), const A& alloc = A()) : m_heap(alloc), m_cmp(cmp)
+            {
+                m_k = k;
+            }
+
+            /*
+                @brief Offers an element to the accumulator.
+                Runtime complexity: O(log k) if the element is kept, O(1) otherwise
+                @param elem The element to offer.
+                @return True if the element is kept, false if the kept elements all go before it.
+             */
+            bool push(const T& elem)
+            {
+                // Once full, which is the common case, most elements are rejected by one comparison with the top.
+                if (m_heap.size() == m_k)
+                {
+                    if (m_k == 0 || !m_cmp(elem, m_heap.data()[0])) return false;
+                    replaceTop(elem);
+                    return true;
+                }
+
+                m_heap.add(elem);
+                std::push_heap(m_heap.data(), m_heap.data() + m_heap.size(), m_cmp);
+                return true;
+            }
+
+            /*
+                @brief Offers an element to the accumulator, moving it in if it is kept.
+                Runtime complexity: O(log k) if the element is kept, O(1) otherwise
+                @param elem The element to offer.
+                @return True if the element is kept, false if the kept elements all go before it.
+             */
+            bool push(T&& elem)
+            {
+                // Once full, which is the common case, most elements are rejected by one comparison with the top.
+                if (m_heap.size() == m_k)
+                {
+                    if (m_k == 0 || !m_cmp(elem, m_heap.data()[0])) return false;
+                    replaceTop(std::move(elem));
+                    return true;
+                }
+
+                m_heap.add(std::move(elem));
+                std::push_heap(m_heap.data(), m_heap.data() + m_heap.size(), m_cmp);
+                return true;
+            }
+
+            /*
+                @brief Offers every element of an array to the accumulator.
+                Runtime complexity: O(n log k) worst case, O(n) when few elements are kept
+                @param arr The array of elements to offer.
+                @param size The size of the array.
+             */
+            void pushRange(const T* arr, uint size)
+            {
+                uint i = 0;
+                for (; i < size && m_heap.size() < m_k; i++) push(arr[i]);
+                if (m_k == 0) return;
+
+                for (; i < size; i++)
+                {
+                    if (m_cmp(arr[i], m_heap.data()[0])) replaceTop(arr[i]);
+                }
+            }
+
+            /*
+                @brief Offers every element kept by another accumulator to this one.
+                Lets separate threads each fill their own accumulator, to be merged at the end.
+                Runtime complexity: O(k log k)
+                @param other The accumulator to merge.
+             */
+            void merge(const TopK<T, Cmp, A>& other)
+            {
+                pushRange(other.m_heap.data(), other.m_heap.size());
+            }
+
+            /*
+                @brief Gets the kept element that would be dropped first, the last one of the top k.
+                Once the accumulator is full, only elements that go before it are kept.
+             !  Throws std::runtime_error if no element is kept.
+                @return The last kept element.
+             */
+            const T& last() const
+            {
+                if (m_heap.size() == 0)
+                {
+                    Sapphire::Err("DSA::TopK --> no elements are kept");
+                    throw std::runtime_error("Sapphire: DSA::TopK --> no elements are kept");
+                }
+                return m_heap.data()[0];
+            }
+
+            /*
+                @brief Gets the kept elements in order, the first according to the comparator first.
+                Runtime complexity: O(k log k)
+                @return An array list of the kept elements.
+             */
+            ArrayList<T, A> sorted() const
+            {
+                ArrayList<T, A> list = m_heap;
+                std::sort_heap(list.data(), list.data() + list.size(), m_cmp);
+                return list;
+            }
+
+            /*
+                @brief Gets the kept elements in heap order, without sorting them.
+                @return A pointer to the kept elements.
+             */
+            const T* data() const
+            {
+                return m_heap.data();
+            }
+
+            /*
+                @brief Returns the number of kept elements, at most k.
+                @return The number of kept elements.
+             */
+            uint size() const
+            {
+                return m_heap.size();
+            }
+
+            /*
+                @brief Returns the number of elements the accumulator keeps when full.
+                @return k.
+             */
+            uint getK() const
+            {
+                return m_k;
+            }
+
+            /*
+                @brief Drops every kept element.
+             */
+            void clear()
+            {
+                m_heap.clear();
+            }
+
+        private:
+            ArrayList<T, A> m_heap;
+            Cmp m_cmp;
+            uint m_k;
+
+            template<typename U>
+            void replaceTop(U&& elem)
+            {
+                T* heap = m_heap.data();
+                uint size = m_heap.size();
+                std::pop_heap(heap, heap + size, m_cmp);
+                heap[size - 1] = std::forward<U>(elem);
+                std::push_heap(heap, heap + size, m_cmp);
+            }
+        };
+
+        /*
+            @brief A class to represent a pair of values.
+         */
+        template<typename T1, typename T2>
+        struct Pair
+        {
+            T1 first;
+            T2 second;
+
+            /*
+                @brief Creates an empty pair (with garbage values).
+             */
+            Pair() {}
+
+            /*
+                @brief Creates a pair from two given values.
+                @param first The first value.
+                @param second The second value.
+             */
+            Pair(T1 first, T2 second) : first(std::forward<T1>(first)), second(std::forward<T2>(second)) {}
+
+            Pair(const Pair<T1, T2>& other) = default;
+            Pair(Pair<T1, T2>&& other) = default;
+            Pair<T1, T2>& operator=(const Pair<T1, T2>& other) = default;
+            Pair<T1, T2>& operator=(Pair<T1, T2>&& other) = default;
+
+            friend bool operator==(const Pair<T1, T2>& pair1, const Pair<T1, T2>& pair2)
+            {
+                return pair1.first == pair2.first && pair1.second == pair2.second;
+            }
+
+            friend bool operator!=(const Pair<T1, T2>& pair1, const Pair<T1, T2>& pair2)
+            {
+                return !(pair1 == pair2);
+            }
+        };
+
+        namespace Detail
+        {
+            // Formats a key for the "key not found" errors of the maps: numbers as they are, strings in quotes.
+            template<typename K>
+            std::string KeyToString(const K& key)
+            {
+                if constexpr (std::is_arithmetic_v<K>) return std::to_string(key);
+                else if constexpr (std::is_convertible_v<const K&, std::string>) return "\"" + std::string(key) + "\"";
+                else return "(unprintable)";
+            }
+        }
+
+        /*
+            @brief A class to represent a hash map, known as std::unordered_map in C++ and a HashMap in Java and some other languages.
+            Uses open addressing over groups of 16 control bytes, which are probed with SSE2/NEON where available.
+            Entries are stored densely in insertion order, so iterating a hash map walks a contiguous array.
+         *  Erasing moves the last entry into the erased entry's place, so it changes the iteration order.
+         *  Adding or erasing entries invalidates iterators and pointers returned by find().
+            @param H The hash function object.
+            @param A The allocator to allocate the entries with, which is rebound for the control bytes and slots.
+         */
+        template<typename K, typename V, typename H = std::hash<K>, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class HashMap
+        {
+        public:
+            /*
+                @brief Creates an empty hash map.
+                Does not allocate any slots until the first element is added.
+                @param alloc The allocator to use.
+             */
+            HashMap(const A& alloc = A()) : m_list(alloc)
+            {
+                m_ctrl = nullptr;
+                m_slots = nullptr;
+                m_cap = 0;
+                m_growthLeft = 0;
+                m_maxLoad = DEFAULT_MAX_LOAD;
+            }
+
+            /*
+                @brief Creates a hash map from a given array list of pairs.
+             *  If a key appears more than once, the last value wins.
+                @param list The array list to copy.
+             */
+            HashMap(ArrayList<Pair<K, V>, A> list) : HashMap(list.getAllocator())
+            {
+                reserve(list.size());
+                for (int i = 0; i < list.size(); i++)
+                {
+                    set(list[i].first, list[i].second);
+                }
+            }
+
+            /*
+                @brief Creates a hash map from a given initializer list of pairs.
+             *  If a key appears more than once, the last value wins.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            HashMap(std::initializer_list<Pair<K, V>> list, const A& alloc = A()) : HashMap(alloc)
+            {
+                reserve(list.size());
+                for (const Pair<K, V>& pair : list)
+                {
+                    set(pair.first, pair.second);
+                }
+            }
+
+            /*
+                @brief Creates a hash map from a given hash map object.
+                @param other The hash map to copy.
+             */
+            HashMap(const HashMap<K, V, H, A>& other) : HashMap(std::allocator_traits<A>::select_on_container_copy_construction(other.m_list.getAllocator()))
+            {
+                copyFrom(other);
+            }
+
+            /*
+                @brief Creates a hash map by taking the contents of another hash map.
+                The other hash map is left empty.
+                @param other The hash map to move from.
+             */
+            HashMap(HashMap<K, V, H, A>&& other) noexcept : HashMap(other.m_list.getAllocator())
+            {
+                swap(other);
+            }
+
+            /*
+                @brief Destroys the hash map object and frees the memory.
+             */
+            ~HashMap()
+            {
+                freeTable();
+            }
+
+            V& operator[](K key)
+            {
+                V* value = find(key);
+                if (value == nullptr)
+                {
+                    Sapphire::Err("DSA::HashMap --> key " + Detail::KeyToString(key) + " not found");
+                    throw std::runtime_error("Sapphire: DSA::HashMap --> key " + Detail::KeyToString(key) + " not found");
+                }
+                return *value;
+            }
+
+            HashMap<K, V, H, A>& operator=(const HashMap<K, V, H, A>& other)
+            {
+                if (this != &other) copyFrom(other);
+                return *this;
+            }
+
+            HashMap<K, V, H, A>& operator=(HashMap<K, V, H, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+                if (m_list.getAllocator() == other.m_list.getAllocator())
+                {
+                    swap(other);
+                    other.clear();
+                }
+                else copyFrom(other);
+                return *this;
+            }
+
+            friend bool operator==(const HashMap<K, V, H, A>& map1, const HashMap<K, V, H, A>& map2)
+            {
+                if (map1.size() != map2.size()) return false;
+                for (uint i = 0; i < map1.size(); i++)
+                {
+                    const Pair<K, V>& entry = map1.m_list.data()[i];
+                    const V* value = map2.find(entry.first);
+                    if (value == nullptr || !(*value == entry.second)) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const HashMap<K, V, H, A>& map1, const HashMap<K, V, H, A>& map2)
+            {
+                return !(map1 == map2);
+            }
+
+            /*
+                @brief Sets the value of a key, adding the key if it is not in the hash map yet.
+                Runtime complexity: O(1) average
+                @param key The key to set.
+                @param value The value to set.
+             */
+            void set(K key, V value)
+            {
+                ulonglong hash = Hash(key);
+                int slot = findSlot(key, hash);
+                if (slot != -1)
+                {
+                    m_list.data()[m_slots[slot]].second = std::move(value);
+                    return;
+                }
+
+                // The slot is claimed first, because a rehash while claiming it must not see the new entry yet.
+                uint index = m_list.size();
+                insertSlot(hash, index);
+                try
+                {
+                    m_list.emplace(std::move(key), std::move(value));
+                }
+                catch (...)
+                {
+                    clearSlot(findSlotOfIndex(hash, index));
+                    throw;
+                }
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(1) average
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the hash map.
+             */
+            V* find(const K& key)
+            {
+                int slot = findSlot(key, Hash(key));
+                return slot == -1 ? nullptr : &m_list.data()[m_slots[slot]].second;
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(1) average
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the hash map.
+             */
+            const V* find(const K& key) const
+            {
+                int slot = findSlot(key, Hash(key));
+                return slot == -1 ? nullptr : &m_list.data()[m_slots[slot]].second;
+            }
+
+            /*
+                @brief Finds the values of many keys at once.
+                The lookups go through the table in groups, prefetching the control bytes, slot and entry of every key
+                in a group before probing any of them, so their cache misses overlap instead of stalling one lookup at a time.
+                Much faster than calling find() in a loop once the hash map does not fit in the cache.
+                Runtime complexity: O(n) average
+                @param keys The keys to search for.
+                @param count The number of keys.
+                @param values Receives a pointer to the value of each key, or nullptr if the key is not in the hash map.
+                @return The number of keys found.
+             */
+            uint findMany(const K* keys, uint count, V** values)
+            {
+                return findManyImpl(keys, count, values);
+            }
+
+            /*
+                @brief Finds the values of many keys at once.
+                The lookups go through the table in groups, prefetching the control bytes, slot and entry of every key
+                in a group before probing any of them, so their cache misses overlap instead of stalling one lookup at a time.
+                Much faster than calling find() in a loop once the hash map does not fit in the cache.
+                Runtime complexity: O(n) average
+                @param keys The keys to search for.
+                @param count The number of keys.
+                @param values Receives a pointer to the value of each key, or nullptr if the key is not in the hash map.
+                @return The number of keys found.
+             */
+            uint findMany(const K* keys, uint count, const V** values) const
+            {
+                return findManyImpl(keys, count, values);
+            }
+
+            /*
+                @brief Checks if the hash map contains a given key.
+                Runtime complexity: O(1) average
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key) const
+            {
+                return findSlot(key, Hash(key)) != -1;
+            }
+
+            /*
+                @brief Removes a key and its value from the hash map.
+             *  The last entry is moved into the removed entry's place in the iteration order.
+                Runtime complexity: O(1) average
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the hash map.
+             */
+            bool erase(const K& key)
+            {
+                int slot = findSlot(key, Hash(key));
+                if (slot == -1) return false;
+
+                uint index = m_slots[slot];
+                clearSlot(slot);
+
+                uint last = m_list.size() - 1;
+                if (index != last)
+                {
+                    Pair<K, V>* entries = m_list.data();
+                    m_slots[findSlotOfIndex(Hash(entries[last].first), last)] = index;
+                    entries[index] = std::move(entries[last]);
+                }
+                m_list.pop();
+                return true;
+            }
+
+            /*
+                @brief Makes room for a number of entries so that adding them does not rehash.
+                @param count The number of entries to make room for.
+             */
+            void reserve(uint count)
+            {
+                m_list.reserve(count);
+                uint cap = GROUP_WIDTH;
+                while (maxEntriesFor(cap) < count) cap *= 2;
+                if (cap > m_cap) rehash(cap);
+            }
+
+            /*
+                @brief Removes all entries from the hash map.
+                Keeps the allocated slots so the hash map can be refilled without rehashing.
+             */
+            void clear()
+            {
+                m_list.clear();
+                if (m_cap == 0) return;
+                std::memset(m_ctrl, CTRL_EMPTY, m_cap);
+                m_growthLeft = maxEntriesFor(m_cap);
+            }
+
+            /*
+                @brief Returns the number of entries in the hash map.
+                @return The number of entries in the hash map.
+             */
+            uint size() const
+            {
+                return m_list.size();
+            }
+
+            /*
+                @brief Returns the number of slots in the hash map.
+                @return The number of slots, always 0 or a power of two.
+             */
+            uint capacity() const
+            {
+                return m_cap;
+            }
+
+            /*
+                @brief Returns the current load factor of the hash map.
+                @return The number of entries divided by the number of slots.
+             */
+            float loadFactor() const
+            {
+                return m_cap == 0 ? 0.0f : (float)size() / m_cap;
+            }
+
+            /*
+                @brief Returns the load factor at which the hash map grows.
+                @return The maximum load factor.
+             */
+            float getMaxLoadFactor() const
+            {
+                return m_maxLoad;
+            }
+
+            /*
+                @brief Sets the load factor at which the hash map grows.
+                Lower values use more memory for shorter probe sequences.
+             *  The value is clamped to the range [0.25, 0.95].
+             *  Rehashes immediately if the hash map is already over the new maximum.
+                @param maxLoad The maximum load factor.
+             */
+            void setMaxLoadFactor(float maxLoad)
+            {
+                m_maxLoad = Min(Max(maxLoad, 0.25f), 0.95f);
+                if (m_cap == 0) return;
+
+                uint cap = GROUP_WIDTH;
+                while (maxEntriesFor(cap) < size()) cap *= 2;
+                rehash(Max(cap, m_cap));
+            }
+
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = Pair<K, V>;
+                using pointer = Pair<K, V>*;
+                using reference = Pair<K, V>&;
+
+                Iterator(pointer ptr) : m_ptr(ptr) {}
+                
+                reference operator*() const 
+                { 
+                    return *m_ptr; 
+                }
+                
+                pointer operator->() 
+                {
+                    return m_ptr; 
+                }
+
+                Iterator& operator++() 
+                {
+                    m_ptr++; return *this;
+                }
+
+                Iterator operator++(int) 
+                {
+                    Iterator tmp = *this; ++(*this); return tmp; 
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2) 
+                { 
+                    return it1.m_ptr == it2.m_ptr; 
+                };
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
+                {
+                    return it1.m_ptr != it2.m_ptr; 
+                };
+
+            private:
+                pointer m_ptr;
+            };
+
+            Iterator begin() 
+            {
+                return Iterator(m_list.data()); 
+            }
+
+            Iterator end() 
+            {
+                return Iterator(m_list.data() + m_list.size()); 
+            }
+            
+        private:
+            static constexpr uint GROUP_WIDTH = 16;
+            static constexpr ubyte CTRL_EMPTY = 0x80;
+            static constexpr ubyte CTRL_DELETED = 0xFE;
+            static constexpr float DEFAULT_MAX_LOAD = 0.875f;
+
+            using ByteAllocator = typename std::allocator_traits<A>::template rebind_alloc<ubyte>;
+            using IndexAllocator = typename std::allocator_traits<A>::template rebind_alloc<uint>;
+
+            ArrayList<Pair<K, V>, A> m_list;
+            ubyte* m_ctrl;
+            uint* m_slots;
+            uint m_cap;
+            uint m_growthLeft;
+            float m_maxLoad;
+
+            static ulonglong Hash(const K& key)
+            {
+                // std::hash is the identity for integers on most standard libraries, so mix the bits
+                // to spread both the group index (high bits) and the control byte (low 7 bits).
+                ulonglong hash = (ulonglong)H{}(key);
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdULL;
+                hash ^= hash >> 33;
+                return hash;
+            }
+
+            static uint CountTrailingZeros(uint mask)
+            {
+                #if defined(__GNUC__) || defined(__clang__)
+                    return __builtin_ctz(mask);
+                #else
+                    uint count = 0;
+                    while ((mask & 1) == 0)
+                    {
+                        mask >>= 1;
+                        count++;
+                    }
+                    return count;
+                #endif
+            }
+
+            /*
+                @brief Compares a group of 16 control bytes against a value.
+                @return A bitmask with bit i set if control byte i equals the value.
+             */
+            static uint MatchByte(const ubyte* group, ubyte value)
+            {
+                #if defined(SIMD_SSE2)
+                    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+                    return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+                #elif defined(SIMD_NEON)
+                    return NeonMask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(value)));
+                #else
+                    uint mask = 0;
+                    for (uint i = 0; i < GROUP_WIDTH; i++)
+                    {
+                        if (group[i] == value) mask |= 1u << i;
+                    }
+                    return mask;
+                #endif
+            }
+
+            /*
+                @brief Finds the empty and deleted control bytes in a group, which both have the high bit set.
+                @return A bitmask with bit i set if slot i can take a new entry.
+             */
+            static uint MatchEmptyOrDeleted(const ubyte* group)
+            {
+                #if defined(SIMD_SSE2)
+                    return (uint)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+                #elif defined(SIMD_NEON)
+                    return NeonMask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0)));
+                #else
+                    uint mask = 0;
+                    for (uint i = 0; i < GROUP_WIDTH; i++)
+                    {
+                        if (group[i] & 0x80) mask |= 1u << i;
+                    }
+                    return mask;
+                #endif
+            }
+
+            #if defined(SIMD_NEON)
+                static uint NeonMask(uint8x16_t eq)
+                {
+                    static const ubyte weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+                    uint8x16_t bits = vandq_u8(eq, vld1q_u8((const uint8_t*)weights));
+                    return (uint)vaddv_u8(vget_low_u8(bits)) | ((uint)vaddv_u8(vget_high_u8(bits)) << 8);
+                }
+            #endif
+
+            uint maxEntriesFor(uint cap) const
+            {
+                // Always leave at least one empty slot so that probing for a missing key terminates.
+                uint max = (uint)(cap * m_maxLoad);
+                return max >= cap ? cap - 1 : max;
+            }
+
+            /*
+                @brief Finds the slot holding a key.
+                Probes one group at a time, stopping at the first group that has an empty slot.
+                @return The slot index, or -1 if the key is not in the hash map.
+             */
+            int findSlot(const K& key, ulonglong hash) const
+            {
+                if (m_cap == 0) return -1;
+
+                const Pair<K, V>* entries = m_list.data();
+                ubyte h2 = (ubyte)(hash & 0x7F);
+                uint groupMask = m_cap / GROUP_WIDTH - 1;
+                uint group = (uint)(hash >> 7) & groupMask;
+
+                for (uint step = 1; step <= groupMask + 1; step++)
+                {
+                    const ubyte* ctrl = m_ctrl + group * GROUP_WIDTH;
+                    for (uint match = MatchByte(ctrl, h2); match != 0; match &= match - 1)
+                    {
+                        uint slot = group * GROUP_WIDTH + CountTrailingZeros(match);
+                        if (entries[m_slots[slot]].first == key) return (int)slot;
+                    }
+                    if (MatchByte(ctrl, CTRL_EMPTY) != 0) return -1;
+                    group = (group + step) & groupMask;
+                }
+                return -1;
+            }
+
+            template<typename P>
+            uint findManyImpl(const K* keys, uint count, P* values) const
+            {
+                if (m_cap == 0)
+                {
+                    for (uint i = 0; i < count; i++) values[i] = nullptr;
+                    return 0;
+                }
+
+                const Pair<K, V>* entries = m_list.data();
+                uint found = 0;
+                if ((size_t)m_cap * (1 + sizeof(uint)) + (size_t)size() * sizeof(Pair<K, V>) <= Detail::BATCH_PREFETCH_MIN_BYTES)
+                {
+                    // A table this small stays in the cache, where the prefetching stages are pure overhead.
+                    for (uint i = 0; i < count; i++)
+                    {
+                        int slot = findSlot(keys[i], Hash(keys[i]));
+                        values[i] = slot == -1 ? nullptr : (P)&entries[m_slots[slot]].second;
+                        found += slot != -1;
+                    }
+                    return found;
+                }
+
+                uint groupMask = m_cap / GROUP_WIDTH - 1;
+                ulonglong hashes[Detail::BATCH_GROUP_SIZE];
+                uint candidates[Detail::BATCH_GROUP_SIZE];
+
+                for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+                {
+                    uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                    const K* batch = keys + start;
+
+                    // Each stage only touches memory the previous stage prefetched, and ends by prefetching what the next one needs.
+                    for (uint k = 0; k < group; k++)
+                    {
+                        hashes[k] = Hash(batch[k]);
+                        Detail::Prefetch(m_ctrl + ((uint)(hashes[k] >> 7) & groupMask) * GROUP_WIDTH);
+                    }
+                    for (uint k = 0; k < group; k++)
+                    {
+                        uint home = ((uint)(hashes[k] >> 7) & groupMask) * GROUP_WIDTH;
+                        uint match = MatchByte(m_ctrl + home, (ubyte)(hashes[k] & 0x7F));
+                        candidates[k] = match == 0 ? m_cap : home + CountTrailingZeros(match);
+                        if (match != 0) Detail::Prefetch(m_slots + candidates[k]);
+                    }
+                    for (uint k = 0; k < group; k++)
+                    {
+                        if (candidates[k] != m_cap) Detail::Prefetch(entries + m_slots[candidates[k]]);
+                    }
+                    for (uint k = 0; k < group; k++)
+                    {
+                        int slot = findSlot(batch[k], hashes[k]);
+                        values[start + k] = slot == -1 ? nullptr : (P)&entries[m_slots[slot]].second;
+                        found += slot != -1;
+                    }
+                }
+                return found;
+            }
+
+            uint findSlotOfIndex(ulonglong hash, uint index) const
+            {
+                ubyte h2 = (ubyte)(hash & 0x7F);
+                uint groupMask = m_cap / GROUP_WIDTH - 1;
+                uint group = (uint)(hash >> 7) & groupMask;
+
+                for (uint step = 1; ; step++)
+                {
+                    for (uint match = MatchByte(m_ctrl + group * GROUP_WIDTH, h2); match != 0; match &= match - 1)
+                    {
+                        uint slot = group * GROUP_WIDTH + CountTrailingZeros(match);
+                        if (m_slots[slot] == index) return slot;
+                    }
+                    group = (group + step) & groupMask;
+                }
+            }
+
+            /*
+                @brief Claims a slot for a new entry, growing the table first if it is full.
+                @param hash The hash of the new key.
+                @param index The index of the new entry in the dense entry list.
+             */
+            void insertSlot(ulonglong hash, uint index)
+            {
+                if (m_growthLeft == 0)
+                {
+                    // Rehash in place if tombstones are what filled the table, otherwise double it.
+                    if (m_cap != 0 && size() < maxEntriesFor(m_cap) / 2) rehash(m_cap);
+                    else rehash(m_cap == 0 ? GROUP_WIDTH : m_cap * 2);
+                }
+
+                uint groupMask = m_cap / GROUP_WIDTH - 1;
+                uint group = (uint)(hash >> 7) & groupMask;
+                for (uint step = 1; ; step++)
+                {
+                    uint match = MatchEmptyOrDeleted(m_ctrl + group * GROUP_WIDTH);
+                    if (match != 0)
+                    {
+                        uint slot = group * GROUP_WIDTH + CountTrailingZeros(match);
+                        if (m_ctrl[slot] == CTRL_EMPTY) m_growthLeft--;
+                        m_ctrl[slot] = (ubyte)(hash & 0x7F);
+                        m_slots[slot] = index;
+                        return;
+                    }
+                    group = (group + step) & groupMask;
+                }
+            }
+
+            void clearSlot(uint slot)
+            {
+                // A slot can go straight back to empty if its group already has an empty slot,
+                // because no probe sequence can have passed through this group to reach another one.
+                ubyte* group = m_ctrl + (slot / GROUP_WIDTH) * GROUP_WIDTH;
+                if (MatchByte(group, CTRL_EMPTY) != 0)
+                {
+                    m_ctrl[slot] = CTRL_EMPTY;
+                    m_growthLeft++;
+                }
+                else m_ctrl[slot] = CTRL_DELETED;
+            }
+
+            void rehash(uint cap)
+            {
+                freeTable();
+                allocateTable(cap);
+                std::memset(m_ctrl, CTRL_EMPTY, cap);
+                m_growthLeft = maxEntriesFor(cap);
+
+                const Pair<K, V>* entries = m_list.data();
+                for (uint i = 0; i < m_list.size(); i++)
+                {
+                    insertSlot(Hash(entries[i].first), i);
+                }
+            }
+
+            void allocateTable(uint cap)
+            {
+                ByteAllocator byteAlloc(m_list.getAllocator());
+                IndexAllocator indexAlloc(m_list.getAllocator());
+                m_ctrl = std::allocator_traits<ByteAllocator>::allocate(byteAlloc, cap);
+                m_slots = std::allocator_traits<IndexAllocator>::allocate(indexAlloc, cap);
+                m_cap = cap;
+            }
+
+            void freeTable()
+            {
+                ByteAllocator byteAlloc(m_list.getAllocator());
+                IndexAllocator indexAlloc(m_list.getAllocator());
+                if (m_ctrl != nullptr) std::allocator_traits<ByteAllocator>::deallocate(byteAlloc, m_ctrl, m_cap);
+                if (m_slots != nullptr) std::allocator_traits<IndexAllocator>::deallocate(indexAlloc, m_slots, m_cap);
+                m_ctrl = nullptr;
+                m_slots = nullptr;
+                m_cap = 0;
+                m_growthLeft = 0;
+            }
+
+            void copyFrom(const HashMap<K, V, H, A>& other)
+            {
+                freeTable();
+                m_list = other.m_list;
+                m_maxLoad = other.m_maxLoad;
+                if (other.m_cap == 0) return;
+
+                allocateTable(other.m_cap);
+                m_growthLeft = other.m_growthLeft;
+                std::memcpy(m_ctrl, other.m_ctrl, m_cap);
+                std::memcpy(m_slots, other.m_slots, m_cap * sizeof(uint));
+            }
+
+            // Each map frees its tables with its own allocator, so maps with unequal allocators swap copies instead.
+            void swap(HashMap<K, V, H, A>& other)
+            {
+                if (!(m_list.getAllocator() == other.m_list.getAllocator()))
+                {
+                    HashMap<K, V, H, A> taken(std::move(other));
+                    other.copyFrom(*this);
+                    copyFrom(taken);
+                    return;
+                }
+
+                std::swap(m_list, other.m_list);
+                std::swap(m_ctrl, other.m_ctrl);
+                std::swap(m_slots, other.m_slots);
+                std::swap(m_cap, other.m_cap);
+                std::swap(m_growthLeft, other.m_growthLeft);
+                std::swap(m_maxLoad, other.m_maxLoad);
+            }
+        };
+
+        namespace Detail
+        {
+            // Picks one of 2^bits shards for a hash. The sharded containers align each shard to a cache line,
+            // so that locking one shard does not invalidate its neighbours.
+            // Takes the top bits of a Fibonacci hash, which are independent of the bits HashMap uses within a shard.
+            inline uint ShardIndex(ulonglong hash, uint bits)
+            {
+                if (bits == 0) return 0;
+                return (uint)((hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+            }
+        }
+
+        /*
+            @brief A class to represent a hash map that can be used from many threads at once.
+            Keys are spread over independently locked shards, each of which is a HashMap,
+            so threads working on different shards never wait on each other.
+            Lookups take a shared lock, so readers of the same shard do not block each other either.
+         *  Values are returned by copy, because a reference could be invalidated by another thread.
+            @param H The hash function object.
+            @param A The allocator the shards allocate their entries with.
+         */
+        template<typename K, typename V, typename H = std::hash<K>, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class ConcurrentHashMap
+        {
+        public:
+            /*
+                @brief Creates an empty concurrent hash map.
+                @param shardCount The number of shards, rounded up to a power of two.
+                Enter 0 to use four shards per hardware thread.
+                0 by default.
+                @param alloc The allocator each shard allocates its entries with.
+             */
+            ConcurrentHashMap(uint shardCount = 0, const A& alloc = A())
+            {
+                if (shardCount == 0) shardCount = Max(std::thread::hardware_concurrency(), 1u) * 4;
+
+                m_shardBits = 0;
+                while ((1u << m_shardBits) < shardCount) m_shardBits++;
+                m_shardCount = 1u << m_shardBits;
+                m_shards = (Shard*)::operator new(m_shardCount * sizeof(Shard), std::align_val_t(alignof(Shard)));
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    new (m_shards + i) Shard(alloc);
+                }
+            }
+
+            ConcurrentHashMap(const ConcurrentHashMap<K, V, H, A>&) = delete;
+            ConcurrentHashMap<K, V, H, A>& operator=(const ConcurrentHashMap<K, V, H, A>&) = delete;
+
+            /*
+                @brief Destroys the concurrent hash map object and frees the memory.
+             !  Must not be called while other threads are still using the map.
+             */
+            ~ConcurrentHashMap()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    m_shards[i].~Shard();
+                }
+                ::operator delete(m_shards, std::align_val_t(alignof(Shard)));
+            }
+
+            /*
+                @brief Sets the value of a key, adding the key if it is not in the map yet.
+                @param key The key to set.
+                @param value The value to set.
+                @return True if the key was added, false if an existing value was replaced.
+             */
+            bool insertOrAssign(const K& key, const V& value)
+            {
+                Shard& shard = shardFor(key);
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                uint sizeBefore = shard.map.size();
+                shard.map.set(key, value);
+                return shard.map.size() != sizeBefore;
+            }
+
+            /*
+                @brief Gets the value of a key, computing and adding it first if the key is not in the map.
+                Other threads will never see two different values computed for the same key.
+             *  The compute function is called while the key's shard is locked, so it must not use this map.
+                @param key The key to look up.
+                @param compute A function taking the key and returning the value to add.
+                @return A copy of the value of the key.
+             */
+            template<typename F>
+            V computeIfAbsent(const K& key, F compute)
+            {
+                Shard& shard = shardFor(key);
+                {
+                    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                    const V* value = shard.map.find(key);
+                    if (value != nullptr) return *value;
+                }
+
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                V* value = shard.map.find(key);
+                if (value != nullptr) return *value;
+
+                V computed = compute(key);
+                shard.map.set(key, computed);
+                return computed;
+            }
+
+            /*
+                @brief Gets a copy of the value of a key.
+                @param key The key to search for.
+                @param out Set to the value of the key if it is found, left unchanged otherwise.
+                @return True if the key is found, false otherwise.
+             */
+            bool find(const K& key, V& out) const
+            {
+                Shard& shard = shardFor(key);
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                const V* value = shard.map.find(key);
+                if (value == nullptr) return false;
+                out = *value;
+                return true;
+            }
+
+            /*
+                @brief Checks if the map contains a given key.
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key) const
+            {
+                Shard& shard = shardFor(key);
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                return shard.map.contains(key);
+            }
+
+            /*
+                @brief Removes a key and its value from the map.
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the map.
+             */
+            bool erase(const K& key)
+            {
+                Shard& shard = shardFor(key);
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                return shard.map.erase(key);
+            }
+
+            /*
+                @brief Makes room for a number of entries, spread evenly over the shards.
+                @param count The number of entries to make room for.
+             */
+            void reserve(uint count)
+            {
+                uint perShard = count / m_shardCount + 1;
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+                    m_shards[i].map.reserve(perShard);
+                }
+            }
+
+            /*
+                @brief Removes all entries from the map, one shard at a time.
+             *  Entries added by other threads while clearing may survive.
+             */
+            void clear()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::unique_lock<std::shared_mutex> lock(m_shards[i].mutex);
+                    m_shards[i].map.clear();
+                }
+            }
+
+            /*
+                @brief Returns the number of entries in the map.
+             *  Shards are counted one at a time, so the result is only exact if no other thread is writing.
+                @return The number of entries in the map.
+             */
+            uint size() const
+            {
+                uint total = 0;
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+                    total += m_shards[i].map.size();
+                }
+                return total;
+            }
+
+            /*
+                @brief Returns the number of shards.
+                @return The number of shards, always a power of two.
+             */
+            uint shardCount() const
+            {
+                return m_shardCount;
+            }
+
+            /*
+                @brief Calls a function for every entry in the map.
+                Iteration is weakly consistent: each shard is visited under its own lock, so every entry
+                that is in the map for the whole call is visited exactly once, while entries added or
+                removed by other threads during the call may or may not be visited.
+             *  The function is called while a shard is locked for reading, so it must not write to this map.
+                @param fn A function taking the key and value of each entry.
+             */
+            template<typename F>
+            void forEach(F fn) const
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+                    for (Pair<K, V>& entry : m_shards[i].map)
+                    {
+                        fn((const K&)entry.first, (const V&)entry.second);
+                    }
+                }
+            }
+
+        private:
+            struct alignas(64) Shard
+            {
+                mutable std::shared_mutex mutex;
+                HashMap<K, V, H, A> map;
+
+                Shard(const A& alloc) : map(alloc) {}
+            };
+
+            Shard* m_shards;
+            uint m_shardCount;
+            uint m_shardBits;
+
+            Shard& shardFor(const K& key) const
+            {
+                return m_shards[Detail::ShardIndex((ulonglong)H{}(key), m_shardBits)];
+            }
+        };
+
+        /*
+            @brief A thread-safe table of interned strings, handing out a stable 32-bit ID for each distinct string.
+            Interning a string that is already in the table returns its existing ID, so equal strings always get equal IDs,
+            and comparing or hashing two strings comes down to comparing or hashing two integers:
+            key maps and sets by ID instead of by std::string, and store each distinct string once instead of once per copy.
+            IDs are dense, from 0 to size() - 1, so they can index arrays directly.
+            The characters are copied into an arena owned by the table and never move, so the views it returns stay valid as long as the table.
+            The table is split into shards like ConcurrentHashMap, each with its own lock, arena and index from strings to IDs,
+            and looking up the string of an ID does not lock at all.
+         *  Strings cannot be removed, the table only grows until it is destroyed.
+         *  Takes no allocator: the characters live in the table's own Memory::Arena instances, and the rest on the heap.
+            Space complexity: O(n + c), where c is the total number of characters
+         */
+        class StringTable
+        {
+        public:
+            // Returned by find() for a string that is not in the table.
+            static constexpr uint NOT_FOUND = 0xFFFFFFFF;
+
+            /*
+                @brief Creates an empty string table.
+                @param shardCount The number of shards, rounded up to a power of two.
+                Enter 0 to use four shards per hardware thread.
+                0 by default.
+             */
+            StringTable(uint shardCount = 0)
+            {
+                if (shardCount == 0) shardCount = Max(std::thread::hardware_concurrency(), 1u) * 4;
+
+                m_shardBits = 0;
+                while ((1u << m_shardBits) < shardCount) m_shardBits++;
+                m_shardCount = 1u << m_shardBits;
+                m_shards = (Shard*)::operator new(m_shardCount * sizeof(Shard), std::align_val_t(alignof(Shard)));
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    new (m_shards + i) Shard();
+                }
+
+                for (uint i = 0; i < CHUNK_COUNT; i++)
+                {
+                    m_chunks[i] = nullptr;
+                }
+                m_size = 0;
+            }
+
+            StringTable(const StringTable&) = delete;
+            StringTable& operator=(const StringTable&) = delete;
+
+            /*
+                @brief Destroys the string table and frees every string in it.
+             !  Must not be called while other threads are still using the table, and invalidates every view it returned.
+             */
+            ~StringTable()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    m_shards[i].~Shard();
+                }
+                ::operator delete(m_shards, std::align_val_t(alignof(Shard)));
+
+                for (uint i = 0; i < CHUNK_COUNT; i++)
+                {
+                    std::string_view* chunk = m_chunks[i].load(std::memory_order_relaxed);
+                    if (chunk != nullptr) ::operator delete(chunk);
+                }
+            }
+
+            /*
+                @brief Gets the ID of a string, adding the string to the table if it is not in it yet.
+                A string that is already in the table only takes its shard's lock for reading.
+                Runtime complexity: O(k) expected, where k is the length of the string
+                @param str The string to intern.
+                @return The ID of the string.
+             */
+            uint intern(std::string_view str)
+            {
+                Key key(str);
+                Shard& shard = shardFor(key.hash);
+                {
+                    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                    const uint* id = shard.ids.find(key);
+                    if (id != nullptr) return *id;
+                }
+
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                const uint* found = shard.ids.find(key);
+                if (found != nullptr) return *found;
+
+                // Copied with a null terminator, so the view's data() is also a C string.
+                char* chars = (char*)shard.arena.allocate(str.size() + 1, 1);
+                if (!str.empty()) std::memcpy(chars, str.data(), str.size());
+                chars[str.size()] = '\0';
+                key.str = std::string_view(chars, str.size());
+
+                uint id = m_size.load(std::memory_order_relaxed);
+                do
+                {
+                    if (id == NOT_FOUND)
+                    {
+                        Sapphire::Err("DSA::StringTable --> cannot intern more than " + std::to_string(NOT_FOUND) + " strings");
+                        throw std::length_error("Sapphire: DSA::StringTable --> cannot intern more than " + std::to_string(NOT_FOUND) + " strings");
+                    }
+                } while (!m_size.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+                // Written before the ID is published in the shard, so any thread that gets the ID from the table can resolve it.
+                uint offset;
+                std::string_view* chunk = chunkFor(id, offset);
+                chunk[offset] = key.str;
+                shard.ids.set(key, id);
+                return id;
+            }
+
+            /*
+                @brief Gets the ID of a string without adding it to the table.
+                Runtime complexity: O(k) expected, where k is the length of the string
+                @param str The string to search for.
+                @return The ID of the string, or NOT_FOUND if it was never interned.
+             */
+            uint find(std::string_view str) const
+            {
+                Key key(str);
+                Shard& shard = shardFor(key.hash);
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                const uint* id = shard.ids.find(key);
+                return id == nullptr ? NOT_FOUND : *id;
+            }
+
+            /*
+                @brief Checks if a string has been interned.
+                Runtime complexity: O(k) expected, where k is the length of the string
+                @param str The string to search for.
+                @return True if the string is in the table, false otherwise.
+             */
+            bool contains(std::string_view str) const
+            {
+                return find(str) != NOT_FOUND;
+            }
+
+            /*
+                @brief Gets the string of an ID, without locking.
+                The view is null-terminated, so its data() can be passed where a C string is expected.
+             !  The ID must have been returned by this table, to this thread or to one that handed it over.
+                Runtime complexity: O(1)
+                @param id The ID of the string.
+                @return A view of the string, valid as long as the table.
+             */
+            std::string_view operator[](uint id) const
+            {
+                if (id >= m_size.load(std::memory_order_relaxed))
+                {
+                    Sapphire::Err("DSA::StringTable --> ID " + std::to_string(id) + " is out of bounds (size: " + std::to_string(size()) + ")");
+                    throw std::runtime_error("Sapphire: DSA::StringTable --> ID " + std::to_string(id) + " is out of bounds (size: " + std::to_string(size()) + ")");
+                }
+
+                uint offset;
+                uint index = ChunkIndex(id, offset);
+                return m_chunks[index].load(std::memory_order_acquire)[offset];
+            }
+
+            /*
+                @brief Returns the number of strings in the table.
+                @return The number of strings, which is also the next ID to be handed out.
+             */
+            uint size() const
+            {
+                return m_size.load(std::memory_order_relaxed);
+            }
+
+            /*
+                @brief Returns the number of shards.
+                @return The number of shards, always a power of two.
+             */
+            uint shardCount() const
+            {
+                return m_shardCount;
+            }
+
+            /*
+                @brief Gets the number of bytes taken by the characters of the strings, including their null terminators.
+             *  Shards are counted one at a time, so the result is only exact if no other thread is interning.
+                @return The number of bytes used in the arenas.
+             */
+            size_t getBytesUsed() const
+            {
+                size_t total = 0;
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+                    total += m_shards[i].arena.getBytesUsed();
+                }
+                return total;
+            }
+
+        private:
+            // Chunk i holds the views of FIRST_CHUNK << i IDs, so 23 chunks cover every 32-bit ID
+            // and no chunk is ever moved or resized once published.
+            static constexpr uint FIRST_CHUNK_BITS = 10;
+            static constexpr uint CHUNK_COUNT = 33 - FIRST_CHUNK_BITS;
+
+            // A string with its hash, so that a string is hashed once per call, not once to pick the shard and again in the shard's map.
+            struct Key
+            {
+                std::string_view str;
+                size_t hash;
+
+                Key() : hash(0) {}
+                Key(std::string_view str) : str(str), hash(std::hash<std::string_view>{}(str)) {}
+
+                friend bool operator==(const Key& key1, const Key& key2)
+                {
+                    return key1.hash == key2.hash && key1.str == key2.str;
+                }
+            };
+
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const
+                {
+                    return key.hash;
+                }
+            };
+
+            struct alignas(64) Shard
+            {
+                mutable std::shared_mutex mutex;
+                HashMap<Key, uint, KeyHash> ids;
+                Memory::Arena arena;
+            };
+
+            Shard* m_shards;
+            uint m_shardCount;
+            uint m_shardBits;
+            std::atomic<std::string_view*> m_chunks[CHUNK_COUNT];
+            std::atomic<uint> m_size;
+
+            Shard& shardFor(size_t hash) const
+            {
+                return m_shards[Detail::ShardIndex((ulonglong)hash, m_shardBits)];
+            }
+
+            static uint ChunkIndex(uint id, uint& offset)
+            {
+                ulonglong shifted = (ulonglong)id + (1ull << FIRST_CHUNK_BITS);
+                uint index = (uint)std::bit_width(shifted) - 1 - FIRST_CHUNK_BITS;
+                offset = (uint)(shifted - (1ull << (index + FIRST_CHUNK_BITS)));
+                return index;
+            }
+
+            // Allocates the chunk of an ID the first time it is needed. Shards race for it, the first one to publish its chunk wins.
+            std::string_view* chunkFor(uint id, uint& offset)
+            {
+                uint index = ChunkIndex(id, offset);
+                std::string_view* chunk = m_chunks[index].load(std::memory_order_acquire);
+                if (chunk != nullptr) return chunk;
+
+                std::string_view* fresh = (std::string_view*)::operator new(sizeof(std::string_view) << (index + FIRST_CHUNK_BITS));
+                if (m_chunks[index].compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) return fresh;
+                ::operator delete(fresh);
+                return chunk;
+            }
+        };
+
+        namespace Detail
+        {
+            /*
+                @brief The implementation shared by LruCache and ClockCache, which only differ in how they pick the entry to evict.
+                Entries are stored densely in an ArrayList and found through a HashMap from keys to their index,
+                and evicting an entry moves the last entry into its place, so the storage never has holes.
+                With Clock false, unpinned entries are kept in a doubly linked list through their indices, from the most to the least recently used.
+                With Clock true, a hit only sets the entry's referenced bit, and a hand sweeping over the entries evicts the first
+                unreferenced one, clearing the bits it passes.
+             */
+            template<typename K, typename V, typename H, typename A, bool Clock>
+            class BasicCache
+            {
+                struct Links
+                {
+                    uint prev;
+                    uint next;
+                };
+
+                struct NoLinks {};
+
+                struct Entry
+                {
+                    K key;
+                    V value;
+                    size_t cost;
+                    uint pins;
+                    bool referenced;
+                    [[no_unique_address]] std::conditional_t<Clock, NoLinks, Links> links;
+
+                    Entry(K key, V value, size_t cost) : key(std::move(key)), value(std::move(value)), cost(cost), pins(0), referenced(false) {}
+                };
+
+                using IndexAllocator = typename std::allocator_traits<A>::template rebind_alloc<Pair<K, uint>>;
+                using EntryAllocator = typename std::allocator_traits<A>::template rebind_alloc<Entry>;
+
+            public:
+                using KeyType = K;
+                using ValueType = V;
+                using Hasher = H;
+                using CostFn = std::function<size_t(const K&, const V&)>;
+
+                /*
+                    @brief Creates an empty cache that holds up to a number of entries.
+                    @param capacity The maximum number of entries.
+                    @param alloc The allocator to use.
+                 */
+                BasicCache(size_t capacity, const A& alloc = A()) : BasicCache(capacity, nullptr, alloc) {}
+
+                /*
+                    @brief Creates an empty cache bounded by the total cost of its entries, like their size in bytes.
+                    @param capacity The maximum total cost.
+                    @param cost A function taking a key and its value and returning the cost of the entry.
+                    Enter nullptr to count every entry as 1.
+                    @param alloc The allocator to use.
+                 */
+                BasicCache(size_t capacity, CostFn cost, const A& alloc = A()) : m_index(IndexAllocator(alloc)), m_entries(EntryAllocator(alloc)), m_costFn(std::move(cost))
+                {
+                    m_capacity = capacity;
+                    m_cost = 0;
+                    m_head = NONE;
+                    m_tail = NONE;
+                    m_hand = 0;
+                    resetStats();
+                }
+
+                /*
+                    @brief Gets the value of a key, and marks the entry as recently used.
+                    Counts as a hit if the key is found, and as a miss otherwise.
+                 *  The pointer is invalidated by adding or removing entries.
+                    Runtime complexity: O(1) expected
+                    @param key The key to search for.
+                    @return A pointer to the value, or nullptr if the key is not in the cache.
+                 */
+                V* get(const K& key)
+                {
+                    uint* index = m_index.find(key);
+                    if (index == nullptr)
+                    {
+                        m_misses++;
+                        return nullptr;
+                    }
+
+                    m_hits++;
+                    touch(*index);
+                    return &m_entries.data()[*index].value;
+                }
+
+                /*
+                    @brief Gets the value of a key, without marking the entry as used or counting a hit or miss.
+                 *  The pointer is invalidated by adding or removing entries.
+                    Runtime complexity: O(1) expected
+                    @param key The key to search for.
+                    @return A pointer to the value, or nullptr if the key is not in the cache.
+                 */
+                V* peek(const K& key)
+                {
+                    uint* index = m_index.find(key);
+                    return index == nullptr ? nullptr : &m_entries.data()[*index].value;
+                }
+
+                /*
+                    @brief Sets the value of a key, adding the entry if the key is not cached yet,
+                    and evicts entries until the total cost fits in the capacity again.
+                    Pinned entries are never evicted, so the cache can go over its capacity while they are pinned.
+                 *  An entry that costs more than the whole capacity is not cached, and the key's old value is removed.
+                    Runtime complexity: O(1) amortized expected
+                    @param key The key to set.
+                    @param value The value to set.
+                    @return True if the entry was cached, false if it is too large.
+                 */
+                bool put(K key, V value)
+                {
+                    return insert(std::move(key), std::move(value)) != NONE;
+                }
+
+
+                /*
+                    @brief Gets the value of a key, computing and adding it first if the key is not cached.
+                    Counts as a hit if the key is found, and as a miss otherwise.
+                 *  The reference is invalidated by adding or removing entries.
+                 !  Throws if the computed entry costs more than the whole capacity, as it cannot be cached.
+                    @param key The key to look up.
+                    @param compute A function taking the key and returning its value.
+                    @return A reference to the value of the key.
+                 */
+                template<typename F>
+                V& computeIfAbsent(const K& key, F compute)
+                {
+                    V* value = get(key);
+                    if (value != nullptr) return *value;
+
+                    uint index = insert(key, compute(key));
+                    if (index == NONE)
+                    {
+                        Sapphire::Err("DSA::Cache --> the computed entry is larger than the capacity of the cache");
+                        throw std::length_error("Sapphire: DSA::Cache --> the computed entry is larger than the capacity of the cache");
+                    }
+                    return m_entries.data()[index].value;
+                }
+
+                /*
+                    @brief Removes a key and its value from the cache, even if it is pinned.
+                    Runtime complexity: O(1) expected
+                    @param key The key to remove.
+                    @return True if the key was removed, false if it was not in the cache.
+                 */
+                bool erase(const K& key)
+                {
+                    uint* index = m_index.find(key);
+                    if (index == nullptr) return false;
+                    removeAt(*index);
+                    return true;
+                }
+
+                /*
+                    @brief Checks if a key is cached, without marking the entry as used or counting a hit or miss.
+                    @param key The key to search for.
+                    @return True if the key is found, false otherwise.
+                 */
+                bool contains(const K& key)
+                {
+                    return m_index.find(key) != nullptr;
+                }
+
+                /*
+                    @brief Pins an entry, so that it is not evicted until it is unpinned.
+                    Pins are counted, so an entry pinned twice must be unpinned twice.
+                    @param key The key of the entry.
+                    @return True if the entry was pinned, false if the key is not in the cache.
+                 */
+                bool pin(const K& key)
+                {
+                    uint* index = m_index.find(key);
+                    if (index == nullptr) return false;
+
+                    Entry& entry = m_entries.data()[*index];
+                    if (entry.pins++ == 0)
+                    {
+                        if constexpr (!Clock) unlink(*index);
+                    }
+                    return true;
+                }
+
+                /*
+                    @brief Unpins an entry pinned with pin(), and evicts entries if the cache went over its capacity while it was pinned.
+                    @param key The key of the entry.
+                    @return True if the entry was unpinned, false if the key is not in the cache or is not pinned.
+                 */
+                bool unpin(const K& key)
+                {
+                    uint* index = m_index.find(key);
+                    if (index == nullptr || m_entries.data()[*index].pins == 0) return false;
+
+                    Entry& entry = m_entries.data()[*index];
+                    if (--entry.pins == 0)
+                    {
+                        if constexpr (!Clock) linkFront(*index);
+                        else entry.referenced = true;
+                        evict(NONE);
+                    }
+                    return true;
+                }
+
+                /*
+                    @brief Changes the capacity, evicting entries if the cache is over the new capacity.
+                    @param capacity The maximum number of entries, or the maximum total cost if the cache has a cost function.
+                 */
+                void setCapacity(size_t capacity)
+                {
+                    m_capacity = capacity;
+                    evict(NONE);
+                }
+
+                /*
+                    @brief Removes every entry from the cache, including pinned ones.
+                    The statistics are kept.
+                 */
+                void clear()
+                {
+                    m_index.clear();
+                    m_entries.clear();
+                    m_cost = 0;
+                    m_head = NONE;
+                    m_tail = NONE;
+                    m_hand = 0;
+                }
+
+                /*
+                    @brief Returns the number of entries in the cache.
+                    @return The number of entries.
+                 */
+                uint size() const
+                {
+                    return m_entries.size();
+                }
+
+                /*
+                    @brief Returns the total cost of the entries in the cache.
+                    @return The total cost, the number of entries if the cache has no cost function.
+                 */
+                size_t getCost() const
+                {
+                    return m_cost;
+                }
+
+                /*
+                    @brief Returns the capacity of the cache.
+                    @return The maximum number of entries, or the maximum total cost if the cache has a cost function.
+                 */
+                size_t getCapacity() const
+                {
+                    return m_capacity;
+                }
+
+                /*
+                    @brief Returns the number of calls to get() and computeIfAbsent() that found their key since the last resetStats().
+                    @return The number of hits.
+                 */
+                ulonglong getHits() const
+                {
+                    return m_hits;
+                }
+
+                /*
+                    @brief Returns the number of calls to get() and computeIfAbsent() that did not find their key since the last resetStats().
+                    @return The number of misses.
+                 */
+                ulonglong getMisses() const
+                {
+                    return m_misses;
+                }
+
+                /*
+                    @brief Returns the number of entries evicted to make room since the last resetStats().
+                    Entries removed with erase() or clear() are not counted.
+                    @return The number of evictions.
+                 */
+                ulonglong getEvictions() const
+                {
+                    return m_evictions;
+                }
+
+                /*
+                    @brief Resets the hit, miss and eviction counters to 0.
+                 */
+                void resetStats()
+                {
+                    m_hits = 0;
+                    m_misses = 0;
+                    m_evictions = 0;
+                }
+
+            private:
+                static constexpr uint NONE = 0xFFFFFFFF;
+
+                HashMap<K, uint, H, IndexAllocator> m_index;
+                ArrayList<Entry, EntryAllocator> m_entries;
+                CostFn m_costFn;
+                size_t m_capacity;
+                size_t m_cost;
+                uint m_head;
+                uint m_tail;
+                uint m_hand;
+                ulonglong m_hits;
+                ulonglong m_misses;
+                ulonglong m_evictions;
+
+                // Sets the value of a key like put(), and returns the entry's index, or NONE if it is too large to cache.
+                uint insert(K key, V value)
+                {
+                    size_t cost = m_costFn ? m_costFn(key, value) : 1;
+                    uint* found = m_index.find(key);
+                    if (cost > m_capacity)
+                    {
+                        if (found != nullptr) removeAt(*found);
+                        return NONE;
+                    }
+
+                    uint index;
+                    if (found != nullptr)
+                    {
+                        index = *found;
+                        Entry& entry = m_entries.data()[index];
+                        entry.value = std::move(value);
+                        m_cost = m_cost - entry.cost + cost;
+                        entry.cost = cost;
+                        touch(index);
+                    }
+                    else
+                    {
+                        index = m_entries.size();
+                        m_entries.emplace(std::move(key), std::move(value), cost);
+                        try
+                        {
+                            m_index.set(m_entries.data()[index].key, index);
+                        }
+                        catch (...)
+                        {
+                            m_entries.removeRange((int)index, (int)index + 1);
+                            throw;
+                        }
+                        m_cost += cost;
+                        if constexpr (!Clock) linkFront(index);
+                    }
+
+                    return evict(index);
+                }
+
+                void touch(uint index)
+                {
+                    Entry& entry = m_entries.data()[index];
+                    if constexpr (Clock) entry.referenced = true;
+                    else if (entry.pins == 0 && m_head != index)
+                    {
+                        unlink(index);
+                        linkFront(index);
+                    }
+                }
+
+                void linkFront(uint index)
+                {
+                    Links& links = m_entries.data()[index].links;
+                    links.prev = NONE;
+                    links.next = m_head;
+                    if (m_head != NONE) m_entries.data()[m_head].links.prev = index;
+                    else m_tail = index;
+                    m_head = index;
+                }
+
+                void unlink(uint index)
+                {
+                    Links& links = m_entries.data()[index].links;
+                    if (links.prev != NONE) m_entries.data()[links.prev].links.next = links.next;
+                    else m_head = links.next;
+                    if (links.next != NONE) m_entries.data()[links.next].links.prev = links.prev;
+                    else m_tail = links.prev;
+                }
+
+                // Evicts until the cost fits, never evicting the entry at keep. Stops early if every other entry is pinned.
+                // Returns the index of the kept entry, which moves if it was the last entry when another one was removed.
+                uint evict(uint keep)
+                {
+                    if constexpr (Clock)
+                    {
+                        // Two sweeps clear every referenced bit, so a third would only find pinned entries.
+                        size_t steps = (size_t)m_entries.size() * 2;
+                        while (m_cost > m_capacity && steps-- > 0)
+                        {
+                            if (m_hand >= m_entries.size()) m_hand = 0;
+                            Entry& entry = m_entries.data()[m_hand];
+                            if (m_hand == keep || entry.pins > 0) m_hand++;
+                            else if (entry.referenced)
+                            {
+                                entry.referenced = false;
+                                m_hand++;
+                            }
+                            else
+                            {
+                                // The last entry moves into the hand's place, and is looked at next.
+                                if (keep == m_entries.size() - 1) keep = m_hand;
+                                removeAt(m_hand);
+                                m_evictions++;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        while (m_cost > m_capacity && m_tail != NONE && m_tail != keep)
+                        {
+                            if (keep == m_entries.size() - 1) keep = m_tail;
+                            removeAt(m_tail);
+                            m_evictions++;
+                        }
+                    }
+                    return keep;
+                }
+
+                void removeAt(uint index)
+                {
+                    Entry* entries = m_entries.data();
+                    m_index.erase(entries[index].key);
+                    m_cost -= entries[index].cost;
+                    if constexpr (!Clock)
+                    {
+                        if (entries[index].pins == 0) unlink(index);
+                    }
+
+                    uint last = m_entries.size() - 1;
+                    if (index != last)
+                    {
+                        entries[index] = std::move(entries[last]);
+                        *m_index.find(entries[index].key) = index;
+                        if constexpr (!Clock)
+                        {
+                            if (entries[index].pins == 0)
+                            {
+                                Links& links = entries[index].links;
+                                if (links.prev != NONE) entries[links.prev].links.next = index;
+                                else m_head = index;
+                                if (links.next != NONE) entries[links.next].links.prev = index;
+                                else m_tail = index;
+                            }
+                        }
+                    }
+                    m_entries.removeRange((int)last, (int)last + 1);
+                }
+            };
+        }
+
+        /*
+            @brief A cache that evicts the least recently used entries when it is full.
+            Entries are found through a HashMap and kept in a list from the most to the least recently used,
+            linked through indices into one dense array of entries, so get() and put() are O(1) and allocate nothing once the cache is warm.
+            The cache is bounded by its number of entries, or by the total of a cost function, like the size in bytes of each value,
+            which makes it fit for caching file contents and parsed documents of very different sizes.
+            Entries can be pinned so that they are never evicted while in use, and hits, misses and evictions are counted.
+         *  Every hit reorders the list, see ClockCache for a cheaper approximation, and ShardedCache to share a cache between threads.
+         *  Not thread-safe.
+            @param H The hash function object.
+            @param A The allocator to allocate the entries with, which is rebound for the index and the entries.
+         */
+        template<typename K, typename V, typename H = std::hash<K>, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class LruCache : public Detail::BasicCache<K, V, H, A, false>
+        {
+        public:
+            using Detail::BasicCache<K, V, H, A, false>::BasicCache;
+        };
+
+        /*
+            @brief A cache that approximates least recently used eviction with the CLOCK algorithm.
+            A hit only sets the entry's referenced bit instead of moving the entry to the front of a list,
+            and a hand sweeping over the entries evicts the first one that was not referenced since the hand last passed it.
+            This makes hits cheaper than in LruCache, and saves the two list links of each entry, at the cost of a less exact order.
+            Bounded by entry count or by a cost function, with pinning and hit, miss and eviction counters, like LruCache.
+         *  Not thread-safe, see ShardedCache to share a cache between threads.
+            @param H The hash function object.
+            @param A The allocator to allocate the entries with, which is rebound for the index and the entries.
+         */
+        template<typename K, typename V, typename H = std::hash<K>, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class ClockCache : public Detail::BasicCache<K, V, H, A, true>
+        {
+        public:
+            using Detail::BasicCache<K, V, H, A, true>::BasicCache;
+        };
+
+        /*
+            @brief A thread-safe cache made of independent shards, each an LruCache or ClockCache behind its own lock.
+            Keys are spread over the shards by hash, so threads working on different keys rarely wait for each other.
+            The capacity is split evenly over the shards, and each shard evicts on its own, so eviction is only least recently used within a shard.
+         *  Values are returned by copy, as another thread may evict an entry as soon as its shard is unlocked.
+            @param C The cache type of the shards, LruCache or ClockCache.
+         */
+        template<typename C>
+        class ShardedCache
+        {
+            using K = typename C::KeyType;
+            using V = typename C::ValueType;
+            using H = typename C::Hasher;
+
+        public:
+            using CostFn = typename C::CostFn;
+
+            /*
+                @brief Creates an empty sharded cache that holds up to a number of entries.
+                @param capacity The maximum number of entries, split evenly over the shards.
+                @param shardCount The number of shards, rounded up to a power of two.
+                Enter 0 to use four shards per hardware thread.
+                0 by default.
+             */
+            ShardedCache(size_t capacity, uint shardCount = 0) : ShardedCache(capacity, nullptr, shardCount) {}
+
+            /*
+                @brief Creates an empty sharded cache bounded by the total cost of its entries.
+                @param capacity The maximum total cost, split evenly over the shards.
+                @param cost A function taking a key and its value and returning the cost of the entry.
+                Enter nullptr to count every entry as 1.
+             !  The cost function is called from several threads at once.
+                @param shardCount The number of shards, rounded up to a power of two.
+                Enter 0 to use four shards per hardware thread.
+                0 by default.
+             */
+            ShardedCache(size_t capacity, CostFn cost, uint shardCount = 0)
+            {
+                if (shardCount == 0) shardCount = Max(std::thread::hardware_concurrency(), 1u) * 4;
+
+                m_shardBits = 0;
+                while ((1u << m_shardBits) < shardCount) m_shardBits++;
+                m_shardCount = 1u << m_shardBits;
+                size_t perShard = (capacity + m_shardCount - 1) / m_shardCount;
+                m_shards = (Shard*)::operator new(m_shardCount * sizeof(Shard), std::align_val_t(alignof(Shard)));
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    new (m_shards + i) Shard(perShard, cost);
+                }
+            }
+
+            ShardedCache(const ShardedCache<C>&) = delete;
+            ShardedCache<C>& operator=(const ShardedCache<C>&) = delete;
+
+            /*
+                @brief Destroys the sharded cache object and frees the memory.
+             !  Must not be called while other threads are still using the cache.
+             */
+            ~ShardedCache()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    m_shards[i].~Shard();
+                }
+                ::operator delete(m_shards, std::align_val_t(alignof(Shard)));
+            }
+
+            /*
+                @brief Gets a copy of the value of a key, and marks the entry as recently used.
+                @param key The key to search for.
+                @param out Set to the value of the key if it is found, left unchanged otherwise.
+                @return True if the key is found, false otherwise.
+             */
+            bool get(const K& key, V& out)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                V* value = shard.cache.get(key);
+                if (value == nullptr) return false;
+                out = *value;
+                return true;
+            }
+
+            /*
+                @brief Sets the value of a key, evicting entries of its shard if needed.
+                @param key The key to set.
+                @param value The value to set.
+                @return True if the entry was cached, false if it costs more than the capacity of a shard.
+             */
+            bool put(const K& key, const V& value)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.put(key, value);
+            }
+
+            /*
+                @brief Gets the value of a key, computing and adding it first if the key is not cached.
+                Other threads will never see two different values computed for the same key at the same time.
+             *  The compute function is called while the key's shard is locked, so it must not use this cache.
+             !  Throws if the computed entry costs more than the capacity of a shard.
+                @param key The key to look up.
+                @param compute A function taking the key and returning its value.
+                @return A copy of the value of the key.
+             */
+            template<typename F>
+            V computeIfAbsent(const K& key, F compute)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.computeIfAbsent(key, compute);
+            }
+
+            /*
+                @brief Removes a key and its value from the cache, even if it is pinned.
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the cache.
+             */
+            bool erase(const K& key)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.erase(key);
+            }
+
+            /*
+                @brief Checks if a key is cached, without marking the entry as used or counting a hit or miss.
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.contains(key);
+            }
+
+            /*
+                @brief Pins an entry, so that it is not evicted until it is unpinned.
+                @param key The key of the entry.
+                @return True if the entry was pinned, false if the key is not in the cache.
+             */
+            bool pin(const K& key)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.pin(key);
+            }
+
+            /*
+                @brief Unpins an entry pinned with pin().
+                @param key The key of the entry.
+                @return True if the entry was unpinned, false if the key is not in the cache or is not pinned.
+             */
+            bool unpin(const K& key)
+            {
+                Shard& shard = shardFor(key);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.cache.unpin(key);
+            }
+
+            /*
+                @brief Removes every entry from the cache, one shard at a time.
+             *  Entries added by other threads while clearing may survive.
+             */
+            void clear()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+                    m_shards[i].cache.clear();
+                }
+            }
+
+            /*
+                @brief Returns the number of entries in the cache.
+             *  Shards are counted one at a time, so the result is only exact if no other thread is writing.
+                @return The number of entries.
+             */
+            size_t size() const
+            {
+                return sum([](const C& cache) { return (ulonglong)cache.size(); });
+            }
+
+            /*
+                @brief Returns the total cost of the entries in the cache.
+                @return The total cost, the number of entries if the cache has no cost function.
+             */
+            size_t getCost() const
+            {
+                return sum([](const C& cache) { return (ulonglong)cache.getCost(); });
+            }
+
+            /*
+                @brief Returns the number of hits of every shard since the last resetStats().
+                @return The number of hits.
+             */
+            ulonglong getHits() const
+            {
+                return sum([](const C& cache) { return cache.getHits(); });
+            }
+
+            /*
+                @brief Returns the number of misses of every shard since the last resetStats().
+                @return The number of misses.
+             */
+            ulonglong getMisses() const
+            {
+                return sum([](const C& cache) { return cache.getMisses(); });
+            }
+
+            /*
+                @brief Returns the number of evictions of every shard since the last resetStats().
+                @return The number of evictions.
+             */
+            ulonglong getEvictions() const
+            {
+                return sum([](const C& cache) { return cache.getEvictions(); });
+            }
+
+            /*
+                @brief Resets the hit, miss and eviction counters of every shard to 0.
+             */
+            void resetStats()
+            {
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+                    m_shards[i].cache.resetStats();
+                }
+            }
+
+            /*
+                @brief Returns the number of shards.
+                @return The number of shards, always a power of two.
+             */
+            uint shardCount() const
+            {
+                return m_shardCount;
+            }
+
+        private:
+            struct alignas(64) Shard
+            {
+                std::mutex mutex;
+                C cache;
+
+                Shard(size_t capacity, const CostFn& cost) : cache(capacity, cost) {}
+            };
+
+            Shard* m_shards;
+            uint m_shardCount;
+            uint m_shardBits;
+
+            Shard& shardFor(const K& key) const
+            {
+                return m_shards[Detail::ShardIndex((ulonglong)H{}(key), m_shardBits)];
+            }
+
+            template<typename F>
+            ulonglong sum(F get) const
+            {
+                ulonglong total = 0;
+                for (uint i = 0; i < m_shardCount; i++)
+                {
+                    std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+                    total += get(m_shards[i].cache);
+                }
+                return total;
+            }
+        };
+
+        /*
+            @brief A class to represent an ordered map, known as std::map in C++ and a TreeMap in Java.
+            The entries are kept sorted by key in a B+ tree of wide nodes: each node packs its keys into one contiguous array,
+            which is searched with a branchless count (vectorized by the compiler for arithmetic keys) instead of chasing a pointer per comparison.
+            The values live in the leaves only, and the leaves are linked in order, so iterating and range queries walk arrays.
+            Compared to a red-black tree like std::map, a lookup touches a handful of nodes instead of dozens,
+            and there are no per-entry allocations or pointers, so the map takes a fraction of the memory.
+         !  Keys are ordered with operator<.
+         *  Adding or erasing entries invalidates iterators and pointers returned by find().
+            @param A The allocator to allocate the entries with, which is rebound for the nodes.
+         */
+        template<typename K, typename V, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class BTreeMap
+        {
+            // Node capacities are picked so each node is about Detail::BTREE_NODE_BYTES.
+            static constexpr uint NodeCapacity(size_t entryBytes)
+            {
+                size_t cap = Detail::BTREE_NODE_BYTES / entryBytes;
+                return cap < 8 ? 8 : cap > 255 ? 255 : (uint)cap;
+            }
+
+            static constexpr uint LEAF_CAP = NodeCapacity(sizeof(K) + sizeof(V));
+            static constexpr uint LEAF_MIN = LEAF_CAP / 2;
+            static constexpr uint INNER_CAP = NodeCapacity(sizeof(K) + sizeof(void*));
+            static constexpr uint INNER_MIN = (INNER_CAP - 1) / 2;
+
+            // Entries are constructed in place in raw storage, only the first count of each array are alive.
+            struct Node
+            {
+                uint count;
+                bool leaf;
+            };
+
+            struct Leaf : Node
+            {
+                Leaf* next;
+                alignas(K) unsigned char keys[LEAF_CAP * sizeof(K)];
+                alignas(V) unsigned char values[LEAF_CAP * sizeof(V)];
+
+                K* keyData() { return (K*)keys; }
+                V* valueData() { return (V*)values; }
+            };
+
+            struct Inner : Node
+            {
+                alignas(K) unsigned char keys[INNER_CAP * sizeof(K)];
+                Node* children[INNER_CAP + 1];
+
+                K* keyData() { return (K*)keys; }
+            };
+
+            using LeafAllocator = typename std::allocator_traits<A>::template rebind_alloc<Leaf>;
+            using InnerAllocator = typename std::allocator_traits<A>::template rebind_alloc<Inner>;
+
+        public:
+            /*
+                @brief Creates an empty B-tree map.
+                Does not allocate until the first entry is added.
+                @param alloc The allocator to use.
+             */
+            BTreeMap(const A& alloc = A()) : m_leafAlloc(alloc), m_innerAlloc(alloc)
+            {
+                m_root = nullptr;
+                m_first = nullptr;
+                m_size = 0;
+                m_height = 0;
+            }
+
+            /*
+                @brief Creates a B-tree map from sorted keys and their values, building the tree bottom-up.
+                The leaves are filled completely, so the map is as compact as it can be.
+             !  Throws std::invalid_argument if the keys are not sorted in strictly ascending order.
+                Runtime complexity: O(n)
+                @param keys The sorted keys.
+                @param values The value of each key.
+                @param size The number of entries.
+                @param alloc The allocator to use.
+             */
+            BTreeMap(const K* keys, const V* values, uint size, const A& alloc = A()) : BTreeMap(alloc)
+            {
+                for (uint i = 1; i < size; i++)
+                {
+                    if (!(keys[i - 1] < keys[i]))
+                    {
+                        Sapphire::Err("DSA::BTreeMap --> the keys to build from are not sorted and unique (at index " + std::to_string(i) + ")");
+                        throw std::invalid_argument("Sapphire: DSA::BTreeMap --> the keys to build from are not sorted and unique (at index " + std::to_string(i) + ")");
+                    }
+                }
+
+                uint next = 0;
+                build(size, [&](Leaf* leaf, uint count)
+                {
+                    for (; leaf->count < count; leaf->count++, next++)
+                    {
+                        new (leaf->keyData() + leaf->count) K(keys[next]);
+                        new (leaf->valueData() + leaf->count) V(values[next]);
+                    }
+                });
+            }
+
+            /*
+                @brief Creates a B-tree map from a given initializer list of pairs.
+             *  If a key appears more than once, the last value wins.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            BTreeMap(std::initializer_list<Pair<K, V>> list, const A& alloc = A()) : BTreeMap(alloc)
+            {
+                for (const Pair<K, V>& pair : list)
+                {
+                    set(pair.first, pair.second);
+                }
+            }
+
+            /*
+                @brief Creates a B-tree map from a given B-tree map object.
+                The copy is bulk-loaded, so its leaves are full.
+                @param other The B-tree map to copy.
+             */
+            BTreeMap(const BTreeMap<K, V, A>& other) : BTreeMap(std::allocator_traits<A>::select_on_container_copy_construction(other.getAllocator()))
+            {
+                copyFrom(other);
+            }
+
+            /*
+                @brief Creates a B-tree map by taking the contents of another B-tree map.
+                The other B-tree map is left empty.
+                @param other The B-tree map to move from.
+             */
+            BTreeMap(BTreeMap<K, V, A>&& other) noexcept : BTreeMap(other.getAllocator())
+            {
+                swap(other);
+            }
+
+            /*
+                @brief Destroys the B-tree map object and frees the memory.
+             */
+            ~BTreeMap()
+            {
+                clear();
+            }
+
+            V& operator[](const K& key)
+            {
+                V* value = find(key);
+                if (value == nullptr)
+                {
+                    Sapphire::Err("DSA::BTreeMap --> key " + Detail::KeyToString(key) + " not found");
+                    throw std::runtime_error("Sapphire: DSA::BTreeMap --> key " + Detail::KeyToString(key) + " not found");
+                }
+                return *value;
+            }
+
+            BTreeMap<K, V, A>& operator=(const BTreeMap<K, V, A>& other)
+            {
+                if (this != &other) copyFrom(other);
+                return *this;
+            }
+
+            BTreeMap<K, V, A>& operator=(BTreeMap<K, V, A>&& other) noexcept(std::allocator_traits<A>::is_always_equal::value)
+            {
+                if (this == &other) return *this;
+                if (m_leafAlloc == other.m_leafAlloc && m_innerAlloc == other.m_innerAlloc)
+                {
+                    swap(other);
+                    other.clear();
+                }
+                else copyFrom(other);
+                return *this;
+            }
+
+            friend bool operator==(const BTreeMap<K, V, A>& map1, const BTreeMap<K, V, A>& map2)
+            {
+                if (map1.m_size != map2.m_size) return false;
+                ConstIterator it1 = map1.begin(), it2 = map2.begin();
+                for (; it1 != map1.end(); ++it1, ++it2)
+                {
+                    if (it1.key() < it2.key() || it2.key() < it1.key() || !(it1.value() == it2.value())) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const BTreeMap<K, V, A>& map1, const BTreeMap<K, V, A>& map2)
+            {
+                return !(map1 == map2);
+            }
+
+            /*
+                @brief Sets the value of a key, adding the key if it is not in the B-tree map yet.
+                Full nodes are split on the way down, so the insertion never has to walk back up.
+                Runtime complexity: O(log n)
+                @param key The key to set.
+                @param value The value to set.
+             */
+            void set(K key, V value)
+            {
+                if (m_root == nullptr)
+                {
+                    m_root = m_first = newLeaf();
+                    m_height = 1;
+                }
+                if (isFull(m_root))
+                {
+                    Inner* root = newInner();
+                    root->children[0] = m_root;
+                    m_root = root;
+                    m_height++;
+                    splitChild(root, 0);
+                }
+
+                Node* node = m_root;
+                while (!node->leaf)
+                {
+                    Inner* inner = (Inner*)node;
+                    uint i = CountBelow<true>(inner->keyData(), inner->count, key);
+                    if (isFull(inner->children[i]))
+                    {
+                        splitChild(inner, i);
+                        if (!(key < inner->keyData()[i])) i++;
+                    }
+                    node = inner->children[i];
+                }
+
+                Leaf* leaf = (Leaf*)node;
+                uint i = CountBelow<false>(leaf->keyData(), leaf->count, key);
+                if (i < leaf->count && !(key < leaf->keyData()[i]))
+                {
+                    leaf->valueData()[i] = std::move(value);
+                    return;
+                }
+
+                Relocate(leaf->keyData() + i + 1, leaf->keyData() + i, leaf->count - i);
+                Relocate(leaf->valueData() + i + 1, leaf->valueData() + i, leaf->count - i);
+                new (leaf->keyData() + i) K(std::move(key));
+                new (leaf->valueData() + i) V(std::move(value));
+                leaf->count++;
+                m_size++;
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the B-tree map.
+             */
+            V* find(const K& key)
+            {
+                return lookup(key);
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the B-tree map.
+             */
+            const V* find(const K& key) const
+            {
+                return lookup(key);
+            }
+
+            /*
+                @brief Checks if the B-tree map contains a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key) const
+            {
+                return find(key) != nullptr;
+            }
+
+            /*
+                @brief Removes a key and its value from the B-tree map.
+                Nodes left less than half full borrow from a sibling or merge with it, so the tree stays balanced.
+                Runtime complexity: O(log n)
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the B-tree map.
+             */
+            bool erase(const K& key)
+            {
+                if (m_root == nullptr || !eraseFrom(m_root, key)) return false;
+                m_size--;
+
+                if (m_root->count == 0)
+                {
+                    Node* root = m_root;
+                    if (root->leaf)
+                    {
+                        m_root = m_first = nullptr;
+                        m_height = 0;
+                        freeLeaf((Leaf*)root);
+                    }
+                    else
+                    {
+                        m_root = ((Inner*)root)->children[0];
+                        m_height--;
+                        freeInner((Inner*)root);
+                    }
+                }
+                return true;
+            }
+
+            /*
+                @brief Removes all entries from the B-tree map and frees its nodes.
+             */
+            void clear()
+            {
+                if (m_root != nullptr) freeNode(m_root);
+                m_root = nullptr;
+                m_first = nullptr;
+                m_size = 0;
+                m_height = 0;
+            }
+
+            /*
+                @brief Returns the number of entries in the B-tree map.
+                @return The size of the B-tree map.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the number of levels of the tree.
+                @return The height of the tree, 0 if the B-tree map is empty.
+             */
+            uint height() const
+            {
+                return m_height;
+            }
+
+            /*
+                @brief Returns a copy of the allocator the B-tree map uses.
+                @return The allocator.
+             */
+            A getAllocator() const
+            {
+                return A(m_leafAlloc);
+            }
+
+            template<bool Const>
+            class BasicIterator
+            {
+                using LeafPointer = std::conditional_t<Const, const Leaf*, Leaf*>;
+                using ValueRef = std::conditional_t<Const, const V&, V&>;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = Pair<const K&, ValueRef>;
+                using pointer = void;
+                using reference = Pair<const K&, ValueRef>;
+
+                BasicIterator(LeafPointer leaf, uint index) : m_leaf(leaf), m_index(index) {}
+
+                /*
+                    @brief Returns the key of the current entry.
+                    @return A reference to the key.
+                 */
+                const K& key() const
+                {
+                    return ((const K*)m_leaf->keys)[m_index];
+                }
+
+                /*
+                    @brief Returns the value of the current entry.
+                    @return A reference to the value.
+                 */
+                ValueRef value() const
+                {
+                    return ((std::conditional_t<Const, const V*, V*>)m_leaf->values)[m_index];
+                }
+
+                reference operator*() const
+                {
+                    return reference(key(), value());
+                }
+
+                BasicIterator& operator++()
+                {
+                    if (++m_index == m_leaf->count)
+                    {
+                        m_leaf = m_leaf->next;
+                        m_index = 0;
+                    }
+                    return *this;
+                }
+
+                BasicIterator operator++(int)
+                {
+                    BasicIterator tmp = *this; ++(*this); return tmp;
+                }
+
+                friend bool operator==(const BasicIterator& it1, const BasicIterator& it2)
+                {
+                    return it1.m_leaf == it2.m_leaf && it1.m_index == it2.m_index;
+                }
+
+                friend bool operator!=(const BasicIterator& it1, const BasicIterator& it2)
+                {
+                    return !(it1 == it2);
+                }
+
+            private:
+                LeafPointer m_leaf;
+                uint m_index;
+            };
+
+            using Iterator = BasicIterator<false>;
+            using ConstIterator = BasicIterator<true>;
+
+            Iterator begin()
+            {
+                return Iterator(m_first, 0);
+            }
+
+            Iterator end()
+            {
+                return Iterator(nullptr, 0);
+            }
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(m_first, 0);
+            }
+
+            ConstIterator end() const
+            {
+                return ConstIterator(nullptr, 0);
+            }
+
+            /*
+                @brief Finds the first entry whose key is not less than a given key.
+                Iterate from it up to upperBound() of another key to visit a range of keys in order.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return An iterator to the entry, or end() if every key is less than the given key.
+             */
+            Iterator lowerBound(const K& key)
+            {
+                return bound<false, Iterator>(key);
+            }
+
+            /*
+                @brief Finds the first entry whose key is not less than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return An iterator to the entry, or end() if every key is less than the given key.
+             */
+            ConstIterator lowerBound(const K& key) const
+            {
+                return bound<false, ConstIterator>(key);
+            }
+
+            /*
+                @brief Finds the first entry whose key is greater than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return An iterator to the entry, or end() if no key is greater than the given key.
+             */
+            Iterator upperBound(const K& key)
+            {
+                return bound<true, Iterator>(key);
+            }
+
+            /*
+                @brief Finds the first entry whose key is greater than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return An iterator to the entry, or end() if no key is greater than the given key.
+             */
+            ConstIterator upperBound(const K& key) const
+            {
+                return bound<true, ConstIterator>(key);
+            }
+
+        private:
+            Node* m_root;
+            Leaf* m_first;
+            uint m_size;
+            uint m_height;
+
+            [[no_unique_address]] LeafAllocator m_leafAlloc;
+            [[no_unique_address]] InnerAllocator m_innerAlloc;
+
+            // Counts the keys of a node that are less than key, or not greater than key when Upper.
+            // Arithmetic keys are counted without branches over the whole node, which the compiler vectorizes;
+            // other keys may be expensive to compare, so they are binary searched.
+            template<bool Upper>
+            static uint CountBelow(const K* keys, uint count, const K& key)
+            {
+                if constexpr (std::is_arithmetic_v<K>)
+                {
+                    uint below = 0;
+                    for (uint j = 0; j < count; j++)
+                    {
+                        if constexpr (Upper) below += !(key < keys[j]);
+                        else below += keys[j] < key;
+                    }
+                    return below;
+                }
+                else
+                {
+                    uint low = 0, high = count;
+                    while (low < high)
+                    {
+                        uint mid = (low + high) / 2;
+                        if (Upper ? !(key < keys[mid]) : keys[mid] < key) low = mid + 1;
+                        else high = mid;
+                    }
+                    return low;
+                }
+            }
+
+            // Moves n constructed elements to possibly overlapping uninitialized storage, leaving the source uninitialized.
+            template<typename T>
+            static void Relocate(T* dst, T* src, uint n)
+            {
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    if (n != 0) std::memmove((void*)dst, (const void*)src, n * sizeof(T));
+                }
+                else if (dst < src)
+                {
+                    for (uint i = 0; i < n; i++)
+                    {
+                        new (dst + i) T(std::move(src[i]));
+                        src[i].~T();
+                    }
+                }
+                else
+                {
+                    for (uint i = n; i > 0; i--)
+                    {
+                        new (dst + i - 1) T(std::move(src[i - 1]));
+                        src[i - 1].~T();
+                    }
+                }
+            }
+
+            template<typename T>
+            static void DestroyRange(T* arr, uint count)
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                {
+                    for (uint i = 0; i < count; i++)
+                    {
+                        arr[i].~T();
+                    }
+                }
+            }
+
+            static bool isFull(const Node* node)
+            {
+                return node->count == (node->leaf ? LEAF_CAP : INNER_CAP);
+            }
+
+            Leaf* newLeaf()
+            {
+                Leaf* leaf = std::allocator_traits<LeafAllocator>::allocate(m_leafAlloc, 1);
+                leaf->count = 0;
+                leaf->leaf = true;
+                leaf->next = nullptr;
+                return leaf;
+            }
+
+            Inner* newInner()
+            {
+                Inner* inner = std::allocator_traits<InnerAllocator>::allocate(m_innerAlloc, 1);
+                inner->count = 0;
+                inner->leaf = false;
+                return inner;
+            }
+
+            void freeLeaf(Leaf* leaf)
+            {
+                DestroyRange(leaf->keyData(), leaf->count);
+                DestroyRange(leaf->valueData(), leaf->count);
+                std::allocator_traits<LeafAllocator>::deallocate(m_leafAlloc, leaf, 1);
+            }
+
+            void freeInner(Inner* inner)
+            {
+                DestroyRange(inner->keyData(), inner->count);
+                std::allocator_traits<InnerAllocator>::deallocate(m_innerAlloc, inner, 1);
+            }
+
+            void freeNode(Node* node)
+            {
+                if (node->leaf)
+                {
+                    freeLeaf((Leaf*)node);
+                    return;
+                }
+
+                Inner* inner = (Inner*)node;
+                for (uint i = 0; i <= inner->count; i++)
+                {
+                    freeNode(inner->children[i]);
+                }
+                freeInner(inner);
+            }
+
+            Leaf* leafFor(const K& key) const
+            {
+                Node* node = m_root;
+                while (!node->leaf)
+                {
+                    Inner* inner = (Inner*)node;
+                    node = inner->children[CountBelow<true>(inner->keyData(), inner->count, key)];
+                }
+                return (Leaf*)node;
+            }
+
+            V* lookup(const K& key) const
+            {
+                if (m_root == nullptr) return nullptr;
+                Leaf* leaf = leafFor(key);
+                uint i = CountBelow<false>(leaf->keyData(), leaf->count, key);
+                return i < leaf->count && !(key < leaf->keyData()[i]) ? leaf->valueData() + i : nullptr;
+            }
+
+            template<bool Upper, typename It>
+            It bound(const K& key) const
+            {
+                if (m_root == nullptr) return It(nullptr, 0);
+                Leaf* leaf = leafFor(key);
+                uint i = CountBelow<Upper>(leaf->keyData(), leaf->count, key);
+                if (i < leaf->count) return It(leaf, i);
+                return It(leaf->next, 0);
+            }
+
+            // Inserts a separator and the child to its right at a given position of an inner node that is not full.
+            static void insertChild(Inner* parent, uint i, K& separator, Node* child)
+            {
+                Relocate(parent->keyData() + i + 1, parent->keyData() + i, parent->count - i);
+                Relocate(parent->children + i + 2, parent->children + i + 1, parent->count - i);
+                new (parent->keyData() + i) K(std::move(separator));
+                parent->children[i + 1] = child;
+                parent->count++;
+            }
+
+            // Removes the separator at a given position of an inner node and the child to its right.
+            static void removeChild(Inner* parent, uint i)
+            {
+                parent->keyData()[i].~K();
+                Relocate(parent->keyData() + i, parent->keyData() + i + 1, parent->count - i - 1);
+                Relocate(parent->children + i + 1, parent->children + i + 2, parent->count - i - 1);
+                parent->count--;
+            }
+
+            // Splits the full child at a given position of an inner node that is not full into two halves.
+            void splitChild(Inner* parent, uint i)
+            {
+                Node* child = parent->children[i];
+                if (child->leaf)
+                {
+                    Leaf* left = (Leaf*)child;
+                    K separator(left->keyData()[LEAF_MIN]);
+                    Leaf* right = newLeaf();
+                    Relocate(right->keyData(), left->keyData() + LEAF_MIN, LEAF_CAP - LEAF_MIN);
+                    Relocate(right->valueData(), left->valueData() + LEAF_MIN, LEAF_CAP - LEAF_MIN);
+                    right->count = LEAF_CAP - LEAF_MIN;
+                    left->count = LEAF_MIN;
+                    right->next = left->next;
+                    left->next = right;
+                    insertChild(parent, i, separator, right);
+                }
+                else
+                {
+                    // The middle key moves up, the keys after it and their children go to the new node.
+                    Inner* left = (Inner*)child;
+                    uint mid = INNER_CAP / 2;
+                    Inner* right = newInner();
+                    Relocate(right->keyData(), left->keyData() + mid + 1, INNER_CAP - mid - 1);
+                    Relocate(right->children, left->children + mid + 1, INNER_CAP - mid);
+                    right->count = INNER_CAP - mid - 1;
+                    K separator(std::move(left->keyData()[mid]));
+                    left->keyData()[mid].~K();
+                    left->count = mid;
+                    insertChild(parent, i, separator, right);
+                }
+            }
+
+            bool eraseFrom(Node* node, const K& key)
+            {
+                if (node->leaf)
+                {
+                    Leaf* leaf = (Leaf*)node;
+                    uint i = CountBelow<false>(leaf->keyData(), leaf->count, key);
+                    if (i == leaf->count || key < leaf->keyData()[i]) return false;
+
+                    leaf->keyData()[i].~K();
+                    leaf->valueData()[i].~V();
+                    Relocate(leaf->keyData() + i, leaf->keyData() + i + 1, leaf->count - i - 1);
+                    Relocate(leaf->valueData() + i, leaf->valueData() + i + 1, leaf->count - i - 1);
+                    leaf->count--;
+                    return true;
+                }
+
+                // Separators are left as they are when the smallest key of a subtree is erased, they only need to stay between the subtrees.
+                Inner* inner = (Inner*)node;
+                uint i = CountBelow<true>(inner->keyData(), inner->count, key);
+                if (!eraseFrom(inner->children[i], key)) return false;
+
+                Node* child = inner->children[i];
+                if (child->count < (child->leaf ? LEAF_MIN : INNER_MIN)) rebalance(inner, i);
+                return true;
+            }
+
+            // Refills the child at a given position, which has one entry less than the minimum, from a sibling.
+            void rebalance(Inner* parent, uint i)
+            {
+                Node* child = parent->children[i];
+                uint min = child->leaf ? LEAF_MIN : INNER_MIN;
+                if (i > 0 && parent->children[i - 1]->count > min) borrowFromLeft(parent, i);
+                else if (i < parent->count && parent->children[i + 1]->count > min) borrowFromRight(parent, i);
+                else if (i > 0) merge(parent, i - 1);
+                else merge(parent, i);
+            }
+
+            void borrowFromLeft(Inner* parent, uint i)
+            {
+                K* separator = parent->keyData() + i - 1;
+                if (parent->children[i]->leaf)
+                {
+                    Leaf* left = (Leaf*)parent->children[i - 1];
+                    Leaf* child = (Leaf*)parent->children[i];
+                    Relocate(child->keyData() + 1, child->keyData(), child->count);
+                    Relocate(child->valueData() + 1, child->valueData(), child->count);
+                    left->count--;
+                    Relocate(child->keyData(), left->keyData() + left->count, 1);
+                    Relocate(child->valueData(), left->valueData() + left->count, 1);
+                    child->count++;
+                    *separator = child->keyData()[0];
+                }
+                else
+                {
+                    Inner* left = (Inner*)parent->children[i - 1];
+                    Inner* child = (Inner*)parent->children[i];
+                    Relocate(child->keyData() + 1, child->keyData(), child->count);
+                    Relocate(child->children + 1, child->children, child->count + 1);
+                    new (child->keyData()) K(std::move(*separator));
+                    child->children[0] = left->children[left->count];
+                    child->count++;
+                    left->count--;
+                    *separator = std::move(left->keyData()[left->count]);
+                    left->keyData()[left->count].~K();
+                }
+            }
+
+            void borrowFromRight(Inner* parent, uint i)
+            {
+                K* separator = parent->keyData() + i;
+                if (parent->children[i]->leaf)
+                {
+                    Leaf* child = (Leaf*)parent->children[i];
+                    Leaf* right = (Leaf*)parent->children[i + 1];
+                    Relocate(child->keyData() + child->count, right->keyData(), 1);
+                    Relocate(child->valueData() + child->count, right->valueData(), 1);
+                    child->count++;
+                    right->count--;
+                    Relocate(right->keyData(), right->keyData() + 1, right->count);
+                    Relocate(right->valueData(), right->valueData() + 1, right->count);
+                    *separator = right->keyData()[0];
+                }
+                else
+                {
+                    Inner* child = (Inner*)parent->children[i];
+                    Inner* right = (Inner*)parent->children[i + 1];
+                    new (child->keyData() + child->count) K(std::move(*separator));
+                    child->children[child->count + 1] = right->children[0];
+                    child->count++;
+                    *separator = std::move(right->keyData()[0]);
+                    right->keyData()[0].~K();
+                    right->count--;
+                    Relocate(right->keyData(), right->keyData() + 1, right->count);
+                    Relocate(right->children, right->children + 1, right->count + 1);
+                }
+            }
+
+            // Merges the children at positions i and i + 1 into the first one, taking the separator between them out of the parent.
+            void merge(Inner* parent, uint i)
+            {
+                if (parent->children[i]->leaf)
+                {
+                    Leaf* left = (Leaf*)parent->children[i];
+                    Leaf* right = (Leaf*)parent->children[i + 1];
+                    Relocate(left->keyData() + left->count, right->keyData(), right->count);
+                    Relocate(left->valueData() + left->count, right->valueData(), right->count);
+                    left->count += right->count;
+                    right->count = 0;
+                    left->next = right->next;
+                    freeLeaf(right);
+                }
+                else
+                {
+                    Inner* left = (Inner*)parent->children[i];
+                    Inner* right = (Inner*)parent->children[i + 1];
+                    new (left->keyData() + left->count) K(std::move(parent->keyData()[i]));
+                    Relocate(left->keyData() + left->count + 1, right->keyData(), right->count);
+                    Relocate(left->children + left->count + 1, right->children, right->count + 1);
+                    left->count += right->count + 1;
+                    right->count = 0;
+                    freeInner(right);
+                }
+                removeChild(parent, i);
+            }
+
+            /*
+                @brief Builds the tree bottom-up from entries in ascending key order, replacing the current contents.
+                Every level is split into as few nodes as possible with the entries spread evenly, so no node is below its minimum.
+                @param size The number of entries.
+                @param fill A function taking an empty leaf and a count, which constructs the next count entries in it, counting them in the leaf.
+             */
+            template<typename Fill>
+            void build(uint size, Fill fill)
+            {
+                clear();
+                if (size == 0) return;
+
+                // The nodes of the level being built and of the level above it, with a pointer to the smallest key of each subtree.
+                // A node is taken out of its level once it has a parent, so if anything throws, every node is freed exactly once.
+                ArrayList<Node*> level, parents;
+                ArrayList<const K*> smallest, parentSmallest;
+                try
+                {
+                    uint leaves = (size + LEAF_CAP - 1) / LEAF_CAP;
+                    level.reserve(leaves);
+                    smallest.reserve(leaves);
+                    Leaf* previous = nullptr;
+                    for (uint l = 0; l < leaves; l++)
+                    {
+                        Leaf* leaf = newLeaf();
+                        level.add(leaf);
+                        smallest.add(leaf->keyData());
+                        if (previous == nullptr) m_first = leaf;
+                        else previous->next = leaf;
+                        previous = leaf;
+
+                        fill(leaf, (uint)((ulonglong)size * (l + 1) / leaves - (ulonglong)size * l / leaves));
+                        m_size += leaf->count;
+                    }
+                    m_height = 1;
+
+                    while (level.size() > 1)
+                    {
+                        uint count = level.size();
+                        uint nodes = (count + INNER_CAP) / (INNER_CAP + 1);
+                        parents.reserve(nodes);
+                        parentSmallest.reserve(nodes);
+                        for (uint p = 0; p < nodes; p++)
+                        {
+                            uint first = (uint)((ulonglong)count * p / nodes);
+                            uint last = (uint)((ulonglong)count * (p + 1) / nodes);
+                            Inner* inner = newInner();
+                            parents.add(inner);
+                            parentSmallest.add(smallest[first]);
+
+                            inner->children[0] = level[first];
+                            level[first] = nullptr;
+                            for (uint c = first + 1; c < last; c++)
+                            {
+                                new (inner->keyData() + inner->count) K(*smallest[c]);
+                                inner->children[inner->count + 1] = level[c];
+                                level[c] = nullptr;
+                                inner->count++;
+                            }
+                        }
+                        std::swap(level, parents);
+                        std::swap(smallest, parentSmallest);
+                        parents.clear();
+                        parentSmallest.clear();
+                        m_height++;
+                    }
+                    m_root = level[0];
+                }
+                catch (...)
+                {
+                    for (uint i = 0; i < level.size(); i++)
+                    {
+                        if (level[i] != nullptr) freeNode(level[i]);
+                    }
+                    for (uint i = 0; i < parents.size(); i++)
+                    {
+                        freeNode(parents[i]);
+                    }
+                    m_root = nullptr;
+                    m_first = nullptr;
+                    m_size = 0;
+                    m_height = 0;
+                    throw;
+                }
+            }
+
+            void copyFrom(const BTreeMap<K, V, A>& other)
+            {
+                ConstIterator it = other.begin();
+                build(other.m_size, [&](Leaf* leaf, uint count)
+                {
+                    for (; leaf->count < count; leaf->count++, ++it)
+                    {
+                        new (leaf->keyData() + leaf->count) K(it.key());
+                        new (leaf->valueData() + leaf->count) V(it.value());
+                    }
+                });
+            }
+
+            void swap(BTreeMap<K, V, A>& other)
+            {
+                std::swap(m_root, other.m_root);
+                std::swap(m_first, other.m_first);
+                std::swap(m_size, other.m_size);
+                std::swap(m_height, other.m_height);
+            }
+        };
+
+        /*
+            @brief A class to represent a sorted map stored in two flat arrays, known as boost::container::flat_map in C++.
+            The keys and the values are kept in separate sorted ArrayLists, so a lookup is a branchless binary search
+            over a dense array of keys, iterating walks two arrays, and there is no per-entry overhead at all.
+            Ideal for read-mostly maps like configs and lookup tables: build them in one go with buildFrom(),
+            and apply batched updates with mergeInsert(), which costs one pass instead of one shift per key.
+         !  Keys are ordered with operator<.
+         *  Adding a single key with set() shifts the following entries, O(n), so prefer the batched functions for many keys.
+         *  Adding or erasing entries invalidates iterators and pointers returned by find().
+            @param A The allocator to allocate the entries with, which is rebound for the keys and the values.
+         */
+        template<typename K, typename V, typename A = Memory::HeapAllocator<Pair<K, V>>>
+        class FlatMap
+        {
+            using KeyAllocator = typename std::allocator_traits<A>::template rebind_alloc<K>;
+            using ValueAllocator = typename std::allocator_traits<A>::template rebind_alloc<V>;
+
+        public:
+            /*
+                @brief Creates an empty flat map.
+                @param alloc The allocator to use.
+             */
+            FlatMap(const A& alloc = A()) : m_keys(KeyAllocator(alloc)), m_values(ValueAllocator(alloc)) {}
+
+            /*
+                @brief Creates a flat map from a given initializer list of pairs.
+             *  If a key appears more than once, the last value wins.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            FlatMap(std::initializer_list<Pair<K, V>> list, const A& alloc = A()) : FlatMap(alloc)
+            {
+                buildFrom(list.begin(), (uint)list.size());
+            }
+
+            V& operator[](const K& key)
+            {
+                V* value = find(key);
+                if (value == nullptr)
+                {
+                    Sapphire::Err("DSA::FlatMap --> key " + Detail::KeyToString(key) + " not found");
+                    throw std::runtime_error("Sapphire: DSA::FlatMap --> key " + Detail::KeyToString(key) + " not found");
+                }
+                return *value;
+            }
+
+            friend bool operator==(const FlatMap<K, V, A>& map1, const FlatMap<K, V, A>& map2)
+            {
+                if (map1.size() != map2.size()) return false;
+                for (uint i = 0; i < map1.size(); i++)
+                {
+                    const K& key1 = map1.m_keys.data()[i];
+                    const K& key2 = map2.m_keys.data()[i];
+                    if (key1 < key2 || key2 < key1 || !(map1.m_values.data()[i] == map2.m_values.data()[i])) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const FlatMap<K, V, A>& map1, const FlatMap<K, V, A>& map2)
+            {
+                return !(map1 == map2);
+            }
+
+            /*
+                @brief Replaces the contents of the flat map with unsorted pairs, sorting and removing duplicate keys once.
+             *  If a key appears more than once, the last value wins, as if the pairs were set one after another.
+                Runtime complexity: O(n log n)
+                @param pairs The pairs to build from, in any order.
+                @param count The number of pairs.
+             */
+            void buildFrom(const Pair<K, V>* pairs, uint count)
+            {
+                ArrayList<Pair<K, V>> sorted = SortedUnique(pairs, count);
+                clear();
+                m_keys.reserve(sorted.size());
+                m_values.reserve(sorted.size());
+                for (uint i = 0; i < sorted.size(); i++)
+                {
+                    m_keys.add(std::move(sorted.data()[i].first));
+                    m_values.add(std::move(sorted.data()[i].second));
+                }
+            }
+
+            /*
+                @brief Replaces the contents of the flat map with an array list of unsorted pairs, sorting and removing duplicate keys once.
+             *  If a key appears more than once, the last value wins.
+                Runtime complexity: O(n log n)
+                @param pairs The pairs to build from, in any order.
+             */
+            template<typename A2>
+            void buildFrom(const ArrayList<Pair<K, V>, A2>& pairs)
+            {
+                buildFrom(pairs.data(), pairs.size());
+            }
+
+            /*
+                @brief Sets the values of many keys at once, adding the keys that are not in the flat map yet.
+                The pairs are sorted, then merged with the entries in a single pass.
+             *  If a key appears more than once, the last value wins.
+                Runtime complexity: O(n + m log m), with m the number of pairs
+                @param pairs The pairs to set, in any order.
+                @param count The number of pairs.
+                @return The number of keys added.
+             */
+            uint mergeInsert(const Pair<K, V>* pairs, uint count)
+            {
+                ArrayList<Pair<K, V>> sorted = SortedUnique(pairs, count);
+                if (sorted.size() == 0) return 0;
+
+                ArrayList<K, KeyAllocator> keys(m_keys.getAllocator());
+                ArrayList<V, ValueAllocator> values(m_values.getAllocator());
+                keys.reserve(m_keys.size() + sorted.size());
+                values.reserve(m_keys.size() + sorted.size());
+
+                K* oldKeys = m_keys.data();
+                V* oldValues = m_values.data();
+                Pair<K, V>* added = sorted.data();
+                uint i = 0, j = 0, size = m_keys.size();
+                while (i < size || j < sorted.size())
+                {
+                    if (j == sorted.size() || (i < size && oldKeys[i] < added[j].first))
+                    {
+                        keys.add(std::move(oldKeys[i]));
+                        values.add(std::move(oldValues[i]));
+                        i++;
+                        continue;
+                    }
+
+                    // A key already in the map keeps its entry and takes the new value.
+                    if (i < size && !(added[j].first < oldKeys[i]))
+                    {
+                        keys.add(std::move(oldKeys[i]));
+                        i++;
+                    }
+                    else keys.add(std::move(added[j].first));
+                    values.add(std::move(added[j].second));
+                    j++;
+                }
+
+                uint addedCount = keys.size() - size;
+                m_keys = std::move(keys);
+                m_values = std::move(values);
+                return addedCount;
+            }
+
+            /*
+                @brief Sets the values of many keys at once from an array list, adding the keys that are not in the flat map yet.
+             *  If a key appears more than once, the last value wins.
+                Runtime complexity: O(n + m log m), with m the number of pairs
+                @param pairs The pairs to set, in any order.
+                @return The number of keys added.
+             */
+            template<typename A2>
+            uint mergeInsert(const ArrayList<Pair<K, V>, A2>& pairs)
+            {
+                return mergeInsert(pairs.data(), pairs.size());
+            }
+
+            /*
+                @brief Sets the value of a key, adding the key if it is not in the flat map yet.
+                Runtime complexity: O(log n) to replace a value, O(n) to add a key
+                @param key The key to set.
+                @param value The value to set.
+             */
+            void set(K key, V value)
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                if (i < m_keys.size() && !(key < m_keys.data()[i]))
+                {
+                    m_values.data()[i] = std::move(value);
+                    return;
+                }
+
+                m_keys.insert(std::move(key), (int)i);
+                try
+                {
+                    m_values.insert(std::move(value), (int)i);
+                }
+                catch (...)
+                {
+                    m_keys.remove((int)i);
+                    throw;
+                }
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the flat map.
+             */
+            V* find(const K& key)
+            {
+                int i = indexOf(key);
+                return i == -1 ? nullptr : m_values.data() + i;
+            }
+
+            /*
+                @brief Finds the value of a key without throwing if the key is missing.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return A pointer to the value, or nullptr if the key is not in the flat map.
+             */
+            const V* find(const K& key) const
+            {
+                int i = indexOf(key);
+                return i == -1 ? nullptr : m_values.data() + i;
+            }
+
+            /*
+                @brief Finds the values of many keys at once with BinarySearchBatch, which overlaps the cache misses of the searches.
+                Much faster than calling find() in a loop once the keys do not fit in the cache.
+                Runtime complexity: O(m log n)
+                @param keys The keys to search for.
+                @param count The number of keys.
+                @param values Receives a pointer to the value of each key, or nullptr if the key is not in the flat map.
+                @return The number of keys found.
+             */
+            uint findMany(const K* keys, uint count, V** values)
+            {
+                int indices[FIND_MANY_CHUNK];
+                uint found = 0;
+                for (uint start = 0; start < count; start += FIND_MANY_CHUNK)
+                {
+                    uint chunk = Min(FIND_MANY_CHUNK, count - start);
+                    found += BinarySearchBatch(m_keys.data(), m_keys.size(), keys + start, chunk, indices);
+                    for (uint k = 0; k < chunk; k++)
+                    {
+                        values[start + k] = indices[k] == -1 ? nullptr : m_values.data() + indices[k];
+                    }
+                }
+                return found;
+            }
+
+            /*
+                @brief Checks if the flat map contains a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key) const
+            {
+                return indexOf(key) != -1;
+            }
+
+            /*
+                @brief Removes a key and its value from the flat map.
+                Runtime complexity: O(n)
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the flat map.
+             */
+            bool erase(const K& key)
+            {
+                int i = indexOf(key);
+                if (i == -1) return false;
+                m_keys.remove(i);
+                m_values.remove(i);
+                return true;
+            }
+
+            /*
+                @brief Gets the index of the first key that is not less than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key >= the given key, or size() if there is none.
+             */
+            uint lowerBound(const K& key) const
+            {
+                return LowerBound(m_keys.data(), m_keys.size(), key);
+            }
+
+            /*
+                @brief Gets the index of the first key that is greater than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key > the given key, or size() if there is none.
+             */
+            uint upperBound(const K& key) const
+            {
+                return UpperBound(m_keys.data(), m_keys.size(), key);
+            }
+
+            /*
+                @brief Returns the sorted keys, so they can be passed to the array functions of this namespace.
+                @return The keys, in ascending order.
+             */
+            const K* keys() const
+            {
+                return m_keys.data();
+            }
+
+            /*
+                @brief Returns the values, in the order of their keys.
+                @return The values.
+             */
+            V* values()
+            {
+                return m_values.data();
+            }
+
+            /*
+                @brief Returns the values, in the order of their keys.
+                @return The values.
+             */
+            const V* values() const
+            {
+                return m_values.data();
+            }
+
+            /*
+                @brief Makes room for a number of entries so that adding them does not reallocate.
+                @param count The number of entries to make room for.
+             */
+            void reserve(uint count)
+            {
+                m_keys.reserve(count);
+                m_values.reserve(count);
+            }
+
+            /*
+                @brief Frees any capacity that is not being used by entries.
+             */
+            void shrinkToFit()
+            {
+                m_keys.shrinkToFit();
+                m_values.shrinkToFit();
+            }
+
+            /*
+                @brief Removes all entries from the flat map.
+             */
+            void clear()
+            {
+                m_keys.clear();
+                m_values.clear();
+            }
+
+            /*
+                @brief Returns the number of entries in the flat map.
+                @return The size of the flat map.
+             */
+            uint size() const
+            {
+                return m_keys.size();
+            }
+
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = Pair<const K&, V&>;
+                using pointer = void;
+                using reference = Pair<const K&, V&>;
+
+                Iterator(const K* keys, V* values) : m_keys(keys), m_values(values) {}
+
+                /*
+                    @brief Returns the key of the current entry.
+                    @return A reference to the key.
+                 */
+                const K& key() const
+                {
+                    return *m_keys;
+                }
+
+                /*
+                    @brief Returns the value of the current entry.
+                    @return A reference to the value.
+                 */
+                V& value() const
+                {
+                    return *m_values;
+                }
+
+                reference operator*() const
+                {
+                    return reference(*m_keys, *m_values);
+                }
+
+                Iterator& operator++()
+                {
+                    m_keys++; m_values++; return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator tmp = *this; ++(*this); return tmp;
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_keys == it2.m_keys;
+                }
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_keys != it2.m_keys;
+                }
+
+            private:
+                const K* m_keys;
+                V* m_values;
+            };
+
+            Iterator begin()
+            {
+                return Iterator(m_keys.data(), m_values.data());
+            }
+
+            Iterator end()
+            {
+                return Iterator(m_keys.data() + m_keys.size(), m_values.data() + m_values.size());
+            }
+
+        private:
+            static constexpr uint FIND_MANY_CHUNK = 256;
+
+            ArrayList<K, KeyAllocator> m_keys;
+            ArrayList<V, ValueAllocator> m_values;
+
+            int indexOf(const K& key) const
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                return i < m_keys.size() && !(key < m_keys.data()[i]) ? (int)i : -1;
+            }
+
+            // Copies the pairs, sorts them by key with a stable sort and keeps the last pair of each key.
+            static ArrayList<Pair<K, V>> SortedUnique(const Pair<K, V>* pairs, uint count)
+            {
+                ArrayList<Pair<K, V>> sorted;
+                sorted.insertRange(pairs, count, 0);
+                MergeSort(sorted.data(), count, [](const Pair<K, V>& a, const Pair<K, V>& b) { return a.first < b.first; });
+
+                Pair<K, V>* arr = sorted.data();
+                uint kept = 0;
+                for (uint i = 0; i < count; i++)
+                {
+                    if (i + 1 < count && !(arr[i].first < arr[i + 1].first)) continue;
+                    if (kept != i) arr[kept] = std::move(arr[i]);
+                    kept++;
+                }
+                sorted.removeRange(kept, count);
+                return sorted;
+            }
+        };
+
+        /*
+            @brief A class to represent a sorted set stored in a flat array, known as boost::container::flat_set in C++.
+            The keys are kept in one sorted ArrayList, so a lookup is a branchless binary search, iterating walks an array,
+            and the set takes no more memory than its keys.
+            Ideal for read-mostly sets: build them in one go with buildFrom(), and add keys in batches with mergeInsert().
+         !  Keys are ordered with operator<.
+         *  Adding a single key with insert() shifts the following keys, O(n), so prefer the batched functions for many keys.
+            @param A The allocator to allocate the keys with.
+         */
+        template<typename K, typename A = Memory::HeapAllocator<K>>
+        class FlatSet
+        {
+        public:
+            /*
+                @brief Creates an empty flat set.
+                @param alloc The allocator to use.
+             */
+            FlatSet(const A& alloc = A()) : m_keys(alloc) {}
+
+            /*
+                @brief Creates a flat set from a given initializer list, ignoring duplicate keys.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            FlatSet(std::initializer_list<K> list, const A& alloc = A()) : FlatSet(alloc)
+            {
+                buildFrom(list.begin(), (uint)list.size());
+            }
+
+            const K& operator[](uint index) const
+            {
+                if (index >= m_keys.size())
+                {
+                    Sapphire::Err("DSA::FlatSet --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_keys.size()) + ")");
+                    throw std::runtime_error("Sapphire: DSA::FlatSet --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_keys.size()) + ")");
+                }
+                return m_keys.data()[index];
+            }
+
+            friend bool operator==(const FlatSet<K, A>& set1, const FlatSet<K, A>& set2)
+            {
+                if (set1.size() != set2.size()) return false;
+                for (uint i = 0; i < set1.size(); i++)
+                {
+                    if (set1.m_keys.data()[i] < set2.m_keys.data()[i] || set2.m_keys.data()[i] < set1.m_keys.data()[i]) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const FlatSet<K, A>& set1, const FlatSet<K, A>& set2)
+            {
+                return !(set1 == set2);
+            }
+
+            /*
+                @brief Replaces the contents of the flat set with unsorted keys, sorting and removing duplicates once.
+                Runtime complexity: O(n log n)
+                @param keys The keys to build from, in any order.
+                @param count The number of keys.
+             */
+            void buildFrom(const K* keys, uint count)
+            {
+                m_keys.clear();
+                m_keys.insertRange(keys, count, 0);
+                QuickSort(m_keys.data(), count);
+                m_keys.removeRange(Unique(m_keys.data(), count), count);
+            }
+
+            /*
+                @brief Replaces the contents of the flat set with an array list of unsorted keys, sorting and removing duplicates once.
+                Runtime complexity: O(n log n)
+                @param keys The keys to build from, in any order.
+             */
+            template<typename A2>
+            void buildFrom(const ArrayList<K, A2>& keys)
+            {
+                buildFrom(keys.data(), keys.size());
+            }
+
+            /*
+                @brief Adds many keys at once, ignoring those already in the flat set.
+                The keys are sorted, then merged with the set in a single pass.
+                Runtime complexity: O(n + m log m), with m the number of keys
+                @param keys The keys to add, in any order.
+                @param count The number of keys.
+                @return The number of keys added.
+             */
+            uint mergeInsert(const K* keys, uint count)
+            {
+                ArrayList<K> sorted;
+                sorted.insertRange(keys, count, 0);
+                QuickSort(sorted.data(), count);
+                uint unique = Unique(sorted.data(), count);
+                if (unique == 0) return 0;
+
+                ArrayList<K, A> merged(m_keys.getAllocator());
+                merged.reserve(m_keys.size() + unique);
+                K* old = m_keys.data();
+                K* added = sorted.data();
+                uint i = 0, j = 0, size = m_keys.size();
+                while (i < size || j < unique)
+                {
+                    if (j == unique || (i < size && old[i] < added[j])) merged.add(std::move(old[i++]));
+                    else
+                    {
+                        if (i < size && !(added[j] < old[i])) merged.add(std::move(old[i++]));
+                        else merged.add(std::move(added[j]));
+                        j++;
+                    }
+                }
+
+                uint addedCount = merged.size() - size;
+                m_keys = std::move(merged);
+                return addedCount;
+            }
+
+            /*
+                @brief Adds many keys at once from an array list, ignoring those already in the flat set.
+                Runtime complexity: O(n + m log m), with m the number of keys
+                @param keys The keys to add, in any order.
+                @return The number of keys added.
+             */
+            template<typename A2>
+            uint mergeInsert(const ArrayList<K, A2>& keys)
+            {
+                return mergeInsert(keys.data(), keys.size());
+            }
+
+            /*
+                @brief Adds a key to the flat set.
+                Runtime complexity: O(n)
+                @param key The key to add.
+                @return True if the key was added, false if it was already in the flat set.
+             */
+            bool insert(K key)
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                if (i < m_keys.size() && !(key < m_keys.data()[i])) return false;
+                m_keys.insert(std::move(key), (int)i);
+                return true;
+            }
+
+            /*
+                @brief Checks if the flat set contains a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return True if the key is found, false otherwise.
+             */
+            bool contains(const K& key) const
+            {
+                return indexOf(key) != -1;
+            }
+
+            /*
+                @brief Gets the index of a key in the flat set.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the key, or -1 if the key is not found.
+             */
+            int indexOf(const K& key) const
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                return i < m_keys.size() && !(key < m_keys.data()[i]) ? (int)i : -1;
+            }
+
+            /*
+                @brief Removes a key from the flat set.
+                Runtime complexity: O(n)
+                @param key The key to remove.
+                @return True if the key was removed, false if it was not in the flat set.
+             */
+            bool erase(const K& key)
+            {
+                int i = indexOf(key);
+                if (i == -1) return false;
+                m_keys.remove(i);
+                return true;
+            }
+
+            /*
+                @brief Gets the index of the first key that is not less than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key >= the given key, or size() if there is none.
+             */
+            uint lowerBound(const K& key) const
+            {
+                return LowerBound(m_keys.data(), m_keys.size(), key);
+            }
+
+            /*
+                @brief Gets the index of the first key that is greater than a given key.
+                Runtime complexity: O(log n)
+                @param key The key to search for.
+                @return The index of the first key > the given key, or size() if there is none.
+             */
+            uint upperBound(const K& key) const
+            {
+                return UpperBound(m_keys.data(), m_keys.size(), key);
+            }
+
+            /*
+                @brief Returns the sorted keys, so they can be passed to the array functions of this namespace.
+                @return The keys, in ascending order.
+             */
+            const K* data() const
+            {
+                return m_keys.data();
+            }
+
+            /*
+                @brief Makes room for a number of keys so that adding them does not reallocate.
+                @param count The number of keys to make room for.
+             */
+            void reserve(uint count)
+            {
+                m_keys.reserve(count);
+            }
+
+            /*
+                @brief Frees any capacity that is not being used by keys.
+             */
+            void shrinkToFit()
+            {
+                m_keys.shrinkToFit();
+            }
+
+            /*
+                @brief Removes all keys from the flat set.
+             */
+            void clear()
+            {
+                m_keys.clear();
+            }
+
+            /*
+                @brief Returns the number of keys in the flat set.
+                @return The size of the flat set.
+             */
+            uint size() const
+            {
+                return m_keys.size();
+            }
+
+            const K* begin() const
+            {
+                return m_keys.data();
+            }
+
+            const K* end() const
+            {
+                return m_keys.data() + m_keys.size();
+            }
+
+        private:
+            ArrayList<K, A> m_keys;
+
+            // Moves the first key of each run of equal keys in a sorted array to the front, and returns how many there are.
+            static uint Unique(K* keys, uint count)
+            {
+                if (count == 0) return 0;
+                uint kept = 1;
+                for (uint i = 1; i < count; i++)
+                {
+                    if (!(keys[kept - 1] < keys[i])) continue;
+                    if (kept != i) keys[kept] = std::move(keys[i]);
+                    kept++;
+                }
+                return kept;
+            }
+        };
+
+        /*
+            @brief A list of records stored as a struct of arrays: each field of the records lives in its own contiguous column.
+            A loop that reads one field pulls only that column through the cache, instead of every field of every record,
+            and a column of integers or floats is a plain array, so minIndex(), maxIndex() and linearSearch() run the SIMD kernels on it directly.
+            Records are read and written through row proxies that refer to one element of each column.
+            Ideal for tables that are scanned, filtered or aggregated one field at a time.
+         *  Each column is an ArrayList with the default allocator.
+         *  Adding or removing rows invalidates column spans, row proxies and iterators.
+            @param Fields The types of the fields of a record, in column order.
+         */
+        template<typename... Fields>
+        class SoAList
+        {
+            static_assert(sizeof...(Fields) > 0, "Sapphire: DSA::SoAList --> a record needs at least one field");
+
+        public:
+            // A record, as pushed and read back in one piece.
+            using Tuple = std::tuple<Fields...>;
+
+            // The type of the field at a column index.
+            template<uint I>
+            using Field = std::tuple_element_t<I, Tuple>;
+
+            static constexpr uint FIELD_COUNT = sizeof...(Fields);
+
+            /*
+                @brief A proxy for one row, referring to its element in each column.
+                Cheap to copy, it is only a pointer to the list and an index.
+             */
+            template<bool Const>
+            class BasicRow
+            {
+                using List = std::conditional_t<Const, const SoAList<Fields...>, SoAList<Fields...>>;
+
+            public:
+                BasicRow(List* list, uint index) : m_list(list), m_index(index) {}
+
+                /*
+                    @brief Gets a field of the row.
+                    @return A reference to the field, read-only for a row of a const list.
+                 */
+                template<uint I>
+                auto& get() const
+                {
+                    return std::get<I>(m_list->m_columns).data()[m_index];
+                }
+
+                /*
+                    @brief Copies every field of the row into a tuple.
+                    @return The record.
+                 */
+                Tuple toTuple() const
+                {
+                    return std::apply([this](const auto&... columns) { return Tuple(columns.data()[m_index]...); }, m_list->m_columns);
+                }
+
+                /*
+                    @brief Overwrites every field of the row.
+                    @param row The record to write.
+                 */
+                void set(const Tuple& row) const requires (!Const)
+                {
+                    setFields(row, std::index_sequence_for<Fields...>());
+                }
+
+                /*
+                    @brief Gets the index of the row in the list.
+                    @return The index of the row.
+                 */
+                uint index() const
+                {
+                    return m_index;
+                }
+
+                operator BasicRow<true>() const requires (!Const)
+                {
+                    return BasicRow<true>(m_list, m_index);
+                }
+
+            private:
+                List* m_list;
+                uint m_index;
+
+                template<size_t... I>
+                void setFields(const Tuple& row, std::index_sequence<I...>) const
+                {
+                    ((std::get<I>(m_list->m_columns).data()[m_index] = std::get<I>(row)), ...);
+                }
+            };
+
+            using Row = BasicRow<false>;
+            using ConstRow = BasicRow<true>;
+
+            /*
+                @brief Creates an empty list.
+             */
+            SoAList()
+            {
+                m_size = 0;
+            }
+
+            /*
+                @brief Creates a list from a given initializer list of records.
+                @param list The initializer list to copy.
+             */
+            SoAList(std::initializer_list<Tuple> list) : SoAList()
+            {
+                reserve((uint)list.size());
+                for (const Tuple& row : list) push(row);
+            }
+
+            SoAList(const SoAList<Fields...>& other) = default;
+            SoAList<Fields...>& operator=(const SoAList<Fields...>& other) = default;
+
+            /*
+                @brief Creates a list by taking the columns of another list.
+                The other list is left empty.
+                @param other The list to move from.
+             */
+            SoAList(SoAList<Fields...>&& other) noexcept : m_columns(std::move(other.m_columns)), m_size(other.m_size)
+            {
+                other.m_size = 0;
+            }
+
+            SoAList<Fields...>& operator=(SoAList<Fields...>&& other) noexcept
+            {
+                if (this == &other) return *this;
+                m_columns = std::move(other.m_columns);
+                m_size = other.m_size;
+                other.m_size = 0;
+                return *this;
+            }
+
+            /*
+                @brief Adds a record to the end of the list, one field to each column.
+             *  If copying a field throws, the fields already added are removed again, so the columns stay the same length.
+                Runtime complexity: O(1) amortized
+                @param row The record to add.
+             */
+            void push(const Tuple& row)
+            {
+                pushFields(row, std::index_sequence_for<Fields...>());
+            }
+
+            /*
+                @brief Adds a record to the end of the list, moving its fields into the columns.
+                Runtime complexity: O(1) amortized
+                @param row The record to add.
+             */
+            void push(Tuple&& row)
+            {
+                pushFields(std::move(row), std::index_sequence_for<Fields...>());
+            }
+
+            /*
+                @brief Adds a record to the end of the list, given field by field.
+                Runtime complexity: O(1) amortized
+                @param values The fields of the record, in column order.
+             */
+            void push(const Fields&... values)
+            {
+                push(Tuple(values...));
+            }
+
+            /*
+                @brief Removes the last record of the list.
+                Runtime complexity: O(1)
+                @return The removed record.
+             */
+            Tuple pop()
+            {
+                if (m_size == 0)
+                {
+                    Sapphire::Err("DSA::SoAList --> cannot pop from an empty list");
+                    throw std::runtime_error("Sapphire: DSA::SoAList --> cannot pop from an empty list");
+                }
+
+                m_size--;
+                return std::apply([](auto&... columns) { return Tuple(columns.pop()...); }, m_columns);
+            }
+
+            /*
+                @brief Removes the record at a given index, shifting the following records down in every column.
+                Runtime complexity: O(n)
+                @param index The index of the record to remove.
+             */
+            void remove(uint index)
+            {
+                checkIndex(index);
+                std::apply([index](auto&... columns) { (columns.remove((int)index), ...); }, m_columns);
+                m_size--;
+            }
+
+            /*
+                @brief Gets the row at a given index.
+                @param index The index of the row.
+                @return A proxy for the row.
+             */
+            Row operator[](uint index)
+            {
+                checkIndex(index);
+                return Row(this, index);
+            }
+
+            /*
+                @brief Gets the row at a given index.
+                @param index The index of the row.
+                @return A read-only proxy for the row.
+             */
+            ConstRow operator[](uint index) const
+            {
+                checkIndex(index);
+                return ConstRow(this, index);
+            }
+
+            /*
+                @brief Gets a field of a row, without going through a row proxy.
+                @param index The index of the row.
+                @return A reference to the field.
+             */
+            template<uint I>
+            Field<I>& get(uint index)
+            {
+                checkIndex(index);
+                return std::get<I>(m_columns).data()[index];
+            }
+
+            /*
+                @brief Gets a field of a row, without going through a row proxy.
+                @param index The index of the row.
+                @return A read-only reference to the field.
+             */
+            template<uint I>
+            const Field<I>& get(uint index) const
+            {
+                checkIndex(index);
+                return std::get<I>(m_columns).data()[index];
+            }
+
+            /*
+                @brief Gets a column as a span over its contiguous elements, one per row.
+                @return The column.
+             */
+            template<uint I>
+            std::span<Field<I>> column()
+            {
+                return std::span<Field<I>>(std::get<I>(m_columns).data(), m_size);
+            }
+
+            /*
+                @brief Gets a column as a span over its contiguous elements, one per row.
+                @return The read-only column.
+             */
+            template<uint I>
+            std::span<const Field<I>> column() const
+            {
+                return std::span<const Field<I>>(std::get<I>(m_columns).data(), m_size);
+            }
+
+            /*
+                @brief Returns the underlying array of a column, to pass to the array functions of this namespace.
+                @return The column data, size() elements long.
+             */
+            template<uint I>
+            Field<I>* data()
+            {
+                return std::get<I>(m_columns).data();
+            }
+
+            /*
+                @brief Returns the underlying array of a column, to pass to the array functions of this namespace.
+                @return The column data, size() elements long.
+             */
+            template<uint I>
+            const Field<I>* data() const
+            {
+                return std::get<I>(m_columns).data();
+            }
+
+            /*
+                @brief Gets the row with the minimum value of a field.
+                Columns of integers or floats are scanned with SIMD instructions, many elements at a time.
+             !  Will throw an error if the field type is not comparable.
+                Runtime complexity: O(n)
+                @return The index of the first row with the minimum value, or -1 if the list is empty.
+             */
+            template<uint I>
+            int minIndex() const
+            {
+                // The array functions take non-const arrays, but only read them.
+                return MinIndex(const_cast<Field<I>*>(data<I>()), m_size);
+            }
+
+            /*
+                @brief Gets the row with the maximum value of a field.
+                Columns of integers or floats are scanned with SIMD instructions, many elements at a time.
+             !  Will throw an error if the field type is not comparable.
+                Runtime complexity: O(n)
+                @return The index of the first row with the maximum value, or -1 if the list is empty.
+             */
+            template<uint I>
+            int maxIndex() const
+            {
+                return MaxIndex(const_cast<Field<I>*>(data<I>()), m_size);
+            }
+
+            /*
+                @brief Searches a column for a given value using linear search.
+                Columns of integers or floats are searched with SIMD instructions, many elements at a time.
+                Runtime complexity: O(n)
+                @param value The value to search for.
+                @return The index of the first row with the value, or -1 if there is none.
+             */
+            template<uint I>
+            int linearSearch(const Field<I>& value) const
+            {
+                return LinearSearch(const_cast<Field<I>*>(data<I>()), m_size, value);
+            }
+
+            /*
+                @brief Checks if any row has a given value in a field.
+                Runtime complexity: O(n)
+                @param value The value to search for.
+                @return True if the value is found, false otherwise.
+             */
+            template<uint I>
+            bool contains(const Field<I>& value) const
+            {
+                return linearSearch<I>(value) != -1;
+            }
+
+            /*
+                @brief Sorts the rows by a field in ascending order, moving the other fields along.
+                The order of the rows is found from the sorted column alone, then every column is permuted once with it.
+                Integer and float fields are radix sorted, other fields are merge sorted with operator<.
+                Stable, so sorting by several fields from the last to the first orders the rows by all of them.
+                Runtime complexity: O(n log n), O(n * k) for integer and float fields, where k is the size of the field in bytes
+                Space complexity: O(n)
+             */
+            template<uint I>
+            void sortBy()
+            {
+                using K = Field<I>;
+                if constexpr (IS_RADIX_KEY<K>)
+                {
+                    ArrayList<Pair<K, uint>> keyed;
+                    keyed.reserve(m_size);
+                    const K* keys = data<I>();
+                    for (uint i = 0; i < m_size; i++) keyed.add(Pair<K, uint>(keys[i], i));
+                    RadixSortByKey(keyed.data(), m_size, [](const Pair<K, uint>& pair) { return pair.first; });
+
+                    ArrayList<uint> order;
+                    order.reserve(m_size);
+                    for (uint i = 0; i < m_size; i++) order.add(keyed.data()[i].second);
+                    permute(order.data());
+                }
+                else sortBy<I>(Less<K>());
+            }
+
+            /*
+                @brief Sorts the rows by a field with a comparator, moving the other fields along.
+                Stable, so sorting by several fields from the last to the first orders the rows by all of them.
+                Runtime complexity: O(n log n)
+                Space complexity: O(n)
+                @param cmp A function object taking two values of the field and returning true if the first goes before the second.
+             */
+            template<uint I, typename Cmp>
+            void sortBy(Cmp cmp)
+            {
+                ArrayList<uint> order;
+                order.reserve(m_size);
+                for (uint i = 0; i < m_size; i++) order.add(i);
+
+                const Field<I>* keys = data<I>();
+                MergeSort(order.data(), m_size, [&](uint a, uint b) { return cmp(keys[a], keys[b]); });
+                permute(order.data());
+            }
+
+            /*
+                @brief Reorders the rows of every column.
+             !  The order must be a permutation of [0, size()).
+                Runtime complexity: O(n * f), where f is the number of fields
+                @param order The index of the row to move to each position, size() elements long.
+             */
+            void permute(const uint* order)
+            {
+                std::apply([this, order](auto&... columns) { (Gather(columns, order, m_size), ...); }, m_columns);
+            }
+
+            /*
+                @brief Returns the number of rows in the list.
+                @return The number of rows.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the number of rows the columns can hold before they have to grow.
+                @return The capacity of the list.
+             */
+            uint capacity() const
+            {
+                return std::get<0>(m_columns).capacity();
+            }
+
+            /*
+                @brief Reserves room for a number of rows in every column.
+                @param cap The number of rows to reserve room for.
+             */
+            void reserve(uint cap)
+            {
+                std::apply([cap](auto&... columns) { (columns.reserve(cap), ...); }, m_columns);
+            }
+
+            /*
+                @brief Frees the unused capacity of every column.
+             */
+            void shrinkToFit()
+            {
+                std::apply([](auto&... columns) { (columns.shrinkToFit(), ...); }, m_columns);
+            }
+
+            /*
+                @brief Removes every row, keeping the capacity of the columns.
+             */
+            void clear()
+            {
+                std::apply([](auto&... columns) { (columns.clear(), ...); }, m_columns);
+                m_size = 0;
+            }
+
+            template<bool Const>
+            class BasicIterator
+            {
+                using List = std::conditional_t<Const, const SoAList<Fields...>, SoAList<Fields...>>;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = BasicRow<Const>;
+                using pointer = void;
+                using reference = BasicRow<Const>;
+
+                BasicIterator(List* list, uint index) : m_list(list), m_index(index) {}
+
+                reference operator*() const
+                {
+                    return reference(m_list, m_index);
+                }
+
+                BasicIterator& operator++()
+                {
+                    m_index++; return *this;
+                }
+
+                BasicIterator operator++(int)
+                {
+                    BasicIterator tmp = *this; ++(*this); return tmp;
+                }
+
+                friend bool operator==(const BasicIterator& it1, const BasicIterator& it2)
+                {
+                    return it1.m_index == it2.m_index;
+                }
+
+                friend bool operator!=(const BasicIterator& it1, const BasicIterator& it2)
+                {
+                    return !(it1 == it2);
+                }
+
+            private:
+                List* m_list;
+                uint m_index;
+            };
+
+            using Iterator = BasicIterator<false>;
+            using ConstIterator = BasicIterator<true>;
+
+            Iterator begin()
+            {
+                return Iterator(this, 0);
+            }
+
+            Iterator end()
+            {
+                return Iterator(this, m_size);
+            }
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(this, 0);
+            }
+
+            ConstIterator end() const
+            {
+                return ConstIterator(this, m_size);
+            }
+
+        private:
+            template<typename K>
+            static constexpr bool IS_RADIX_KEY = (std::is_integral_v<K> && !std::is_same_v<K, bool> && sizeof(K) <= 8)
+                || std::is_same_v<K, float> || std::is_same_v<K, double>;
+
+            std::tuple<ArrayList<Fields>...> m_columns;
+            uint m_size;
+
+            void checkIndex(uint index) const
+            {
+                if (index >= m_size)
+                {
+                    Sapphire::Err("DSA::SoAList --> row index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                    throw std::runtime_error("Sapphire: DSA::SoAList --> row index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
+                }
+            }
+
+            template<typename Row, size_t... I>
+            void pushFields(Row&& row, std::index_sequence<I...>)
+            {
+                try
+                {
+                    (std::get<I>(m_columns).add(std::get<I>(std::forward<Row>(row))), ...);
+                }
+                catch (...)
+                {
+                    std::apply([this](auto&... columns) { ((columns.size() > m_size ? columns.removeRange((int)m_size, (int)columns.size()) : void()), ...); }, m_columns);
+                    throw;
+                }
+                m_size++;
+            }
+
+            // Moves the elements of a column into a new one in the given order, one sequential write per element.
+            template<typename T>
+            static void Gather(ArrayList<T>& column, const uint* order, uint size)
+            {
+                ArrayList<T> gathered;
+                gathered.reserve(size);
+                T* elems = column.data();
+                for (uint i = 0; i < size; i++) gathered.add(std::move(elems[order[i]]));
+                column = std::move(gathered);
+            }
+        };
+
+        /*
+            @brief A class to represent a dynamic array of bits, known as boost::dynamic_bitset in C++.
+            Bits are packed 64 to a word, so a set of IDs in [0, n) takes n / 8 bytes and a membership test is a single load.
+            Counting, rank and the set operations between bitsets run on whole words with SIMD instructions.
+         *  Bits past the size are always kept at 0, so whole words can be counted and compared directly.
+            @param A The allocator to allocate the words with.
+         */
+        template<typename A = Memory::HeapAllocator<uint64_t>>
+        class Bitset
+        {
+        public:
+            /*
+                @brief Creates an empty bitset.
+                @param alloc The allocator to use.
+             */
+            Bitset(const A& alloc = A()) : m_words(alloc), m_size(0) {}
+
+            /*
+                @brief Creates a bitset of a given size.
+                @param size The number of bits.
+                @param value The value of every bit.
+                False by default.
+                @param alloc The allocator to use.
+             */
+            Bitset(uint size, bool value = false, const A& alloc = A()) : Bitset(alloc)
+            {
+                resize(size, value);
+            }
+
+            bool operator[](uint index) const
+            {
+                return get(index);
+            }
+
+            friend bool operator==(const Bitset<A>& set1, const Bitset<A>& set2)
+            {
+                return set1.m_size == set2.m_size && std::memcmp(set1.m_words.data(), set2.m_words.data(), set1.m_words.size() * sizeof(uint64_t)) == 0;
+            }
+
+            friend bool operator!=(const Bitset<A>& set1, const Bitset<A>& set2)
+            {
+                return !(set1 == set2);
+            }
+
+            Bitset<A>& operator&=(const Bitset<A>& other)
+            {
+                return combine(Detail::Simd::BitOp::AND, other);
+            }
+
+            Bitset<A>& operator|=(const Bitset<A>& other)
+            {
+                return combine(Detail::Simd::BitOp::OR, other);
+            }
+
+            Bitset<A>& operator^=(const Bitset<A>& other)
+            {
+                return combine(Detail::Simd::BitOp::XOR, other);
+            }
+
+            friend Bitset<A> operator&(Bitset<A> set1, const Bitset<A>& set2)
+            {
+                return set1 &= set2;
+            }
+
+            friend Bitset<A> operator|(Bitset<A> set1, const Bitset<A>& set2)
+            {
+                return set1 |= set2;
+            }
+
+            friend Bitset<A> operator^(Bitset<A> set1, const Bitset<A>& set2)
+            {
+                return set1 ^= set2;
+            }
+
+            Bitset<A> operator~() const
+            {
+                Bitset<A> result(*this);
+                result.flipAll();
+                return result;
+            }
+
+            /*
+                @brief Clears every bit that is set in another bitset of the same size, in place.
+                Runtime complexity: O(n)
+                @param other The bits to clear.
+                @return This bitset.
+             */
+            Bitset<A>& andNot(const Bitset<A>& other)
+            {
+                return combine(Detail::Simd::BitOp::AND_NOT, other);
+            }
+
+            /*
+                @brief Gets the value of a bit.
+                Runtime complexity: O(1)
+                @param index The index of the bit.
+                @return The value of the bit.
+             */
+            bool get(uint index) const
+            {
+                if (index >= m_size) OutOfBounds(index, m_size);
+                return (m_words.data()[index / 64] >> (index % 64)) & 1;
+            }
+
+            /*
+                @brief Sets the value of a bit.
+                Runtime complexity: O(1)
+                @param index The index of the bit.
+                @param value The value to set.
+                True by default.
+             */
+            void set(uint index, bool value = true)
+            {
+                if (index >= m_size) OutOfBounds(index, m_size);
+                uint64_t bit = (uint64_t)1 << (index % 64);
+                uint64_t& word = m_words.data()[index / 64];
+                word = value ? word | bit : word & ~bit;
+            }
+
+            /*
+                @brief Sets a bit to 0.
+                Runtime complexity: O(1)
+                @param index The index of the bit.
+             */
+            void reset(uint index)
+            {
+                set(index, false);
+            }
+
+            /*
+                @brief Inverts a bit.
+                Runtime complexity: O(1)
+                @param index The index of the bit.
+             */
+            void flip(uint index)
+            {
+                if (index >= m_size) OutOfBounds(index, m_size);
+                m_words.data()[index / 64] ^= (uint64_t)1 << (index % 64);
+            }
+
+            /*
+                @brief Sets every bit to the same value.
+                Runtime complexity: O(n)
+                @param value The value to set.
+             */
+            void fill(bool value)
+            {
+                std::memset(m_words.data(), value ? 0xff : 0, m_words.size() * sizeof(uint64_t));
+                clearPadding();
+            }
+
+            /*
+                @brief Inverts every bit.
+                Runtime complexity: O(n)
+             */
+            void flipAll()
+            {
+                uint64_t* words = m_words.data();
+                for (uint i = 0; i < m_words.size(); i++) words[i] = ~words[i];
+                clearPadding();
+            }
+
+            /*
+                @brief Changes the number of bits.
+                Runtime complexity: O(n)
+                @param size The new number of bits.
+                @param value The value of the bits added when growing.
+                False by default.
+             */
+            void resize(uint size, bool value = false)
+            {
+                uint wordCount = (uint)(((size_t)size + 63) / 64);
+                if (size > m_size && value && m_size % 64 != 0) m_words.data()[m_size / 64] |= ~(uint64_t)0 << (m_size % 64);
+                if (wordCount < m_words.size()) m_words.removeRange(wordCount, m_words.size());
+                else
+                {
+                    m_words.reserve(wordCount);
+                    while (m_words.size() < wordCount) m_words.add(value ? ~(uint64_t)0 : 0);
+                }
+                m_size = size;
+                clearPadding();
+            }
+
+            /*
+                @brief Counts the bits that are set.
+                Runtime complexity: O(n)
+                @return The number of bits set.
+             */
+            uint count() const
+            {
+                return (uint)Detail::Simd::PopCount(m_words.data(), m_words.size());
+            }
+
+            /*
+                @brief Checks if any bit is set.
+                Runtime complexity: O(n)
+                @return True if at least one bit is set, false otherwise.
+             */
+            bool any() const
+            {
+                return findFirst() != m_size;
+            }
+
+            /*
+                @brief Checks if no bit is set.
+                Runtime complexity: O(n)
+                @return True if every bit is 0, false otherwise.
+             */
+            bool none() const
+            {
+                return !any();
+            }
+
+            /*
+                @brief Checks if every bit is set.
+                Runtime complexity: O(n)
+                @return True if every bit is 1 or the bitset is empty, false otherwise.
+             */
+            bool all() const
+            {
+                return count() == m_size;
+            }
+
+            /*
+                @brief Counts the bits set before a given index.
+                Runtime complexity: O(n)
+                @param index The index to count up to, exclusive, at most size().
+                @return The number of bits set in [0, index).
+             */
+            uint rank(uint index) const
+            {
+                if (index > m_size) OutOfBounds(index, m_size);
+                uint result = (uint)Detail::Simd::PopCount(m_words.data(), index / 64);
+                if (index % 64 != 0) result += Detail::PopCount(m_words.data()[index / 64] & (((uint64_t)1 << (index % 64)) - 1));
+                return result;
+            }
+
+            /*
+                @brief Finds the bit with a given rank: the (k + 1)th bit set, counting from 0.
+                Runtime complexity: O(n)
+             !  Will throw an error if fewer than k + 1 bits are set.
+                @param k The number of bits set before the bit to find.
+                @return The index of the bit.
+             */
+            uint select(uint k) const
+            {
+                const uint64_t* words = m_words.data();
+                uint remaining = k;
+                for (uint i = 0; i < m_words.size(); i++)
+                {
+                    uint bits = Detail::PopCount(words[i]);
+                    if (remaining < bits) return i * 64 + Detail::SelectBit(words[i], remaining);
+                    remaining -= bits;
+                }
+
+                Sapphire::Err("DSA::Bitset --> cannot select bit " + std::to_string(k) + ", only " + std::to_string(k - remaining) + " bits are set");
+                throw std::runtime_error("Sapphire: DSA::Bitset --> cannot select bit " + std::to_string(k) + ", only " + std::to_string(k - remaining) + " bits are set");
+            }
+
+            /*
+                @brief Finds the first bit set.
+                Runtime complexity: O(n)
+                @return The index of the first bit set, or size() if no bit is set.
+             */
+            uint findFirst() const
+            {
+                return findFrom(0);
+            }
+
+            /*
+                @brief Finds the first bit set after a given index.
+                Runtime complexity: O(n)
+                @param index The index to search after, exclusive.
+                @return The index of the next bit set, or size() if there is none.
+             */
+            uint findNext(uint index) const
+            {
+                return index + 1 >= m_size ? m_size : findFrom(index + 1);
+            }
+
+            /*
+                @brief Returns the words holding the bits, the bit i being bit i % 64 of word i / 64.
+                @return The words of the bitset.
+             */
+            const uint64_t* data() const
+            {
+                return m_words.data();
+            }
+
+            /*
+                @brief Returns the number of words holding the bits.
+                @return The number of words.
+             */
+            uint wordCount() const
+            {
+                return m_words.size();
+            }
+
+            /*
+                @brief Returns the number of bits in the bitset.
+                @return The size of the bitset.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief An iterator over the indices of the bits set, in ascending order.
+             */
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = uint;
+                using pointer = void;
+                using reference = uint;
+
+                Iterator(const uint64_t* words, uint wordCount, uint wordIndex) : m_words(words), m_wordCount(wordCount), m_wordIndex(wordIndex)
+                {
+                    m_bits = wordIndex < wordCount ? words[wordIndex] : 0;
+                    skipEmpty();
+                }
+
+                uint operator*() const
+                {
+                    return m_wordIndex * 64 + Detail::TrailingZeros(m_bits);
+                }
+
+                Iterator& operator++()
+                {
+                    m_bits &= m_bits - 1;
+                    skipEmpty();
+                    return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator tmp = *this; ++(*this); return tmp;
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_wordIndex == it2.m_wordIndex && it1.m_bits == it2.m_bits;
+                }
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2)
+                {
+                    return !(it1 == it2);
+                }
+
+            private:
+                const uint64_t* m_words;
+                uint m_wordCount;
+                uint m_wordIndex;
+                uint64_t m_bits;
+
+                void skipEmpty()
+                {
+                    while (m_bits == 0 && m_wordIndex < m_wordCount)
+                    {
+                        m_wordIndex++;
+                        if (m_wordIndex < m_wordCount) m_bits = m_words[m_wordIndex];
+                    }
+                }
+            };
+
+            Iterator begin() const
+            {
+                return Iterator(m_words.data(), m_words.size(), 0);
+            }
+
+            Iterator end() const
+            {
+                return Iterator(m_words.data(), m_words.size(), m_words.size());
+            }
+
+        private:
+            ArrayList<uint64_t, A> m_words;
+            uint m_size;
+
+            [[noreturn]] static void OutOfBounds(uint index, uint size)
+            {
+                Sapphire::Err("DSA::Bitset --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+                throw std::runtime_error("Sapphire: DSA::Bitset --> index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(size) + ")");
+            }
+
+            Bitset<A>& combine(Detail::Simd::BitOp op, const Bitset<A>& other)
+            {
+                if (other.m_size != m_size)
+                {
+                    Sapphire::Err("DSA::Bitset --> cannot combine bitsets of different sizes (" + std::to_string(m_size) + " and " + std::to_string(other.m_size) + ")");
+                    throw std::invalid_argument("Sapphire: DSA::Bitset --> cannot combine bitsets of different sizes (" + std::to_string(m_size) + " and " + std::to_string(other.m_size) + ")");
+                }
+                Detail::Simd::Bitwise(op, m_words.data(), m_words.data(), other.m_words.data(), m_words.size());
+                return *this;
+            }
+
+            void clearPadding()
+            {
+                if (m_size % 64 != 0) m_words.data()[m_size / 64] &= ((uint64_t)1 << (m_size % 64)) - 1;
+            }
+
+            uint findFrom(uint index) const
+            {
+                const uint64_t* words = m_words.data();
+                uint i = index / 64;
+                if (i >= m_words.size()) return m_size;
+                uint64_t word = words[i] & (~(uint64_t)0 << (index % 64));
+                while (word == 0)
+                {
+                    if (++i == m_words.size()) return m_size;
+                    word = words[i];
+                }
+                return i * 64 + Detail::TrailingZeros(word);
+            }
+        };
+
+        /*
+            @brief A class to represent a compressed set of 32-bit integers, known as a Roaring bitmap.
+            Values are split by their high 16 bits into chunks of 65536, and each chunk is stored in the smallest of three containers:
+            a sorted array of up to 4096 values, a bitmap of 8 KiB, or a list of runs of consecutive values.
+            Sparse sets take about 2 bytes per value, dense sets 1 bit per value, and ranges a few bytes each,
+            and the set operations combine chunks with merges, lookups or SIMD word kernels depending on their containers.
+         *  Chunks only become run containers through addRange() and runOptimize(), which picks runs wherever they are smaller.
+            @param A The allocator to allocate the containers with, which is rebound for each of their parts.
+         */
+        template<typename A = Memory::HeapAllocator<uint>>
+        class RoaringBitmap
+        {
+            using BitOp = Detail::Simd::BitOp;
+            using ValueAllocator = typename std::allocator_traits<A>::template rebind_alloc<ushort>;
+            using WordAllocator = typename std::allocator_traits<A>::template rebind_alloc<uint64_t>;
+
+            enum class Kind : ubyte
+            {
+                ARRAY,
+                BITMAP,
+                RUN
+            };
+
+            struct Container
+            {
+                Kind kind;
+                uint cardinality;
+                // ARRAY: the sorted values. RUN: each run as its first value and its length - 1, sorted and never touching.
+                ArrayList<ushort, ValueAllocator> values;
+                // BITMAP: one bit per value of the chunk.
+                ArrayList<uint64_t, WordAllocator> words;
+
+                Container(Kind kind, const A& alloc) : kind(kind), cardinality(0), values(ValueAllocator(alloc)), words(WordAllocator(alloc)) {}
+            };
+
+            using ContainerAllocator = typename std::allocator_traits<A>::template rebind_alloc<Container>;
+
+        public:
+            /*
+                @brief Creates an empty Roaring bitmap.
+                @param alloc The allocator to use.
+             */
+            RoaringBitmap(const A& alloc = A()) : m_keys(ValueAllocator(alloc)), m_containers(ContainerAllocator(alloc)), m_size(0), m_alloc(alloc) {}
+
+            /*
+                @brief Creates a Roaring bitmap from a given initializer list, ignoring duplicate values.
+                @param list The initializer list to copy.
+                @param alloc The allocator to use.
+             */
+            RoaringBitmap(std::initializer_list<uint> list, const A& alloc = A()) : RoaringBitmap(alloc)
+            {
+                addMany(list.begin(), (uint)list.size());
+            }
+
+            friend bool operator==(const RoaringBitmap<A>& map1, const RoaringBitmap<A>& map2)
+            {
+                if (map1.m_size != map2.m_size || map1.m_keys != map2.m_keys) return false;
+                for (uint i = 0; i < map1.m_containers.size(); i++)
+                {
+                    if (!ContainerEquals(map1.m_containers.data()[i], map2.m_containers.data()[i], map1.m_alloc)) return false;
+                }
+                return true;
+            }
+
+            friend bool operator!=(const RoaringBitmap<A>& map1, const RoaringBitmap<A>& map2)
+            {
+                return !(map1 == map2);
+            }
+
+            RoaringBitmap<A>& operator&=(const RoaringBitmap<A>& other)
+            {
+                return *this = combine(BitOp::AND, other);
+            }
+
+            RoaringBitmap<A>& operator|=(const RoaringBitmap<A>& other)
+            {
+                return *this = combine(BitOp::OR, other);
+            }
+
+            RoaringBitmap<A>& operator^=(const RoaringBitmap<A>& other)
+            {
+                return *this = combine(BitOp::XOR, other);
+            }
+
+            friend RoaringBitmap<A> operator&(const RoaringBitmap<A>& map1, const RoaringBitmap<A>& map2)
+            {
+                return map1.combine(BitOp::AND, map2);
+            }
+
+            friend RoaringBitmap<A> operator|(const RoaringBitmap<A>& map1, const RoaringBitmap<A>& map2)
+            {
+                return map1.combine(BitOp::OR, map2);
+            }
+
+            friend RoaringBitmap<A> operator^(const RoaringBitmap<A>& map1, const RoaringBitmap<A>& map2)
+            {
+                return map1.combine(BitOp::XOR, map2);
+            }
+
+            /*
+                @brief Removes every value that is in another Roaring bitmap.
+                Runtime complexity: O(n + m)
+                @param other The values to remove.
+                @return This Roaring bitmap.
+             */
+            RoaringBitmap<A>& andNot(const RoaringBitmap<A>& other)
+            {
+                return *this = combine(BitOp::AND_NOT, other);
+            }
+
+            /*
+                @brief Adds a value to the Roaring bitmap.
+                Runtime complexity: O(log c + 4096) worst case, O(log c + log 4096) for values added in ascending order
+                @param value The value to add.
+                @return True if the value was added, false if it was already in the Roaring bitmap.
+             */
+            bool add(uint value)
+            {
+                uint i = findOrCreate(value >> 16);
+                if (!ContainerAdd(m_containers.data()[i], (ushort)value)) return false;
+                m_size++;
+                return true;
+            }
+
+            /*
+                @brief Adds many values at once, ignoring those already in the Roaring bitmap.
+                The chunk of the previous value is reused without a search, so values grouped by chunk, like sorted values, add fastest.
+                @param values The values to add, in any order.
+                @param count The number of values.
+                @return The number of values added.
+             */
+            uint addMany(const uint* values, uint count)
+            {
+                uint added = 0;
+                uint i = 0;
+                bool found = false;
+                for (uint k = 0; k < count; k++)
+                {
+                    ushort key = (ushort)(values[k] >> 16);
+                    if (!found || m_keys.data()[i] != key)
+                    {
+                        i = findOrCreate(key);
+                        found = true;
+                    }
+                    if (ContainerAdd(m_containers.data()[i], (ushort)values[k])) added++;
+                }
+                m_size += added;
+                return added;
+            }
+
+            /*
+                @brief Adds every value of a range, stored as runs wherever the chunk was empty.
+                Runtime complexity: O(c + r) with r the number of chunks in the range
+             !  Will throw an error if first > last.
+                @param first The first value of the range, inclusive.
+                @param last The last value of the range, inclusive.
+             */
+            void addRange(uint first, uint last)
+            {
+                if (first > last)
+                {
+                    Sapphire::Err("DSA::RoaringBitmap --> invalid range [" + std::to_string(first) + ", " + std::to_string(last) + "]");
+                    throw std::invalid_argument("Sapphire: DSA::RoaringBitmap --> invalid range [" + std::to_string(first) + ", " + std::to_string(last) + "]");
+                }
+
+                for (uint key = first >> 16; key <= last >> 16; key++)
+                {
+                    uint low = key == first >> 16 ? first & 0xffff : 0;
+                    uint high = key == last >> 16 ? last & 0xffff : 0xffff;
+                    Container run(Kind::RUN, m_alloc);
+                    run.values.add((ushort)low);
+                    run.values.add((ushort)(high - low));
+                    run.cardinality = high - low + 1;
+
+                    uint i = LowerBound(m_keys.data(), m_keys.size(), (ushort)key);
+                    if (i < m_keys.size() && m_keys.data()[i] == key)
+                    {
+                        Container& container = m_containers.data()[i];
+                        Container merged = CombineContainers(BitOp::OR, container, run, m_alloc);
+                        m_size += merged.cardinality - container.cardinality;
+                        container = std::move(merged);
+                    }
+                    else
+                    {
+                        m_size += run.cardinality;
+                        insertContainer(i, (ushort)key, std::move(run));
+                    }
+                }
+            }
+
+            /*
+                @brief Removes a value from the Roaring bitmap.
+                Runtime complexity: O(log c + 4096)
+                @param value The value to remove.
+                @return True if the value was removed, false if it was not in the Roaring bitmap.
+             */
+            bool remove(uint value)
+            {
+                int i = indexOf((ushort)(value >> 16));
+                if (i == -1 || !ContainerRemove(m_containers.data()[i], (ushort)value)) return false;
+                m_size--;
+                if (m_containers.data()[i].cardinality == 0)
+                {
+                    m_keys.remove(i);
+                    m_containers.remove(i);
+                }
+                return true;
+            }
+
+            /*
+                @brief Checks if the Roaring bitmap contains a given value.
+                Runtime complexity: O(log c + log 4096)
+                @param value The value to search for.
+                @return True if the value is found, false otherwise.
+             */
+            bool contains(uint value) const
+            {
+                int i = indexOf((ushort)(value >> 16));
+                return i != -1 && ContainerContains(m_containers.data()[i], (ushort)value);
+            }
+
+            /*
+                @brief Counts the values less than a given value.
+                Runtime complexity: O(c + 1024)
+                @param value The value to count up to, exclusive.
+                @return The number of values in the Roaring bitmap that are less than the value.
+             */
+            size_t rank(uint value) const
+            {
+                ushort key = (ushort)(value >> 16);
+                size_t result = 0;
+                uint i = 0;
+                for (; i < m_keys.size() && m_keys.data()[i] < key; i++) result += m_containers.data()[i].cardinality;
+                if (i < m_keys.size() && m_keys.data()[i] == key) result += ContainerRank(m_containers.data()[i], (ushort)value);
+                return result;
+            }
+
+            /*
+                @brief Finds the value with a given rank: the (k + 1)th smallest value, counting from 0.
+                Runtime complexity: O(c + 1024)
+             !  Will throw an error if k >= size().
+                @param k The number of values less than the value to find.
+                @return The value.
+             */
+            uint select(size_t k) const
+            {
+                if (k >= m_size)
+                {
+                    Sapphire::Err("DSA::RoaringBitmap --> cannot select value " + std::to_string(k) + " (size: " + std::to_string(m_size) + ")");
+                    throw std::runtime_error("Sapphire: DSA::RoaringBitmap --> cannot select value " + std::to_string(k) + " (size: " + std::to_string(m_size) + ")");
+                }
+
+                uint i = 0;
+                while (k >= m_containers.data()[i].cardinality)
+                {
+                    k -= m_containers.data()[i].cardinality;
+                    i++;
+                }
+                return ((uint)m_keys.data()[i] << 16) | ContainerSelect(m_containers.data()[i], (uint)k);
+            }
+
+            /*
+                @brief Converts every container that would be smaller as a list of runs.
+                Worth calling once a Roaring bitmap of mostly consecutive values is built.
+                Runtime complexity: O(n)
+                @return True if any container was converted, false otherwise.
+             */
+            bool runOptimize()
+            {
+                bool converted = false;
+                for (uint i = 0; i < m_containers.size(); i++)
+                {
+                    Container& container = m_containers.data()[i];
+                    if (container.kind == Kind::RUN) continue;
+                    size_t bytes = container.kind == Kind::ARRAY ? container.cardinality * sizeof(ushort) : BITMAP_WORDS * sizeof(uint64_t);
+                    if (CountRuns(container) * 2 * sizeof(ushort) < bytes)
+                    {
+                        ToRuns(container);
+                        converted = true;
+                    }
+                }
+                return converted;
+            }
+
+            /*
+                @brief Removes all values from the Roaring bitmap.
+             */
+            void clear()
+            {
+                m_keys.clear();
+                m_containers.clear();
+                m_size = 0;
+            }
+
+            /*
+                @brief Returns the number of values in the Roaring bitmap.
+                @return The size of the Roaring bitmap.
+             */
+            size_t size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Gets the number of bytes the values take, not counting unused capacity.
+                @return The size of the Roaring bitmap in bytes.
+             */
+            size_t getSizeInBytes() const
+            {
+                size_t bytes = sizeof(*this) + m_keys.size() * sizeof(ushort) + m_containers.size() * sizeof(Container);
+                for (uint i = 0; i < m_containers.size(); i++)
+                {
+                    const Container& container = m_containers.data()[i];
+                    bytes += container.values.size() * sizeof(ushort) + container.words.size() * sizeof(uint64_t);
+                }
+                return bytes;
+            }
+
+            /*
+                @brief An iterator over the values, in ascending order.
+             */
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = uint;
+                using pointer = void;
+                using reference = uint;
+
+                Iterator(const RoaringBitmap<A>* map, uint container) : m_map(map), m_container(container), m_pos(0), m_bits(0), m_low(0)
+                {
+                    load();
+                }
+
+                uint operator*() const
+                {
+                    return ((uint)m_map->m_keys.data()[m_container] << 16) | m_low;
+                }
+
+                Iterator& operator++()
+                {
+                    const Container& container = m_map->m_containers.data()[m_container];
+                    switch (container.kind)
+                    {
+                        case Kind::ARRAY:
+                            if (++m_pos < container.values.size())
+                            {
+                                m_low = container.values.data()[m_pos];
+                                return *this;
+                            }
+                            break;
+                        case Kind::BITMAP:
+                            m_bits &= m_bits - 1;
+                            while (m_bits == 0 && ++m_pos < BITMAP_WORDS) m_bits = container.words.data()[m_pos];
+                            if (m_bits != 0)
+                            {
+                                m_low = m_pos * 64 + Detail::TrailingZeros(m_bits);
+                                return *this;
+                            }
+                            break;
+                        default:
+                            if (m_low < RunEnd(container.values.data(), m_pos / 2))
+                            {
+                                m_low++;
+                                return *this;
+                            }
+                            m_pos += 2;
+                            if (m_pos < container.values.size())
+                            {
+                                m_low = container.values.data()[m_pos];
+                                return *this;
+                            }
+                            break;
+                    }
+
+                    m_container++;
+                    load();
+                    return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator tmp = *this; ++(*this); return tmp;
+                }
+
+                friend bool operator==(const Iterator& it1, const Iterator& it2)
+                {
+                    return it1.m_container == it2.m_container && it1.m_low == it2.m_low;
+                }
+
+                friend bool operator!=(const Iterator& it1, const Iterator& it2)
+                {
+                    return !(it1 == it2);
+                }
+
+            private:
+                const RoaringBitmap<A>* m_map;
+                uint m_container;
+                // ARRAY: the index of the value. BITMAP: the index of the word, whose bits left to visit are in m_bits.
+                // RUN: the index of the start of the run.
+                uint m_pos;
+                uint64_t m_bits;
+                uint m_low;
+
+                // Moves to the first value of the current container, containers are never empty.
+                void load()
+                {
+                    m_pos = 0;
+                    m_low = 0;
+                    if (m_container >= m_map->m_containers.size())
+                    {
+                        m_container = m_map->m_containers.size();
+                        return;
+                    }
+
+                    const Container& container = m_map->m_containers.data()[m_container];
+                    if (container.kind == Kind::BITMAP)
+                    {
+                        m_bits = container.words.data()[0];
+                        while (m_bits == 0) m_bits = container.words.data()[++m_pos];
+                        m_low = m_pos * 64 + Detail::TrailingZeros(m_bits);
+                    }
+                    else m_low = container.values.data()[0];
+                }
+            };
+
+            Iterator begin() const
+            {
+                return Iterator(this, 0);
+            }
+
+            Iterator end() const
+            {
+                return Iterator(this, m_containers.size());
+            }
+
+        private:
+            static constexpr uint ARRAY_MAX = 4096;
+            static constexpr uint BITMAP_WORDS = 1024;
+
+            ArrayList<ushort, ValueAllocator> m_keys;
+            ArrayList<Container, ContainerAllocator> m_containers;
+            size_t m_size;
+            A m_alloc;
+
+            int indexOf(ushort key) const
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                return i < m_keys.size() && m_keys.data()[i] == key ? (int)i : -1;
+            }
+
+            uint findOrCreate(ushort key)
+            {
+                uint i = LowerBound(m_keys.data(), m_keys.size(), key);
+                if (i == m_keys.size() || m_keys.data()[i] != key) insertContainer(i, key, Container(Kind::ARRAY, m_alloc));
+                return i;
+            }
+
+            void insertContainer(uint i, ushort key, Container&& container)
+            {
+                m_keys.insert(key, (int)i);
+                try
+                {
+                    m_containers.insert(std::move(container), (int)i);
+                }
+                catch (...)
+                {
+                    m_keys.remove((int)i);
+                    throw;
+                }
+            }
+
+            void append(ushort key, Container&& container)
+            {
+                if (container.cardinality == 0) return;
+                m_size += container.cardinality;
+                m_keys.add(key);
+                m_containers.add(std::move(container));
+            }
+
+            RoaringBitmap<A> combine(BitOp op, const RoaringBitmap<A>& other) const
+            {
+                RoaringBitmap<A> result(m_alloc);
+                uint i = 0, j = 0;
+                while (i < m_keys.size() || j < other.m_keys.size())
+                {
+                    bool inThis = i < m_keys.size() && (j == other.m_keys.size() || m_keys.data()[i] <= other.m_keys.data()[j]);
+                    bool inOther = j < other.m_keys.size() && (i == m_keys.size() || other.m_keys.data()[j] <= m_keys.data()[i]);
+                    if (inThis && inOther)
+                    {
+                        result.append(m_keys.data()[i], CombineContainers(op, m_containers.data()[i], other.m_containers.data()[j], m_alloc));
+                        i++;
+                        j++;
+                    }
+                    else if (inThis)
+                    {
+                        if (op != BitOp::AND) result.append(m_keys.data()[i], Container(m_containers.data()[i]));
+                        i++;
+                    }
+                    else
+                    {
+                        if (op == BitOp::OR || op == BitOp::XOR) result.append(other.m_keys.data()[j], Container(other.m_containers.data()[j]));
+                        j++;
+                    }
+                }
+                return result;
+            }
+
+            // Returns the index of the last run starting at or before low, or -1 if there is none.
+            static int FindRun(const ushort* runs, uint runCount, ushort low)
+            {
+                uint lo = 0, hi = runCount;
+                while (lo < hi)
+                {
+                    uint mid = (lo + hi) / 2;
+                    if (runs[2 * mid] <= low) lo = mid + 1;
+                    else hi = mid;
+                }
+                return (int)lo - 1;
+            }
+
+            static uint RunEnd(const ushort* runs, uint run)
+            {
+                return (uint)runs[2 * run] + runs[2 * run + 1];
+            }
+
+            // Calls fn with every value of a container, in ascending order.
+            template<typename Fn>
+            static void ForEach(const Container& container, Fn fn)
+            {
+                const ushort* values = container.values.data();
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                        for (uint i = 0; i < container.values.size(); i++) fn((uint)values[i]);
+                        break;
+                    case Kind::BITMAP:
+                        for (uint i = 0; i < BITMAP_WORDS; i++)
+                        {
+                            for (uint64_t bits = container.words.data()[i]; bits != 0; bits &= bits - 1) fn(i * 64 + Detail::TrailingZeros(bits));
+                        }
+                        break;
+                    default:
+                        for (uint r = 0; r < container.values.size() / 2; r++)
+                        {
+                            for (uint v = values[2 * r]; v <= RunEnd(values, r); v++) fn(v);
+                        }
+                        break;
+                }
+            }
+
+            static void ZeroWords(ArrayList<uint64_t, WordAllocator>& words)
+            {
+                words.clear();
+                words.reserve(BITMAP_WORDS);
+                for (uint i = 0; i < BITMAP_WORDS; i++) words.add(0);
+            }
+
+            // Sets the bits of the values in [first, last].
+            static void SetRange(uint64_t* words, uint first, uint last)
+            {
+                uint64_t firstMask = ~(uint64_t)0 << (first % 64);
+                uint64_t lastMask = ~(uint64_t)0 >> (63 - last % 64);
+                if (first / 64 == last / 64)
+                {
+                    words[first / 64] |= firstMask & lastMask;
+                    return;
+                }
+                words[first / 64] |= firstMask;
+                for (uint i = first / 64 + 1; i < last / 64; i++) words[i] = ~(uint64_t)0;
+                words[last / 64] |= lastMask;
+            }
+
+            // Fills words with the bitmap of a container of any kind.
+            static void Materialize(const Container& container, ArrayList<uint64_t, WordAllocator>& words)
+            {
+                if (container.kind == Kind::BITMAP)
+                {
+                    words.clear();
+                    words.insertRange(container.words.data(), BITMAP_WORDS, 0);
+                    return;
+                }
+
+                ZeroWords(words);
+                uint64_t* bits = words.data();
+                const ushort* values = container.values.data();
+                if (container.kind == Kind::ARRAY)
+                {
+                    for (uint i = 0; i < container.values.size(); i++) bits[values[i] / 64] |= (uint64_t)1 << (values[i] % 64);
+                }
+                else
+                {
+                    for (uint r = 0; r < container.values.size() / 2; r++) SetRange(bits, values[2 * r], RunEnd(values, r));
+                }
+            }
+
+            static void ToBitmap(Container& container)
+            {
+                Materialize(container, container.words);
+                container.values.clear();
+                container.values.shrinkToFit();
+                container.kind = Kind::BITMAP;
+            }
+
+            // Only for containers of at most ARRAY_MAX values.
+            static void ToArray(Container& container)
+            {
+                ArrayList<ushort, ValueAllocator> values(container.values.getAllocator());
+                values.reserve(container.cardinality);
+                ForEach(container, [&](uint v) { values.add((ushort)v); });
+                container.values = std::move(values);
+                container.words.clear();
+                container.words.shrinkToFit();
+                container.kind = Kind::ARRAY;
+            }
+
+            static void ToRuns(Container& container)
+            {
+                ArrayList<ushort, ValueAllocator> runs(container.values.getAllocator());
+                runs.reserve(2 * CountRuns(container));
+                uint start = 0, prev = 0;
+                bool open = false;
+                ForEach(container, [&](uint v)
+                {
+                    if (open && v == prev + 1)
+                    {
+                        prev = v;
+                        return;
+                    }
+                    if (open)
+                    {
+                        runs.add((ushort)start);
+                        runs.add((ushort)(prev - start));
+                    }
+                    start = prev = v;
+                    open = true;
+                });
+                if (open)
+                {
+                    runs.add((ushort)start);
+                    runs.add((ushort)(prev - start));
+                }
+                container.values = std::move(runs);
+                container.words.clear();
+                container.words.shrinkToFit();
+                container.kind = Kind::RUN;
+            }
+
+            static uint CountRuns(const Container& container)
+            {
+                const ushort* values = container.values.data();
+                uint runs = 0;
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                        for (uint i = 0; i < container.values.size(); i++) runs += i == 0 || values[i] != values[i - 1] + 1;
+                        return runs;
+                    case Kind::BITMAP:
+                    {
+                        // A run starts at every set bit whose previous bit, possibly the last bit of the previous word, is clear.
+                        uint64_t carry = 0;
+                        for (uint i = 0; i < BITMAP_WORDS; i++)
+                        {
+                            uint64_t word = container.words.data()[i];
+                            runs += Detail::PopCount(word & ~((word << 1) | carry));
+                            carry = word >> 63;
+                        }
+                        return runs;
+                    }
+                    default:
+                        return container.values.size() / 2;
+                }
+            }
+
+            // Turns a run container that has become larger than an array or a bitmap of the same values into the smaller one.
+            static void FitRuns(Container& container)
+            {
+                size_t bytes = container.values.size() * sizeof(ushort);
+                if (container.cardinality <= ARRAY_MAX && bytes > container.cardinality * sizeof(ushort)) ToArray(container);
+                else if (bytes > BITMAP_WORDS * sizeof(uint64_t)) ToBitmap(container);
+            }
+
+            static bool ContainerContains(const Container& container, ushort low)
+            {
+                const ushort* values = container.values.data();
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                    {
+                        uint i = LowerBound(values, container.values.size(), low);
+                        return i < container.values.size() && values[i] == low;
+                    }
+                    case Kind::BITMAP:
+                        return (container.words.data()[low / 64] >> (low % 64)) & 1;
+                    default:
+                    {
+                        int r = FindRun(values, container.values.size() / 2, low);
+                        return r != -1 && low <= RunEnd(values, r);
+                    }
+                }
+            }
+
+            static bool ContainerAdd(Container& container, ushort low)
+            {
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                    {
+                        uint i = LowerBound(container.values.data(), container.values.size(), low);
+                        if (i < container.values.size() && container.values.data()[i] == low) return false;
+                        if (container.cardinality == ARRAY_MAX)
+                        {
+                            ToBitmap(container);
+                            return ContainerAdd(container, low);
+                        }
+                        container.values.insert(low, (int)i);
+                        break;
+                    }
+                    case Kind::BITMAP:
+                    {
+                        uint64_t& word = container.words.data()[low / 64];
+                        uint64_t bit = (uint64_t)1 << (low % 64);
+                        if (word & bit) return false;
+                        word |= bit;
+                        break;
+                    }
+                    default:
+                    {
+                        ushort* runs = container.values.data();
+                        uint runCount = container.values.size() / 2;
+                        int r = FindRun(runs, runCount, low);
+                        if (r != -1 && low <= RunEnd(runs, r)) return false;
+
+                        bool joinsPrev = r != -1 && RunEnd(runs, r) + 1 == low;
+                        bool joinsNext = (uint)(r + 1) < runCount && runs[2 * (r + 1)] == low + 1;
+                        if (joinsPrev && joinsNext)
+                        {
+                            runs[2 * r + 1] = (ushort)(RunEnd(runs, r + 1) - runs[2 * r]);
+                            container.values.removeRange(2 * (r + 1), 2 * (r + 2));
+                        }
+                        else if (joinsPrev) runs[2 * r + 1]++;
+                        else if (joinsNext)
+                        {
+                            runs[2 * (r + 1)]--;
+                            runs[2 * (r + 1) + 1]++;
+                        }
+                        else
+                        {
+                            container.values.insert(low, 2 * (r + 1));
+                            container.values.insert(0, 2 * (r + 1) + 1);
+                        }
+                        container.cardinality++;
+                        FitRuns(container);
+                        return true;
+                    }
+                }
+                container.cardinality++;
+                return true;
+            }
+
+            static bool ContainerRemove(Container& container, ushort low)
+            {
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                    {
+                        uint i = LowerBound(container.values.data(), container.values.size(), low);
+                        if (i == container.values.size() || container.values.data()[i] != low) return false;
+                        container.values.remove((int)i);
+                        container.cardinality--;
+                        return true;
+                    }
+                    case Kind::BITMAP:
+                    {
+                        uint64_t& word = container.words.data()[low / 64];
+                        uint64_t bit = (uint64_t)1 << (low % 64);
+                        if (!(word & bit)) return false;
+                        word &= ~bit;
+                        if (--container.cardinality <= ARRAY_MAX) ToArray(container);
+                        return true;
+                    }
+                    default:
+                    {
+                        ushort* runs = container.values.data();
+                        int r = FindRun(runs, container.values.size() / 2, low);
+                        if (r == -1 || low > RunEnd(runs, r)) return false;
+
+                        uint start = runs[2 * r], end = RunEnd(runs, r);
+                        if (start == end) container.values.removeRange(2 * r, 2 * r + 2);
+                        else if (low == start)
+                        {
+                            runs[2 * r]++;
+                            runs[2 * r + 1]--;
+                        }
+                        else if (low == end) runs[2 * r + 1]--;
+                        else
+                        {
+                            runs[2 * r + 1] = (ushort)(low - start - 1);
+                            container.values.insert((ushort)(low + 1), 2 * r + 2);
+                            container.values.insert((ushort)(end - low - 1), 2 * r + 3);
+                        }
+                        container.cardinality--;
+                        FitRuns(container);
+                        return true;
+                    }
+                }
+            }
+
+            // Counts the values of a container less than low.
+            static uint ContainerRank(const Container& container, ushort low)
+            {
+                const ushort* values = container.values.data();
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                        return LowerBound(values, container.values.size(), low);
+                    case Kind::BITMAP:
+                    {
+                        const uint64_t* words = container.words.data();
+                        uint result = (uint)Detail::Simd::PopCount(words, low / 64);
+                        return result + Detail::PopCount(words[low / 64] & (((uint64_t)1 << (low % 64)) - 1));
+                    }
+                    default:
+                    {
+                        uint result = 0;
+                        for (uint r = 0; r < container.values.size() / 2 && values[2 * r] < low; r++) result += Min(RunEnd(values, r), (uint)low - 1) - values[2 * r] + 1;
+                        return result;
+                    }
+                }
+            }
+
+            // Returns the (k + 1)th value of a container with more than k values.
+            static uint ContainerSelect(const Container& container, uint k)
+            {
+                const ushort* values = container.values.data();
+                switch (container.kind)
+                {
+                    case Kind::ARRAY:
+                        return values[k];
+                    case Kind::BITMAP:
+                    {
+                        const uint64_t* words = container.words.data();
+                        uint i = 0;
+                        for (uint bits = Detail::PopCount(words[0]); k >= bits; bits = Detail::PopCount(words[++i])) k -= bits;
+                        return i * 64 + Detail::SelectBit(words[i], k);
+                    }
+                    default:
+                    {
+                        uint r = 0;
+                        for (uint length = values[1] + 1u; k >= length; length = values[2 * ++r + 1] + 1u) k -= length;
+                        return values[2 * r] + k;
+                    }
+                }
+            }
+
+            static bool ContainerEquals(const Container& container1, const Container& container2, const A& alloc)
+            {
+                if (container1.cardinality != container2.cardinality) return false;
+                if (container1.kind == container2.kind)
+                {
+                    if (container1.kind == Kind::BITMAP) return std::memcmp(container1.words.data(), container2.words.data(), BITMAP_WORDS * sizeof(uint64_t)) == 0;
+                    return container1.values == container2.values;
+                }
+
+                ArrayList<uint64_t, WordAllocator> words1((WordAllocator(alloc))), words2((WordAllocator(alloc)));
+                Materialize(container1, words1);
+                Materialize(container2, words2);
+                return std::memcmp(words1.data(), words2.data(), BITMAP_WORDS * sizeof(uint64_t)) == 0;
+            }
+
+            // Keeps the values of an array container that are (or are not) in another container.
+            static Container Filter(const Container& array, const Container& other, bool keep, const A& alloc)
+            {
+                Container result(Kind::ARRAY, alloc);
+                result.values.reserve(array.cardinality);
+                for (uint i = 0; i < array.values.size(); i++)
+                {
+                    ushort low = array.values.data()[i];
+                    if (ContainerContains(other, low) == keep) result.values.add(low);
+                }
+                result.cardinality = result.values.size();
+                return result;
+            }
+
+            // Merges two array containers into their union, or their symmetric difference if exclusive.
+            static Container MergeArrays(bool exclusive, const Container& array1, const Container& array2, const A& alloc)
+            {
+                Container result(Kind::ARRAY, alloc);
+                result.values.reserve(array1.cardinality + array2.cardinality);
+                const ushort* values1 = array1.values.data();
+                const ushort* values2 = array2.values.data();
+                uint i = 0, j = 0;
+                while (i < array1.values.size() || j < array2.values.size())
+                {
+                    if (j == array2.values.size() || (i < array1.values.size() && values1[i] < values2[j])) result.values.add(values1[i++]);
+                    else if (i == array1.values.size() || values2[j] < values1[i]) result.values.add(values2[j++]);
+                    else
+                    {
+                        if (!exclusive) result.values.add(values1[i]);
+                        i++;
+                        j++;
+                    }
+                }
+                result.cardinality = result.values.size();
+                if (result.cardinality > ARRAY_MAX) ToBitmap(result);
+                return result;
+            }
+
+            // Adds a run to the end of a run container, joining it with the last run if they touch or overlap.
+            static void AppendRun(Container& container, uint start, uint end)
+            {
+                uint count = container.values.size() / 2;
+                ushort* runs = container.values.data();
+                if (count != 0 && start <= RunEnd(runs, count - 1) + 1)
+                {
+                    uint last = RunEnd(runs, count - 1);
+                    if (end > last)
+                    {
+                        runs[2 * count - 1] = (ushort)(end - runs[2 * count - 2]);
+                        container.cardinality += end - last;
+                    }
+                    return;
+                }
+                container.values.add((ushort)start);
+                container.values.add((ushort)(end - start));
+                container.cardinality += end - start + 1;
+            }
+
+            static Container UniteRuns(const Container& runs1, const Container& runs2, const A& alloc)
+            {
+                Container result(Kind::RUN, alloc);
+                const ushort* values1 = runs1.values.data();
+                const ushort* values2 = runs2.values.data();
+                uint count1 = runs1.values.size() / 2, count2 = runs2.values.size() / 2;
+                uint i = 0, j = 0;
+                while (i < count1 || j < count2)
+                {
+                    if (j == count2 || (i < count1 && values1[2 * i] <= values2[2 * j]))
+                    {
+                        AppendRun(result, values1[2 * i], RunEnd(values1, i));
+                        i++;
+                    }
+                    else
+                    {
+                        AppendRun(result, values2[2 * j], RunEnd(values2, j));
+                        j++;
+                    }
+                }
+                FitRuns(result);
+                return result;
+            }
+
+            static Container IntersectRuns(const Container& runs1, const Container& runs2, const A& alloc)
+            {
+                Container result(Kind::RUN, alloc);
+                const ushort* values1 = runs1.values.data();
+                const ushort* values2 = runs2.values.data();
+                uint count1 = runs1.values.size() / 2, count2 = runs2.values.size() / 2;
+                uint i = 0, j = 0;
+                while (i < count1 && j < count2)
+                {
+                    uint start = Max((uint)values1[2 * i], (uint)values2[2 * j]);
+                    uint end1 = RunEnd(values1, i), end2 = RunEnd(values2, j);
+                    uint end = Min(end1, end2);
+                    if (start <= end) AppendRun(result, start, end);
+                    if (end1 <= end2) i++;
+                    else j++;
+                }
+                FitRuns(result);
+                return result;
+            }
+
+            static Container CombineContainers(BitOp op, const Container& container1, const Container& container2, const A& alloc)
+            {
+                // Merges and lookups where they touch fewer values than the 1024 words of a bitmap.
+                if (op == BitOp::AND || op == BitOp::AND_NOT)
+                {
+                    if (container1.kind == Kind::ARRAY) return Filter(container1, container2, op == BitOp::AND, alloc);
+                    if (op == BitOp::AND && container2.kind == Kind::ARRAY) return Filter(container2, container1, true, alloc);
+                    if (op == BitOp::AND && container1.kind == Kind::RUN && container2.kind == Kind::RUN) return IntersectRuns(container1, container2, alloc);
+                }
+                else if (container1.kind == Kind::ARRAY && container2.kind == Kind::ARRAY) return MergeArrays(op == BitOp::XOR, container1, container2, alloc);
+                else if (op == BitOp::OR)
+                {
+                    if (container1.kind == Kind::RUN && container1.cardinality == BITMAP_WORDS * 64) return container1;
+                    if (container2.kind == Kind::RUN && container2.cardinality == BITMAP_WORDS * 64) return container2;
+                    if (container1.kind == Kind::RUN && container2.kind == Kind::RUN) return UniteRuns(container1, container2, alloc);
+                }
+
+                Container result(Kind::BITMAP, alloc);
+                Materialize(container1, result.words);
+                const uint64_t* words2 = container2.words.data();
+                ArrayList<uint64_t, WordAllocator> materialized((WordAllocator(alloc)));
+                if (container2.kind != Kind::BITMAP)
+                {
+                    Materialize(container2, materialized);
+                    words2 = materialized.data();
+                }
+                Detail::Simd::Bitwise(op, result.words.data(), result.words.data(), words2, BITMAP_WORDS);
+                result.cardinality = (uint)Detail::Simd::PopCount(result.words.data(), BITMAP_WORDS);
+                if (result.cardinality <= ARRAY_MAX) ToArray(result);
+                return result;
+            }
+        };
+
+        /*
+            @brief A class to represent a blocked Bloom filter: a compact set that answers "maybe present" or "definitely absent".
+            Each key sets k bits inside a single 64-byte block picked by its hash, so adding or looking up a key touches one cache line,
+            and the block and all k bits are derived from one 64-bit hash.
+            Ideal in front of anything expensive, like a HashMap lookup, a file read or FileSystem::Exists(),
+            to reject missing keys in a few nanoseconds.
+         *  There are no false negatives, but keys that were never added are reported as present at the false positive rate.
+         *  Keys cannot be removed, use a CuckooFilter for that.
+            @param H The hash function object.
+            @param A The allocator to allocate the blocks with.
+         */
+        template<typename T, typename H = std::hash<T>, typename A = Memory::HeapAllocator<T>>
+        class BloomFilter
+        {
+            struct alignas(64) Block
+            {
+                uint64_t words[8];
+            };
+
+            using BlockAllocator = typename std::allocator_traits<A>::template rebind_alloc<Block>;
+
+        public:
+            /*
+                @brief Creates a Bloom filter sized to hold a number of keys at a given false positive rate.
+                The bits per key and the number of hashes are picked for the blocked layout, whose keys spread unevenly over the blocks,
+                so the filter is a little larger than a plain Bloom filter of the same rate.
+             !  Will throw an error if the rate is not between 0 and 1.
+                @param expectedCount The number of keys the filter will hold.
+                @param falsePositiveRate The rate of false positives once every key is added.
+                0.01 by default.
+                @param alloc The allocator to use.
+             */
+            BloomFilter(uint expectedCount, double falsePositiveRate = 0.01, const A& alloc = A()) : m_blocks(BlockAllocator(alloc))
+            {
+                if (!(falsePositiveRate > 0 && falsePositiveRate < 1))
+                {
+                    Sapphire::Err("DSA::BloomFilter --> false positive rate " + std::to_string(falsePositiveRate) + " is not between 0 and 1");
+                    throw std::invalid_argument("Sapphire: DSA::BloomFilter --> false positive rate " + std::to_string(falsePositiveRate) + " is not between 0 and 1");
+                }
+
+                // Starts from the bits per key of a plain Bloom filter, and adds bits until the blocked layout reaches the rate.
+                double bitsPerKey = -std::log(falsePositiveRate) / (LN2 * LN2);
+                m_hashes = HashCount(bitsPerKey);
+                while (bitsPerKey < MAX_BITS_PER_KEY && EstimateRate(BLOCK_BITS / bitsPerKey, m_hashes) > falsePositiveRate)
+                {
+                    bitsPerKey += 0.25;
+                    m_hashes = HashCount(bitsPerKey);
+                }
+                allocate((uint)Max(std::ceil(expectedCount * bitsPerKey / BLOCK_BITS), 1.0));
+            }
+
+            /*
+                @brief Creates a Bloom filter from a file written by save().
+             !  Will throw an error if the file cannot be read or is not a Bloom filter.
+                @param path The path of the file to load.
+                @param alloc The allocator to use.
+             */
+            BloomFilter(const std::string& path, const A& alloc = A()) : m_blocks(BlockAllocator(alloc))
+            {
+                deserialize(FileSystem::ReadBinary(path));
+            }
+
+            /*
+                @brief Adds a key to the Bloom filter.
+                Runtime complexity: O(k)
+                @param key The key to add.
+             */
+            void add(const T& key)
+            {
+                addHash(Hash(key));
+            }
+
+            /*
+                @brief Adds many keys at once, loading the blocks of a group of keys before setting their bits.
+                Much faster than calling add() in a loop once the filter does not fit in the cache.
+                Runtime complexity: O(m k)
+                @param keys The keys to add.
+                @param count The number of keys.
+             */
+            void addMany(const T* keys, uint count)
+            {
+                uint64_t hashes[Detail::BATCH_GROUP_SIZE];
+                for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+                {
+                    uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                    for (uint i = 0; i < group; i++)
+                    {
+                        hashes[i] = Hash(keys[start + i]);
+                        Detail::Prefetch(m_blocks.data() + blockOf(hashes[i]));
+                    }
+                    for (uint i = 0; i < group; i++) addHash(hashes[i]);
+                }
+            }
+
+            /*
+                @brief Checks if the Bloom filter may contain a given key.
+                Runtime complexity: O(k)
+                @param key The key to search for.
+                @return False if the key was never added, true if it was added or is a false positive.
+             */
+            bool contains(const T& key) const
+            {
+                return containsHash(Hash(key));
+            }
+
+            /*
+                @brief Checks many keys at once, loading the blocks of a group of keys before testing their bits.
+                Much faster than calling contains() in a loop once the filter does not fit in the cache.
+                Runtime complexity: O(m k)
+                @param keys The keys to search for.
+                @param count The number of keys.
+                @param results Receives the result of contains() for each key.
+                @return The number of keys that may be present.
+             */
+            uint containsMany(const T* keys, uint count, bool* results) const
+            {
+                uint64_t hashes[Detail::BATCH_GROUP_SIZE];
+                uint found = 0;
+                for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+                {
+                    uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                    for (uint i = 0; i < group; i++)
+                    {
+                        hashes[i] = Hash(keys[start + i]);
+                        Detail::Prefetch(m_blocks.data() + blockOf(hashes[i]));
+                    }
+                    for (uint i = 0; i < group; i++)
+                    {
+                        results[start + i] = containsHash(hashes[i]);
+                        found += results[start + i];
+                    }
+                }
+                return found;
+            }
+
+            /*
+                @brief Adds every key of another Bloom filter of the same size, by combining their bits with SIMD instructions.
+                Runtime complexity: O(n)
+             !  Will throw an error if the filters do not have the same number of blocks and hashes.
+                @param other The filter to merge.
+             */
+            void merge(const BloomFilter<T, H, A>& other)
+            {
+                if (other.m_blocks.size() != m_blocks.size() || other.m_hashes != m_hashes)
+                {
+                    Sapphire::Err("DSA::BloomFilter --> cannot merge filters of different sizes");
+                    throw std::invalid_argument("Sapphire: DSA::BloomFilter --> cannot merge filters of different sizes");
+                }
+                uint64_t* words = m_blocks.data()->words;
+                Detail::Simd::Bitwise(Detail::Simd::BitOp::OR, words, words, other.m_blocks.data()->words, m_blocks.size() * WORDS_PER_BLOCK);
+                m_count += other.m_count;
+            }
+
+            /*
+                @brief Removes all keys from the Bloom filter, keeping its size.
+             */
+            void clear()
+            {
+                std::memset(m_blocks.data(), 0, m_blocks.size() * sizeof(Block));
+                m_count = 0;
+            }
+
+            /*
+                @brief Estimates the current false positive rate from the number of keys added.
+                @return The probability that a key that was never added is reported as present.
+             */
+            double getFalsePositiveRate() const
+            {
+                return EstimateRate((double)m_count / m_blocks.size(), m_hashes);
+            }
+
+            /*
+                @brief Returns the number of bits set by each key.
+                @return The number of hashes.
+             */
+            uint getHashCount() const
+            {
+                return m_hashes;
+            }
+
+            /*
+                @brief Gets the number of bytes the bits of the filter take.
+                @return The size of the filter in bytes.
+             */
+            size_t getSizeInBytes() const
+            {
+                return (size_t)m_blocks.size() * sizeof(Block);
+            }
+
+            /*
+                @brief Returns the number of keys added, counting keys added more than once.
+                @return The number of keys added.
+             */
+            uint size() const
+            {
+                return m_count;
+            }
+
+            /*
+                @brief Serializes the Bloom filter to bytes, to be read back with deserialize().
+             *  The bytes are only valid for a process whose hash function gives the same hashes, on a machine of the same byte order.
+                @return The serialized filter.
+             */
+            std::string serialize() const
+            {
+                std::string bytes;
+                bytes.reserve(HEADER_BYTES + getSizeInBytes());
+                bytes.append(MAGIC, 4);
+                Detail::AppendBytes(bytes, (uint32_t)m_hashes);
+                Detail::AppendBytes(bytes, (uint32_t)m_blocks.size());
+                Detail::AppendBytes(bytes, (uint64_t)m_count);
+                bytes.append((const char*)m_blocks.data(), getSizeInBytes());
+                return bytes;
+            }
+
+            /*
+                @brief Replaces the Bloom filter with one serialized by serialize().
+             !  Will throw an error if the bytes are not a serialized Bloom filter.
+                @param bytes The serialized filter.
+             */
+            void deserialize(const std::string& bytes)
+            {
+                uint32_t hashes = 0, blocks = 0;
+                if (bytes.size() >= HEADER_BYTES)
+                {
+                    hashes = Detail::ReadBytes<uint32_t>(bytes, 4);
+                    blocks = Detail::ReadBytes<uint32_t>(bytes, 8);
+                }
+                if (bytes.size() < HEADER_BYTES || bytes.compare(0, 4, MAGIC, 4) != 0 || hashes == 0 || hashes > MAX_HASHES || blocks == 0
+                    || bytes.size() != HEADER_BYTES + (size_t)blocks * sizeof(Block))
+                {
+                    Sapphire::Err("DSA::BloomFilter --> the data is not a serialized Bloom filter");
+                    throw std::runtime_error("Sapphire: DSA::BloomFilter --> the data is not a serialized Bloom filter");
+                }
+
+                m_hashes = hashes;
+                allocate(blocks);
+                m_count = (uint)Detail::ReadBytes<uint64_t>(bytes, 12);
+                std::memcpy(m_blocks.data(), bytes.data() + HEADER_BYTES, (size_t)blocks * sizeof(Block));
+            }
+
+            /*
+                @brief Saves the Bloom filter to a file, to be loaded back with load() or the path constructor.
+             !  Will throw an error if the file cannot be written.
+                @param path The path of the file to write.
+             */
+            void save(const std::string& path) const
+            {
+                if (!FileSystem::WriteBinary(path, serialize()))
+                {
+                    Sapphire::Err("DSA::BloomFilter --> failed to save to \"" + path + "\"");
+                    throw std::runtime_error("Sapphire: DSA::BloomFilter --> failed to save to \"" + path + "\"");
+                }
+            }
+
+            /*
+                @brief Replaces the Bloom filter with one saved to a file by save().
+             !  Will throw an error if the file cannot be read or is not a Bloom filter.
+                @param path The path of the file to load.
+             */
+            void load(const std::string& path)
+            {
+                deserialize(FileSystem::ReadBinary(path));
+            }
+
+        private:
+            static constexpr uint BLOCK_BITS = 512;
+            static constexpr uint WORDS_PER_BLOCK = 8;
+            static constexpr uint MAX_HASHES = 16;
+            static constexpr double MAX_BITS_PER_KEY = 64;
+            static constexpr double LN2 = 0.6931471805599453;
+            static constexpr size_t HEADER_BYTES = 20;
+            static constexpr const char* MAGIC = "SBLF";
+
+            ArrayList<Block, BlockAllocator> m_blocks;
+            uint m_hashes;
+            uint m_count;
+
+            void allocate(uint blocks)
+            {
+                m_blocks.clear();
+                m_blocks.shrinkToFit();
+                m_blocks.reserve(blocks);
+                for (uint i = 0; i < blocks; i++) m_blocks.add(Block());
+                m_count = 0;
+            }
+
+            static uint HashCount(double bitsPerKey)
+            {
+                return (uint)Min(Max(std::round(bitsPerKey * LN2), 1.0), (double)MAX_HASHES);
+            }
+
+            // Keys per block follow a Poisson distribution, and a block holding i keys reports a missing key as present
+            // with probability (1 - (1 - 1/512)^(i k))^k.
+            static double EstimateRate(double keysPerBlock, uint hashes)
+            {
+                double rate = 0;
+                double probability = std::exp(-keysPerBlock);
+                uint limit = (uint)(keysPerBlock + 10 * std::sqrt(keysPerBlock) + 10);
+                for (uint i = 0; i <= limit; i++)
+                {
+                    rate += probability * std::pow(1 - std::pow(1 - 1.0 / BLOCK_BITS, (double)i * hashes), hashes);
+                    probability *= keysPerBlock / (i + 1);
+                }
+                return rate;
+            }
+
+            static uint64_t Hash(const T& key)
+            {
+                return Detail::MixHash((uint64_t)H{}(key));
+            }
+
+            // The high 32 bits pick the block, without a division.
+            uint blockOf(uint64_t hash) const
+            {
+                return (uint)(((hash >> 32) * m_blocks.size()) >> 32);
+            }
+
+            // The low 32 bits are multiplied by an odd constant once per hash, and each bit index is read from their top 9 bits.
+            void addHash(uint64_t hash)
+            {
+                uint64_t* words = m_blocks.data()[blockOf(hash)].words;
+                uint32_t h = (uint32_t)hash;
+                for (uint i = 0; i < m_hashes; i++)
+                {
+                    uint bit = h >> 23;
+                    words[bit / 64] |= (uint64_t)1 << (bit % 64);
+                    h *= 0x9E3779B9;
+                }
+                m_count++;
+            }
+
+            bool containsHash(uint64_t hash) const
+            {
+                const uint64_t* words = m_blocks.data()[blockOf(hash)].words;
+                uint32_t h = (uint32_t)hash;
+                uint64_t found = 1;
+                for (uint i = 0; i < m_hashes; i++)
+                {
+                    uint bit = h >> 23;
+                    found &= words[bit / 64] >> (bit % 64);
+                    h *= 0x9E3779B9;
+                }
+                return found & 1;
+            }
+        };
+
+        /*
+            @brief A class to represent a cuckoo filter: a compact set that answers "maybe present" or "definitely absent", and supports removal.
+            Each key is stored as a small fingerprint in one of two buckets of 4 slots, so a lookup reads at most two cache lines.
+            The fingerprint is 8, 16 or 32 bits, the smallest that reaches the false positive rate.
+         *  There are no false negatives, but keys that were never added are reported as present at the false positive rate.
+         *  Only remove keys that were added: removing a false positive removes the fingerprint of another key.
+         *  Once full, add() returns false and the filter keeps every key added so far.
+            @param H The hash function object.
+            @param A The allocator to allocate the buckets with.
+         */
+        template<typename T, typename H = std::hash<T>, typename A = Memory::HeapAllocator<T>>
+        class CuckooFilter
+        {
+            using ByteAllocator = typename std::allocator_traits<A>::template rebind_alloc<ubyte>;
+
+        public:
+            /*
+                @brief Creates a cuckoo filter sized to hold a number of keys at a given false positive rate.
+             !  Will throw an error if the rate is not between 0 and 1.
+                @param expectedCount The number of keys the filter will hold.
+                @param falsePositiveRate The rate of false positives once every key is added.
+                0.001 by default.
+                @param alloc The allocator to use.
+             */
+            CuckooFilter(uint expectedCount, double falsePositiveRate = 0.001, const A& alloc = A()) : m_table(ByteAllocator(alloc))
+            {
+                if (!(falsePositiveRate > 0 && falsePositiveRate < 1))
+                {
+                    Sapphire::Err("DSA::CuckooFilter --> false positive rate " + std::to_string(falsePositiveRate) + " is not between 0 and 1");
+                    throw std::invalid_argument("Sapphire: DSA::CuckooFilter --> false positive rate " + std::to_string(falsePositiveRate) + " is not between 0 and 1");
+                }
+
+                // A lookup compares 2 buckets of SLOTS fingerprints, each matching a random fingerprint with probability 1 / (2^bits - 1).
+                uint bytes = 1;
+                while (bytes < 4 && 2.0 * SLOTS / (std::pow(2.0, 8.0 * bytes) - 1) > falsePositiveRate) bytes *= 2;
+                if (2.0 * SLOTS / (std::pow(2.0, 8.0 * bytes) - 1) > falsePositiveRate)
+                {
+                    Sapphire::Warn("DSA::CuckooFilter --> false positive rate " + std::to_string(falsePositiveRate) + " is below what 32-bit fingerprints reach");
+                }
+
+                uint buckets = 1;
+                while ((double)expectedCount > buckets * SLOTS * MAX_LOAD) buckets *= 2;
+                allocate(bytes, buckets);
+            }
+
+            /*
+                @brief Creates a cuckoo filter from a file written by save().
+             !  Will throw an error if the file cannot be read or is not a cuckoo filter.
+                @param path The path of the file to load.
+                @param alloc The allocator to use.
+             */
+            CuckooFilter(const std::string& path, const A& alloc = A()) : m_table(ByteAllocator(alloc))
+            {
+                deserialize(FileSystem::ReadBinary(path));
+            }
+
+            /*
+                @brief Adds a key to the cuckoo filter, moving other fingerprints to their other bucket if both buckets are full.
+                Runtime complexity: O(1) on average
+                @param key The key to add.
+                @return True if the key was added, false if the filter is full.
+             */
+            bool add(const T& key)
+            {
+                uint64_t hash = Hash(key);
+                switch (m_fingerprintBytes)
+                {
+                    case 1: return addHash<uint8_t>(hash);
+                    case 2: return addHash<uint16_t>(hash);
+                    default: return addHash<uint32_t>(hash);
+                }
+            }
+
+            /*
+                @brief Adds many keys at once, loading the buckets of a group of keys before inserting them.
+                Runtime complexity: O(m) on average
+                @param keys The keys to add.
+                @param count The number of keys.
+                @return The number of keys added, less than count if the filter became full.
+             */
+            uint addMany(const T* keys, uint count)
+            {
+                uint64_t hashes[Detail::BATCH_GROUP_SIZE];
+                uint added = 0;
+                for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+                {
+                    uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                    prefetchGroup(keys + start, group, hashes);
+                    for (uint i = 0; i < group; i++)
+                    {
+                        switch (m_fingerprintBytes)
+                        {
+                            case 1: added += addHash<uint8_t>(hashes[i]); break;
+                            case 2: added += addHash<uint16_t>(hashes[i]); break;
+                            default: added += addHash<uint32_t>(hashes[i]); break;
+                        }
+                    }
+                }
+                return added;
+            }
+
+            /*
+                @brief Checks if the cuckoo filter may contain a given key.
+                Runtime complexity: O(1)
+                @param key The key to search for.
+                @return False if the key is not in the filter, true if it is or is a false positive.
+             */
+            bool contains(const T& key) const
+            {
+                uint64_t hash = Hash(key);
+                switch (m_fingerprintBytes)
+                {
+                    case 1: return containsHash<uint8_t>(hash);
+                    case 2: return containsHash<uint16_t>(hash);
+                    default: return containsHash<uint32_t>(hash);
+                }
+            }
+
+            /*
+                @brief Checks many keys at once, loading the buckets of a group of keys before searching them.
+                Much faster than calling contains() in a loop once the filter does not fit in the cache.
+                Runtime complexity: O(m)
+                @param keys The keys to search for.
+                @param count The number of keys.
+                @param results Receives the result of contains() for each key.
+                @return The number of keys that may be present.
+             */
+            uint containsMany(const T* keys, uint count, bool* results) const
+            {
+                uint64_t hashes[Detail::BATCH_GROUP_SIZE];
+                uint found = 0;
+                for (uint start = 0; start < count; start += Detail::BATCH_GROUP_SIZE)
+                {
+                    uint group = Min(Detail::BATCH_GROUP_SIZE, count - start);
+                    prefetchGroup(keys + start, group, hashes);
+                    for (uint i = 0; i < group; i++)
+                    {
+                        switch (m_fingerprintBytes)
+                        {
+                            case 1: results[start + i] = containsHash<uint8_t>(hashes[i]); break;
+                            case 2: results[start + i] = containsHash<uint16_t>(hashes[i]); break;
+                            default: results[start + i] = containsHash<uint32_t>(hashes[i]); break;
+                        }
+                        found += results[start + i];
+                    }
+                }
+                return found;
+            }
+
+            /*
+                @brief Removes a key from the cuckoo filter.
+                Runtime complexity: O(1) on average
+             !  Only remove keys that were added, removing a false positive removes another key.
+                @param key The key to remove.
+                @return True if a fingerprint of the key was removed, false if the key is not in the filter.
+             */
+            bool remove(const T& key)
+            {
+                uint64_t hash = Hash(key);
+                switch (m_fingerprintBytes)
+                {
+                    case 1: return removeHash<uint8_t>(hash);
+                    case 2: return removeHash<uint16_t>(hash);
+                    default: return removeHash<uint32_t>(hash);
+                }
+            }
+
+            /*
+                @brief Removes all keys from the cuckoo filter, keeping its size.
+             */
+            void clear()
+            {
+                std::memset(m_table.data(), 0, m_table.size());
+                m_size = 0;
+                m_hasVictim = false;
+            }
+
+            /*
+                @brief Estimates the current false positive rate from the number of keys in the filter.
+                @return The probability that a key that is not in the filter is reported as present.
+             */
+            double getFalsePositiveRate() const
+            {
+                return 2.0 * SLOTS * getLoadFactor() / (std::pow(2.0, 8.0 * m_fingerprintBytes) - 1);
+            }
+
+            /*
+                @brief Returns the fraction of slots holding a fingerprint.
+                @return The load factor of the filter.
+             */
+            double getLoadFactor() const
+            {
+                return (double)m_size / capacity();
+            }
+
+            /*
+                @brief Returns the number of bits of each fingerprint.
+                @return 8, 16 or 32.
+             */
+            uint getFingerprintBits() const
+            {
+                return m_fingerprintBytes * 8;
+            }
+
+            /*
+                @brief Gets the number of bytes the buckets of the filter take.
+                @return The size of the filter in bytes.
+             */
+            size_t getSizeInBytes() const
+            {
+                return m_table.size();
+            }
+
+            /*
+                @brief Returns the number of keys in the cuckoo filter.
+                @return The size of the filter.
+             */
+            uint size() const
+            {
+                return m_size;
+            }
+
+            /*
+                @brief Returns the number of fingerprint slots.
+                @return The capacity of the filter.
+             */
+            uint capacity() const
+            {
+                return (m_bucketMask + 1) * SLOTS;
+            }
+
+            /*
+                @brief Serializes the cuckoo filter to bytes, to be read back with deserialize().
+             *  The bytes are only valid for a process whose hash function gives the same hashes, on a machine of the same byte order.
+                @return The serialized filter.
+             */
+            std::string serialize() const
+            {
+                std::string bytes;
+                bytes.reserve(HEADER_BYTES + m_table.size());
+                bytes.append(MAGIC, 4);
+                Detail::AppendBytes(bytes, (uint32_t)m_fingerprintBytes);
+                Detail::AppendBytes(bytes, (uint32_t)(m_bucketMask + 1));
+                Detail::AppendBytes(bytes, (uint32_t)m_size);
+                Detail::AppendBytes(bytes, (uint32_t)m_hasVictim);
+                Detail::AppendBytes(bytes, (uint32_t)m_victimBucket);
+                Detail::AppendBytes(bytes, (uint32_t)m_victim);
+                bytes.append((const char*)m_table.data(), m_table.size());
+                return bytes;
+            }
+
+            /*
+                @brief Replaces the cuckoo filter with one serialized by serialize().
+             !  Will throw an error if the bytes are not a serialized cuckoo filter.
+                @param bytes The serialized filter.
+             */
+            void deserialize(const std::string& bytes)
+            {
+                uint32_t fingerprintBytes = 0, buckets = 0;
+                if (bytes.size() >= HEADER_BYTES)
+                {
+                    fingerprintBytes = Detail::ReadBytes<uint32_t>(bytes, 4);
+                    buckets = Detail::ReadBytes<uint32_t>(bytes, 8);
+                }
+                if (bytes.size() < HEADER_BYTES || bytes.compare(0, 4, MAGIC, 4) != 0 || (fingerprintBytes != 1 && fingerprintBytes != 2 && fingerprintBytes != 4)
+                    || buckets == 0 || (buckets & (buckets - 1)) != 0 || bytes.size() != HEADER_BYTES + (size_t)buckets * SLOTS * fingerprintBytes)
+                {
+                    Sapphire::Err("DSA::CuckooFilter --> the data is not a serialized cuckoo filter");
+                    throw std::runtime_error("Sapphire: DSA::CuckooFilter --> the data is not a serialized cuckoo filter");
+                }
+
+                allocate(fingerprintBytes, buckets);
+                m_size = Detail::ReadBytes<uint32_t>(bytes, 12);
+                m_hasVictim = Detail::ReadBytes<uint32_t>(bytes, 16) != 0;
+                m_victimBucket = Detail::ReadBytes<uint32_t>(bytes, 20) & m_bucketMask;
+                m_victim = Detail::ReadBytes<uint32_t>(bytes, 24);
+                std::memcpy(m_table.data(), bytes.data() + HEADER_BYTES, m_table.size());
+            }
+
+            /*
+                @brief Saves the cuckoo filter to a file, to be loaded back with load() or the path constructor.
+             !  Will throw an error if the file cannot be written.
+                @param path The path of the file to write.
+             */
+            void save(const std::string& path) const
+            {
+                if (!FileSystem::WriteBinary(path, serialize()))
+                {
+                    Sapphire::Err("DSA::CuckooFilter --> failed to save to \"" + path + "\"");
+                    throw std::runtime_error("Sapphire: DSA::CuckooFilter --> failed to save to \"" + path + "\"");
+                }
+            }
+
+            /*
+                @brief Replaces the cuckoo filter with one saved to a file by save().
+             !  Will throw an error if the file cannot be read or is not a cuckoo filter.
+                @param path The path of the file to load.
+             */
+            void load(const std::string& path)
+            {
+                deserialize(FileSystem::ReadBinary(path));
+            }
+
+        private:
+            static constexpr uint SLOTS = 4;
+            static constexpr uint MAX_KICKS = 500;
+            static constexpr double MAX_LOAD = 0.95;
+            static constexpr size_t HEADER_BYTES = 28;
+            static constexpr const char* MAGIC = "SCKF";
+
+            // SLOTS fingerprints per bucket, 0 marking an empty slot.
+            ArrayList<ubyte, ByteAllocator> m_table;
+            uint m_fingerprintBytes;
+            uint m_bucketMask;
+            uint m_size;
+            // The fingerprint left without a slot when an insertion gives up, which makes the filter full.
+            bool m_hasVictim;
+            uint m_victimBucket;
+            uint32_t m_victim;
+            uint64_t m_random;
+
+            void allocate(uint fingerprintBytes, uint buckets)
+            {
+                m_fingerprintBytes = fingerprintBytes;
+                m_bucketMask = buckets - 1;
+                m_table.clear();
+                m_table.shrinkToFit();
+                m_table.reserve(buckets * SLOTS * fingerprintBytes);
+                for (uint i = 0; i < buckets * SLOTS * fingerprintBytes; i++) m_table.add(0);
+                m_size = 0;
+                m_hasVictim = false;
+                m_victimBucket = 0;
+                m_victim = 0;
+                m_random = 0x9E3779B97F4A7C15ULL;
+            }
+
+            static uint64_t Hash(const T& key)
+            {
+                return Detail::MixHash((uint64_t)H{}(key));
+            }
+
+            // The fingerprint comes from the high 32 bits of the hash and the first bucket from the low bits, 0 being kept for empty slots.
+            template<typename F>
+            static F Fingerprint(uint64_t hash)
+            {
+                F fingerprint = (F)(hash >> 32);
+                return fingerprint == 0 ? 1 : fingerprint;
+            }
+
+            // Applying it twice gives back the first bucket, so a fingerprint can be moved to its other bucket without its key.
+            template<typename F>
+            uint otherBucket(uint bucket, F fingerprint) const
+            {
+                return (bucket ^ ((uint32_t)fingerprint * 0x5BD1E995)) & m_bucketMask;
+            }
+
+            template<typename F>
+            F getSlot(uint bucket, uint slot) const
+            {
+                F fingerprint;
+                std::memcpy(&fingerprint, m_table.data() + ((size_t)bucket * SLOTS + slot) * sizeof(F), sizeof(F));
+                return fingerprint;
+            }
+
+            template<typename F>
+            void setSlot(uint bucket, uint slot, F fingerprint)
+            {
+                std::memcpy(m_table.data() + ((size_t)bucket * SLOTS + slot) * sizeof(F), &fingerprint, sizeof(F));
+            }
+
+            // Compares the whole bucket at once for 8 and 16-bit fingerprints, with the classic test for a zero lane in a word.
+            template<typename F>
+            bool bucketHas(uint bucket, F fingerprint) const
+            {
+                if constexpr (sizeof(F) == 4)
+                {
+                    for (uint slot = 0; slot < SLOTS; slot++)
+                    {
+                        if (getSlot<F>(bucket, slot) == fingerprint) return true;
+                    }
+                    return false;
+                }
+                else
+                {
+                    using W = std::conditional_t<sizeof(F) == 1, uint32_t, uint64_t>;
+                    constexpr W ONES = (W)~(W)0 / (F)~(F)0;
+                    constexpr W HIGH = ONES << (8 * sizeof(F) - 1);
+                    W word;
+                    std::memcpy(&word, m_table.data() + (size_t)bucket * sizeof(W), sizeof(W));
+                    W lanes = word ^ (ONES * fingerprint);
+                    return ((lanes - ONES) & ~lanes & HIGH) != 0;
+                }
+            }
+
+            template<typename F>
+            bool placeInBucket(uint bucket, F fingerprint)
+            {
+                for (uint slot = 0; slot < SLOTS; slot++)
+                {
+                    if (getSlot<F>(bucket, slot) == 0)
+                    {
+                        setSlot<F>(bucket, slot, fingerprint);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            uint nextRandom()
+            {
+                m_random ^= m_random << 13;
+                m_random ^= m_random >> 7;
+                m_random ^= m_random << 17;
+                return (uint)m_random;
+            }
+
+            // Places a fingerprint, evicting random fingerprints to their other bucket until one finds a free slot.
+            template<typename F>
+            void insert(uint bucket, F fingerprint)
+            {
+                uint other = otherBucket<F>(bucket, fingerprint);
+                if (placeInBucket<F>(bucket, fingerprint) || placeInBucket<F>(other, fingerprint)) return;
+
+                if (nextRandom() & 1) bucket = other;
+                for (uint kick = 0; kick < MAX_KICKS; kick++)
+                {
+                    uint slot = nextRandom() % SLOTS;
+                    F evicted = getSlot<F>(bucket, slot);
+                    setSlot<F>(bucket, slot, fingerprint);
+                    fingerprint = evicted;
+                    bucket = otherBucket<F>(bucket, fingerprint);
+                    if (placeInBucket<F>(bucket, fingerprint)) return;
+                }
+
+                m_hasVictim = true;
+                m_victimBucket = bucket;
+                m_victim = fingerprint;
+            }
+
+            template<typename F>
+            bool addHash(uint64_t hash)
+            {
+                if (m_hasVictim) return false;
+                insert<F>((uint)hash & m_bucketMask, Fingerprint<F>(hash));
+                m_size++;
+                return true;
+            }
+
+            template<typename F>
+            bool containsHash(uint64_t hash) const
+            {
+                F fingerprint = Fingerprint<F>(hash);
+                uint bucket = (uint)hash & m_bucketMask;
+                uint other = otherBucket<F>(bucket, fingerprint);
+                if (m_hasVictim && m_victim == fingerprint && (m_victimBucket == bucket || m_victimBucket == other)) return true;
+                return bucketHas<F>(bucket, fingerprint) || bucketHas<F>(other, fingerprint);
+            }
+
+            template<typename F>
+            bool removeHash(uint64_t hash)
+            {
+                F fingerprint = Fingerprint<F>(hash);
+                uint bucket = (uint)hash & m_bucketMask;
+                uint other = otherBucket<F>(bucket, fingerprint);
+                if (m_hasVictim && m_victim == fingerprint && (m_victimBucket == bucket || m_victimBucket == other))
+                {
+                    m_hasVictim = false;
+                    m_size--;
+                    return true;
+                }
+
+                for (uint b : { bucket, other })
+                {
+                    for (uint slot = 0; slot < SLOTS; slot++)
+                    {
+                        if (getSlot<F>(b, slot) != fingerprint) continue;
+                        setSlot<F>(b, slot, 0);
+                        m_size--;
+
+                        // A slot is free again, so the victim may fit now.
+                        if (m_hasVictim)
+                        {
+                            m_hasVictim = false;
+                            insert<F>(m_victimBucket, (F)m_victim);
+                        }
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void prefetchGroup(const T* keys, uint group, uint64_t* hashes) const
+            {
+                for (uint i = 0; i < group; i++)
+                {
+                    hashes[i] = Hash(keys[i]);
+                    uint bucket = (uint)hashes[i] & m_bucketMask;
+                    Detail::Prefetch(m_table.data() + (size_t)bucket * SLOTS * m_fingerprintBytes);
+                    uint32_t fingerprint = (uint32_t)(hashes[i] >> 32) & (uint32_t)(~(uint64_t)0 >> (64 - 8 * m_fingerprintBytes));
+                    Detail::Prefetch(m_table.data() + (size_t)otherBucket<uint32_t>(bucket, fingerprint == 0 ? 1 : fingerprint) * SLOTS * m_fingerprintBytes);
+                }
+            }
+        };
+
+        /*
+            @brief A class to represent a priority queue, known as std::priority_queue in C++ and a PriorityQueue in Java.
+            The elements are kept in a d-ary heap in one contiguous array: with the default arity of 4,
+            the heap is half as deep as a binary heap and the children of a node share a cache line,
+            which makes pops faster while pushes stay cheap.
+         *  The top is the element that goes first according to the comparator, so the smallest element with the default.
+            @param Cmp A function object taking two elements and returning true if the first goes before the second.
+            @param Arity The number of children of each node, at least 2.
+            @param A The allocator to allocate the elements with.
+         */
+        template<typename T, typename Cmp = Less<T>, uint Arity = 4, typename A = Memory::HeapAllocator<T>>
+        class PriorityQueue
+        {
+            static_assert(Arity >= 2, "Sapphire: DSA::PriorityQueue --> the arity must be at least 2");
+
+        public:
+            /*
+                @brief Creates an empty priority queue.
+                @param cmp The comparator to use.
+                @param alloc The allocator to use.
+             */
+            PriorityQueue(Cmp cmp = Cmp(), const A& alloc = A()) : m_heap(alloc), m_cmp(cmp) {}
+
+            /*
+                @brief Creates a priority queue from an array, building the heap bottom-up.
+                Runtime complexity: O(n)
+                @param arr The array to copy.
+                @param size The size of the array.
+                @param cmp The comparator to use.
+                @param alloc The allocator to use.
              */
-            int linearSearch(T elem)
+            PriorityQueue(const T* arr, uint size, Cmp cmp = Cmp(), const A& alloc = A()) : PriorityQueue(cmp, alloc)
             {
-                return LinearSearch(m_arr, m_size, elem);
+                m_heap.reserve(size);
+                for (uint i = 0; i < size; i++) m_heap.add(arr[i]);
+                heapify();
             }
 
             /*
-                @brief Searches an array for a given element using binary search.
-                Only works for sorted arrays.
-             !  Will throw an error if the value type in the array is not comparable.
+                @brief Creates a priority queue from an array list, building the heap bottom-up in the array list's storage.
+                Move the array list in to avoid copying it.
+                Runtime complexity: O(n)
+                @param list The array list to take the elements from.
+                @param cmp The comparator to use.
+             */
+            PriorityQueue(ArrayList<T, A> list, Cmp cmp = Cmp()) : m_heap(std::move(list)), m_cmp(cmp)
+            {
+                heapify();
+            }
+
+            /*
+                @brief Adds an element to the priority queue.
                 Runtime complexity: O(log n)
-                @param elem The element to search for.
-                @return The index of the element in the array, or -1 if the element is not found.
+                @param elem The element to add.
              */
-            int binarySearch(T elem)
+            void push(const T& elem)
             {
-                return BinarySearch(m_arr, m_size, elem);
+                m_heap.add(elem);
+                T tmp = std::move(m_heap.data()[m_heap.size() - 1]);
+                siftUp(m_heap.size() - 1, std::move(tmp));
             }
 
             /*
-                @brief Searches an array for a given element using interpolation search.
-                Only works for sorted arrays, ideal for uniformly distributed arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(log log n), worst case O(n)
-                @param elem The element to search for.
-                @return The index of the element in the array, or -1 if the element is not found.
+                @brief Adds an element to the priority queue.
+                Runtime complexity: O(log n)
+                @param elem The element to add.
              */
-            int interpolationSearch(T elem)
+            void push(T&& elem)
             {
-                return InterpolationSearch(m_arr, m_size, elem);
+                m_heap.add(std::move(elem));
+                T tmp = std::move(m_heap.data()[m_heap.size() - 1]);
+                siftUp(m_heap.size() - 1, std::move(tmp));
             }
 
             /*
-                @brief Checks if an array contains a given element.
-                Uses linear search.
-                @param elem The element to search for.
-                @return True if the element is found, false otherwise.
+                @brief Constructs an element in the priority queue.
+                Runtime complexity: O(log n)
+                @param args The arguments to construct the element with.
              */
-            bool contains(T elem)
+            template<typename... Args>
+            void emplace(Args&&... args)
             {
-                return linearSearch(elem) != -1;
+                push(T(std::forward<Args>(args)...));
             }
 
             /*
-                @brief Sorts an array using the bubble sort algorithm.
-             
-             !  Will throw an error if the value type in the array is not comparable.!  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n^2)
+                @brief Gets the element that goes first.
+             !  Throws std::runtime_error if the priority queue is empty.
+                @return The top element.
              */
-            void bubbleSort()
+            const T& top() const
             {
-                BubbleSort(m_arr, m_size);
+                if (m_heap.size() == 0)
+                {
+                    Sapphire::Err("DSA::PriorityQueue --> cannot get the top of an empty priority queue");
+                    throw std::runtime_error("Sapphire: DSA::PriorityQueue --> cannot get the top of an empty priority queue");
+                }
+                return m_heap.data()[0];
             }
 
             /*
-                @brief Sorts an array using the selection sort algorithm.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n^2)
+                @brief Removes the element that goes first and returns it.
+             !  Throws std::runtime_error if the priority queue is empty.
+                Runtime complexity: O(log n)
+                @return The removed element.
              */
-            void selectionSort()
+            T pop()
             {
-                SelectionSort(m_arr, m_size);
+                if (m_heap.size() == 0)
+                {
+                    Sapphire::Err("DSA::PriorityQueue --> cannot pop from an empty priority queue");
+                    throw std::runtime_error("Sapphire: DSA::PriorityQueue --> cannot pop from an empty priority queue");
+                }
+
+                T result = std::move(m_heap.data()[0]);
+                T last = m_heap.pop();
+                if (m_heap.size() > 0) siftUp(siftHoleToLeaf(0), std::move(last));
+                return result;
+            }
+
+            /*
+                @brief Adds an element, then removes the element that goes first and returns it, in one sift.
+                Faster than push() followed by pop(), and returns the given element right away if it goes first.
+                Runtime complexity: O(log n)
+                @param elem The element to add.
+                @return The removed element.
+             */
+            T pushPop(T elem)
+            {
+                if (m_heap.size() == 0 || !m_cmp(m_heap.data()[0], elem)) return elem;
+
+                T result = std::move(m_heap.data()[0]);
+                siftDown(0, std::move(elem));
+                return result;
             }
 
             /*
-                @brief Sorts an array using the merge sort algorithm.
-                Ideal for larger arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n log n)
-                Space complexity: O(n)
+                @brief Reserves memory for a number of elements, so adding them does not reallocate.
+                @param cap The number of elements to reserve memory for.
              */
-            void mergeSort()
+            void reserve(uint cap)
             {
-                MergeSort(m_arr, m_size);
+                m_heap.reserve(cap);
             }
 
             /*
-                @brief Sorts an array using the quick sort algorithm.
-                Ideal for smaller arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n log n)
-                Space complexity: O(log n)
+                @brief Removes all elements from the priority queue.
              */
-            void quickSort()
+            void clear()
             {
-                QuickSort(m_arr, m_size);
+                m_heap.clear();
             }
 
             /*
-                @brief Returns the size of the array.
-                @return The number of elements in the array.
+                @brief Returns the number of elements in the priority queue.
+                @return The number of elements.
              */
-            uint size()
+            uint size() const
             {
-                return m_size;
+                return m_heap.size();
             }
 
             /*
-                @brief Returns the underlying array/pointer.
-                @return The array data.
+                @brief Gets the elements in heap order.
+                @return A pointer to the elements.
              */
-            T* data()
+            const T* data() const
             {
-                return m_arr;
+                return m_heap.data();
             }
 
-            T& operator[](int index)
-            {
-                if (index < 0 || index >= m_size)
-                {
-                    Sapphire::Err("DSA::Array --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
-                    throw std::runtime_error("Sapphire: DSA::Array --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
-                }
-                return m_arr[index];
-            }
+        private:
+            ArrayList<T, A> m_heap;
+            Cmp m_cmp;
 
-            Array<T>& operator=(const Array<T>& other)
+            void heapify()
             {
-                if (m_arr != nullptr) delete[] m_arr;
-                m_arr = new T[other.m_size];
-                m_size = other.m_size;
-                for (int i = 0; i < m_size; i++)
+                uint size = m_heap.size();
+                if (size < 2) return;
+                for (uint i = (size - 2) / Arity + 1; i-- > 0; )
                 {
-                    m_arr[i] = other.m_arr[i];
+                    T tmp = std::move(m_heap.data()[i]);
+                    siftDown(i, std::move(tmp));
                 }
-                return *this;
             }
 
-            friend bool operator==(const Array<T>& arr1, const Array<T>& arr2)
+            // Both sifts move a hole instead of swapping, and fill it with the element at the end.
+            void siftUp(uint i, T elem)
             {
-                if (arr1.m_size != arr2.m_size) return false;
-                for (int i = 0; i < arr1.m_size; i++)
+                T* heap = m_heap.data();
+                while (i > 0)
                 {
-                    if (arr1.m_arr[i] != arr2.m_arr[i]) return false;
+                    uint parent = (i - 1) / Arity;
+                    if (!m_cmp(elem, heap[parent])) break;
+                    heap[i] = std::move(heap[parent]);
+                    i = parent;
                 }
-                return true;
+                heap[i] = std::move(elem);
             }
 
-            friend bool operator!=(const Array<T>& arr1, const Array<T>& arr2)
-            {
-                return !(arr1 == arr2);
-            }
-            
-            class Iterator
+            uint bestChild(const T* heap, uint first, uint size) const
             {
-            public:
-                using iterator_category = std::forward_iterator_tag;
-                using difference_type = std::ptrdiff_t;
-                using value_type = T;
-                using pointer = T*;
-                using reference = T&;
-
-                Iterator(pointer ptr) : m_ptr(ptr) {}
-                
-                reference operator*() const 
-                { 
-                    return *m_ptr; 
-                }
-                
-                pointer operator->() 
+                uint best = first;
+                uint last = first + Arity <= size ? first + Arity : size;
+                // Only arithmetic values are copied, so move-only types compile the plain loop alone.
+                if constexpr (std::is_arithmetic_v<T>)
                 {
-                    return m_ptr; 
+                    if ((size_t)size * sizeof(T) <= Detail::BRANCHLESS_HEAP_MAX_BYTES)
+                    {
+                        // Keeping the best value in a register lets the comparisons run as conditional moves
+                        // without waiting on a load of the previous winner.
+                        T bestValue = heap[first];
+                        for (uint child = first + 1; child < last; child++)
+                        {
+                            bool better = m_cmp(heap[child], bestValue);
+                            bestValue = better ? heap[child] : bestValue;
+                            best = better ? child : best;
+                        }
+                        return best;
+                    }
                 }
 
-                Iterator& operator++() 
+                for (uint child = first + 1; child < last; child++)
                 {
-                    m_ptr++; return *this;
+                    if (m_cmp(heap[child], heap[best])) best = child;
                 }
+                return best;
+            }
 
-                Iterator operator++(int) 
+            /*
+                @brief Moves the hole at i down to a leaf, always filling it with its first child.
+                The last element of a heap almost always belongs near the bottom, so sifting the hole down without
+                comparing against it, then sifting the element up from the leaf, saves a comparison per level on pops.
+                @return The position of the hole.
+             */
+            uint siftHoleToLeaf(uint i)
+            {
+                T* heap = m_heap.data();
+                uint size = m_heap.size();
+                while (true)
                 {
-                    Iterator tmp = *this; ++(*this); return tmp; 
-                }
+                    size_t first = (size_t)i * Arity + 1;
+                    if (first >= size) return i;
 
-                friend bool operator==(const Iterator& it1, const Iterator& it2) 
-                { 
-                    return it1.m_ptr == it2.m_ptr; 
-                };
+                    uint best = bestChild(heap, (uint)first, size);
+                    heap[i] = std::move(heap[best]);
+                    i = best;
+                }
+            }
 
-                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
+            void siftDown(uint i, T elem)
+            {
+                T* heap = m_heap.data();
+                uint size = m_heap.size();
+                while (true)
                 {
-                    return it1.m_ptr != it2.m_ptr; 
-                };
-
-            private:
-                pointer m_ptr;
-            };
+                    size_t first = (size_t)i * Arity + 1;
+                    if (first >= size) break;
 
-            Iterator begin() 
-            {
-                return Iterator(m_arr); 
-            }
+                    uint best = bestChild(heap, (uint)first, size);
+                    if (!m_cmp(heap[best], elem)) break;
 
-            Iterator end() 
-            {
-                return Iterator(m_arr + m_size); 
+                    heap[i] = std::move(heap[best]);
+                    i = best;
+                }
+                heap[i] = std::move(elem);
             }
-
-        private:
-            T* m_arr;
-            uint m_size;
         };
 
         /*
-            @brief A class to represent a dynamic array, known as std::vector in C++ and ArrayList in Java and some other languages.
+            @brief A priority queue of integer ids, each with a key that can be changed while it is queued.
+            Ideal for Dijkstra's and Prim's algorithms, where the ids are vertices and the keys their distances.
+            Each id's position in the heap is tracked, so decreaseKey(), update() and erase() take O(log n) instead of a search.
+            The keys are stored next to their ids in a d-ary heap, so sifting never follows a pointer.
+         *  The top is the id whose key goes first according to the comparator, so the smallest key with the default.
+         *  Memory for positions grows with the largest id used, so ids should be small and dense, like vertex indices.
+            @param Cmp A function object taking two keys and returning true if the first goes before the second.
+            @param Arity The number of children of each node, at least 2.
+            @param A The allocator to allocate the keys with, which is rebound for the heap and the positions.
          */
-        template<typename T>
-        class ArrayList
+        template<typename T, typename Cmp = Less<T>, uint Arity = 4, typename A = Memory::HeapAllocator<T>>
+        class IndexedPriorityQueue
         {
-        public:
-            /*
-                @brief Creates an empty array list.
-             */
-            ArrayList()
+            static_assert(Arity >= 2, "Sapphire: DSA::IndexedPriorityQueue --> the arity must be at least 2");
+
+            struct Entry
             {
-                m_cap = 10;
-                m_arr = new T[m_cap];
-                m_size = 0;
-            }
+                T key;
+                uint id;
+            };
 
+            using EntryAllocator = typename std::allocator_traits<A>::template rebind_alloc<Entry>;
+            using IndexAllocator = typename std::allocator_traits<A>::template rebind_alloc<uint>;
+
+        public:
             /*
-                @brief Creates an array list of a given size.
-                @param size The size of the array list.
+                @brief Creates an empty indexed priority queue.
+                @param idCount The number of ids to make room for, ids from 0 to idCount - 1.
+                Larger ids can still be pushed, the positions grow as needed.
+                0 by default.
+                @param cmp The comparator to use.
+                @param alloc The allocator to use.
              */
-            ArrayList(uint size)
+            IndexedPriorityQueue(uint idCount = 0, Cmp cmp = Cmp(), const A& alloc = A()) : m_heap(EntryAllocator(alloc)), m_positions(IndexAllocator(alloc)), m_cmp(cmp)
             {
-                m_cap = Max((uint)(size * 1.5), (uint)10);
-                m_arr = new T[m_cap];
-                m_size = size;
+                m_heap.reserve(idCount);
+                growPositions(idCount);
             }
 
             /*
-                @brief Creates an array list from a given array.
-                @param size The size of the array list.
-                @param arr The array to copy.
+                @brief Adds an id with a key.
+             !  Throws std::invalid_argument if the id is already queued.
+                Runtime complexity: O(log n)
+                @param id The id to add.
+                @param key The key of the id.
              */
-            ArrayList(T* arr, uint size)
+            void push(uint id, T key)
             {
-                m_cap = Max((uint)(size * 1.5), (uint)10);
-                m_arr = new T[m_cap];
-                m_size = size;
-                for (int i = 0; i < size; i++)
+                if (contains(id))
                 {
-                    m_arr[i] = arr[i];
+                    Sapphire::Err("DSA::IndexedPriorityQueue --> id " + std::to_string(id) + " is already queued");
+                    throw std::invalid_argument("Sapphire: DSA::IndexedPriorityQueue --> id " + std::to_string(id) + " is already queued");
                 }
+
+                if (id >= m_positions.size()) growPositions(Max(id + 1, m_positions.size() * 2));
+                m_heap.add(Entry{ std::move(key), id });
+                Entry tmp = std::move(m_heap.data()[m_heap.size() - 1]);
+                siftUp(m_heap.size() - 1, std::move(tmp));
             }
 
             /*
-                @brief Creates an array list from a given array list object.
-                @param arr The array list to copy.
+                @brief Checks if an id is queued.
+                Runtime complexity: O(1)
+                @param id The id to check.
+                @return True if the id is queued, false otherwise.
              */
-            ArrayList(const ArrayList<T>& arr)
+            bool contains(uint id) const
             {
-                m_cap = arr.m_cap;
-                m_arr = new T[arr.m_cap];
-                m_size = arr.m_size;
-                for (int i = 0; i < m_size; i++)
-                {
-                    m_arr[i] = arr.m_arr[i];
-                }
+                return id < m_positions.size() && m_positions.data()[id] != NONE;
             }
 
             /*
-                @brief Creates an array list from a given initializer list.
-                @param list The initializer list to copy.
+                @brief Gets the key of a queued id.
+             !  Throws std::runtime_error if the id is not queued.
+                Runtime complexity: O(1)
+                @param id The id.
+                @return The key of the id.
              */
-            ArrayList(std::initializer_list<T> list)
+            const T& keyOf(uint id) const
             {
-                m_cap = Max((uint)(list.size() * 1.5), (uint)10);
-                m_arr = new T[m_cap];
-                m_size = list.size();
-                int i = 0;
-                for (T elem : list)
-                {
-                    m_arr[i] = elem;
-                    i++;
-                }
+                return m_heap.data()[positionOf(id)].key;
             }
 
             /*
-                @brief Destroys the array list object and frees the memory.
+                @brief Gives a queued id a key that does not go after its current one, moving it towards the top.
+             !  Throws std::runtime_error if the id is not queued.
+             !  Throws std::invalid_argument if the new key goes after the current one. Use update() for that.
+                Runtime complexity: O(log n)
+                @param id The id.
+                @param key The new key.
              */
-            ~ArrayList()
+            void decreaseKey(uint id, T key)
             {
-                if (m_arr != nullptr) delete[] m_arr;
+                uint pos = positionOf(id);
+                Entry* heap = m_heap.data();
+                if (m_cmp(heap[pos].key, key))
+                {
+                    Sapphire::Err("DSA::IndexedPriorityQueue --> decreaseKey() got a key that goes after the current key of id " + std::to_string(id));
+                    throw std::invalid_argument("Sapphire: DSA::IndexedPriorityQueue --> decreaseKey() got a key that goes after the current key of id " + std::to_string(id));
+                }
+                siftUp(pos, Entry{ std::move(key), id });
             }
 
             /*
-                @brief Searches an array list for a given element using linear search.
-                Works for all arrays, ideal for unsorted arrays.
-                Runtime complexity: O(n)
-                @param elem The element to search for.
-                @return The index of the element in the array list, or -1 if the element is not found.
+                @brief Gives a queued id a new key, moving it up or down as needed.
+             !  Throws std::runtime_error if the id is not queued.
+                Runtime complexity: O(log n)
+                @param id The id.
+                @param key The new key.
              */
-            int linearSearch(T elem)
+            void update(uint id, T key)
             {
-                return LinearSearch(m_arr, m_size, elem);
+                uint pos = positionOf(id);
+                Entry* heap = m_heap.data();
+                if (m_cmp(heap[pos].key, key)) siftDown(pos, Entry{ std::move(key), id });
+                else siftUp(pos, Entry{ std::move(key), id });
             }
 
             /*
-                @brief Searches an array list for a given element using binary search.
-                Only works for sorted arrays.
-             !  Will throw an error if the value type in the array is not comparable.
+                @brief Removes a queued id.
                 Runtime complexity: O(log n)
-                @param elem The element to search for.
-                @return The index of the element in the array list, or -1 if the element is not found.
+                @param id The id to remove.
+                @return True if the id was removed, false if it was not queued.
              */
-            int binarySearch(T elem)
+            bool erase(uint id)
             {
-                return BinarySearch(m_arr, m_size, elem);
-            }
+                if (!contains(id)) return false;
+
+                uint pos = m_positions.data()[id];
+                m_positions.data()[id] = NONE;
+                Entry last = m_heap.pop();
+                if (pos == m_heap.size()) return true;
 
+                // The last entry fills the hole, and may belong above or below it.
+                if (pos > 0 && m_cmp(last.key, m_heap.data()[(pos - 1) / Arity].key)) siftUp(pos, std::move(last));
+                else siftDown(pos, std::move(last));
+                return true;
+            }
 
             /*
-                @brief Searches an array list for a given element using interpolation search.
-                Only works for sorted arrays, ideal for uniformly distributed arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(log log n), worst case O(n)
-                @param elem The element to search for.
-                @return The index of the element in the array list, or -1 if the element is not found.
+                @brief Gets the id whose key goes first.
+             !  Throws std::runtime_error if the indexed priority queue is empty.
+                @return The top id.
              */
-            int interpolationSearch(T elem)
+            uint topId() const
             {
-                return InterpolationSearch(m_arr, m_size, elem);
+                return topEntry().id;
             }
 
-
             /*
-                @brief Checks if an array list contains a given element.
-                Uses linear search.
-             !  Will throw an error if the value type in the array is not comparable.
-                @param elem The element to search for.
-                @return True if the element is found, false otherwise.
+                @brief Gets the key that goes first.
+             !  Throws std::runtime_error if the indexed priority queue is empty.
+                @return The top key.
              */
-            int contains(T elem)
+            const T& topKey() const
             {
-                return linearSearch(elem) != -1;
+                return topEntry().key;
             }
 
             /*
-                @brief Sorts an array list using the bubble sort algorithm.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n^2)
+                @brief Removes the id whose key goes first and returns it with its key.
+             !  Throws std::runtime_error if the indexed priority queue is empty.
+                Runtime complexity: O(log n)
+                @return The removed id and its key.
              */
-            void bubbleSort()
+            Pair<uint, T> pop()
             {
-                BubbleSort(m_arr, m_size);
+                uint id = topEntry().id;
+                Pair<uint, T> result(id, std::move(m_heap.data()[0].key));
+                m_positions.data()[id] = NONE;
+                Entry last = m_heap.pop();
+                if (m_heap.size() > 0) siftDown(0, std::move(last));
+                return result;
             }
 
             /*
-                @brief Sorts an array list using the selection sort algorithm.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n^2)
+                @brief Removes all ids from the indexed priority queue.
+                Keeps the memory for positions, so the same ids can be queued again without allocating.
              */
-            void selectionSort()
+            void clear()
             {
-                SelectionSort(m_arr, m_size);
+                Entry* heap = m_heap.data();
+                uint* positions = m_positions.data();
+                for (uint i = 0; i < m_heap.size(); i++) positions[heap[i].id] = NONE;
+                m_heap.clear();
             }
 
             /*
-                @brief Sorts an array list using the merge sort algorithm.
-                Ideal for larger arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n log n)
-                Space complexity: O(n)
+                @brief Returns the number of queued ids.
+                @return The number of queued ids.
              */
-            void mergeSort()
+            uint size() const
             {
-                MergeSort(m_arr, m_size);
+                return m_heap.size();
             }
 
-            /*
-                @brief Sorts an array list using the quick sort algorithm.
-                Ideal for smaller arrays.
-             !  Will throw an error if the value type in the array is not comparable.
-                Runtime complexity: O(n log n)
-                Space complexity: O(log n)
-             */
-            void quickSort()
+        private:
+            static constexpr uint NONE = (uint)-1;
+
+            ArrayList<Entry, EntryAllocator> m_heap;
+            ArrayList<uint, IndexAllocator> m_positions;
+            Cmp m_cmp;
+
+            void growPositions(uint count)
             {
-                QuickSort(m_arr, m_size);
+                m_positions.reserve(count);
+                while (m_positions.size() < count) m_positions.add(NONE);
             }
 
-            /*
-                @brief Returns the size of the array list.
-                @return The number of elements in the array list.
-             */
-            uint size()
+            uint positionOf(uint id) const
             {
-                return m_size;
+                if (!contains(id))
+                {
+                    Sapphire::Err("DSA::IndexedPriorityQueue --> id " + std::to_string(id) + " is not queued");
+                    throw std::runtime_error("Sapphire: DSA::IndexedPriorityQueue --> id " + std::to_string(id) + " is not queued");
+                }
+                return m_positions.data()[id];
             }
 
-            /*
-                @brief Adds an element to the end of the array list.
-                @param elem The element to add.
-             */
-            void add(T elem)
+            const Entry& topEntry() const
             {
-                if (m_size + 1 > m_cap)
+                if (m_heap.size() == 0)
                 {
-                    m_cap *= 1.5;
+                    Sapphire::Err("DSA::IndexedPriorityQueue --> the indexed priority queue is empty");
+                    throw std::runtime_error("Sapphire: DSA::IndexedPriorityQueue --> the indexed priority queue is empty");
+                }
+                return m_heap.data()[0];
+            }
 
-                    T* tmp = new T[m_size];
-                    for (int i = 0; i < m_size; i++)
+            uint bestChild(const Entry* heap, uint first, uint size) const
+            {
+                uint best = first;
+                uint last = first + Arity <= size ? first + Arity : size;
+                if constexpr (std::is_arithmetic_v<T>)
+                {
+                    if ((size_t)size * sizeof(Entry) <= Detail::BRANCHLESS_HEAP_MAX_BYTES)
                     {
-                        tmp[i] = m_arr[i];
+                        T bestKey = heap[first].key;
+                        for (uint child = first + 1; child < last; child++)
+                        {
+                            bool better = m_cmp(heap[child].key, bestKey);
+                            bestKey = better ? heap[child].key : bestKey;
+                            best = better ? child : best;
+                        }
+                        return best;
                     }
+                }
 
-                    delete[] m_arr;
-                    m_arr = new T[m_cap];
-                    for (int i = 0; i < m_size; i++)
-                    {
-                        m_arr[i] = tmp[i];
-                    }
+                for (uint child = first + 1; child < last; child++)
+                {
+                    if (m_cmp(heap[child].key, heap[best].key)) best = child;
+                }
+                return best;
+            }
 
-                    delete[] tmp;
+            // Like PriorityQueue's sifts, but every entry that moves also records its new position.
+            void siftUp(uint i, Entry entry)
+            {
+                Entry* heap = m_heap.data();
+                uint* positions = m_positions.data();
+                while (i > 0)
+                {
+                    uint parent = (i - 1) / Arity;
+                    if (!m_cmp(entry.key, heap[parent].key)) break;
+                    heap[i] = std::move(heap[parent]);
+                    positions[heap[i].id] = i;
+                    i = parent;
                 }
+                positions[entry.id] = i;
+                heap[i] = std::move(entry);
+            }
 
-                m_size++;
-                m_arr[m_size - 1] = elem;
+            void siftDown(uint i, Entry entry)
+            {
+                Entry* heap = m_heap.data();
+                uint* positions = m_positions.data();
+                uint size = m_heap.size();
+                while (true)
+                {
+                    size_t first = (size_t)i * Arity + 1;
+                    if (first >= size) break;
+
+                    uint best = bestChild(heap, (uint)first, size);
+                    if (!m_cmp(heap[best].key, entry.key)) break;
+
+                    heap[i] = std::move(heap[best]);
+                    positions[heap[i].id] = i;
+                    i = best;
+                }
+                positions[entry.id] = i;
+                heap[i] = std::move(entry);
             }
+        };
 
+        /*
+            @brief A bounded queue for handing elements from one producer thread to one consumer thread without locks.
+            The elements live in a ring buffer whose capacity is a power of two, and the producer and consumer
+            each own one index on a cache line of its own, so they only touch each other's line when the queue
+            looks full or empty.
+         !  Only one thread may push and only one thread may pop at a time.
+            @param A The allocator to allocate the ring buffer with.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class SpscQueue
+        {
+        public:
             /*
-                @brief Inserts an element at a given index in the array list.
-                @param elem The element to insert.
-                @param index The index to insert the element at.
+                @brief Creates an empty queue.
+             !  Throws std::invalid_argument if the capacity is 0.
+                @param capacity The number of elements the queue can hold, rounded up to a power of two.
+                @param alloc The allocator to use.
              */
-            void insert(T elem, int index)
+            SpscQueue(uint capacity, const A& alloc = A()) : m_alloc(alloc)
             {
-                T* tmp = new T[m_size];
-                for (int i = 0; i < m_size; i++)
+                if (capacity == 0)
                 {
-                    tmp[i] = m_arr[i];
+                    Sapphire::Err("DSA::SpscQueue --> the capacity must be at least 1");
+                    throw std::invalid_argument("Sapphire: DSA::SpscQueue --> the capacity must be at least 1");
                 }
 
-                m_size++;
-                if (m_size > m_cap) m_cap *= 1.5;
+                size_t cap = 1;
+                while (cap < capacity) cap <<= 1;
+                m_slots = std::allocator_traits<A>::allocate(m_alloc, cap);
+                m_mask = cap - 1;
+                m_head.store(0, std::memory_order_relaxed);
+                m_tail.store(0, std::memory_order_relaxed);
+                m_cachedHead = 0;
+                m_cachedTail = 0;
+            }
 
-                delete[] m_arr;
-                m_arr = new T[m_cap];
+            SpscQueue(const SpscQueue<T, A>&) = delete;
+            SpscQueue<T, A>& operator=(const SpscQueue<T, A>&) = delete;
 
-                for (int i = 0; i < m_size; i++)
+            /*
+                @brief Destroys the queue and the elements still in it.
+             !  Must not be called while other threads are still using the queue.
+             */
+            ~SpscQueue()
+            {
+                size_t tail = m_tail.load(std::memory_order_acquire);
+                for (size_t i = m_head.load(std::memory_order_relaxed); i != tail; i++)
                 {
-                    if (i < index) m_arr[i] = tmp[i];
-                    else if (i == index) m_arr[i] = elem;
-                    else m_arr[i] = tmp[i - 1];
+                    m_slots[i & m_mask].~T();
                 }
+                std::allocator_traits<A>::deallocate(m_alloc, m_slots, m_mask + 1);
+            }
 
-                delete[] tmp;
+            /*
+                @brief Adds an element at the back of the queue, if there is room.
+                Runtime complexity: O(1)
+                @param elem The element to add.
+                @return True if the element was added, false if the queue is full.
+             */
+            bool tryPush(const T& elem)
+            {
+                return tryEmplace(elem);
             }
 
             /*
-                @brief Removes an element at a given index in the array list.
-                @param index The index to remove the element at.
+                @brief Moves an element to the back of the queue, if there is room.
+                The element is left untouched if the queue is full.
+                Runtime complexity: O(1)
+                @param elem The element to add.
+                @return True if the element was added, false if the queue is full.
              */
-            void remove(int index)
+            bool tryPush(T&& elem)
+            {
+                return tryEmplace(std::move(elem));
+            }
+
+            /*
+                @brief Constructs an element in place at the back of the queue, if there is room.
+                Runtime complexity: O(1)
+                @param args The arguments to construct the element with.
+                @return True if the element was added, false if the queue is full.
+             */
+            template<typename... Args>
+            bool tryEmplace(Args&&... args)
+            {
+                size_t tail = m_tail.load(std::memory_order_relaxed);
+                if (tail - m_cachedHead > m_mask)
+                {
+                    m_cachedHead = m_head.load(std::memory_order_acquire);
+                    if (tail - m_cachedHead > m_mask) return false;
+                }
+
+                new (m_slots + (tail & m_mask)) T(std::forward<Args>(args)...);
+                m_tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            /*
+                @brief Adds as many elements of an array as there is room for, publishing them to the consumer at once.
+                If copying an element throws, the elements copied before it stay in the queue.
+                Runtime complexity: O(n)
+                @param elems The elements to add, in order.
+                @param count The number of elements.
+                @return The number of elements added, from the start of the array.
+             */
+            uint tryPushN(const T* elems, uint count)
             {
-                T* tmp = new T[m_size];
-                for (int i = 0; i < m_size; i++)
+                size_t tail = m_tail.load(std::memory_order_relaxed);
+                size_t room = m_mask + 1 - (tail - m_cachedHead);
+                if (room < count)
                 {
-                    tmp[i] = m_arr[i];
+                    m_cachedHead = m_head.load(std::memory_order_acquire);
+                    room = m_mask + 1 - (tail - m_cachedHead);
                 }
+                uint n = room < count ? (uint)room : count;
 
-                m_size--;
-
-                delete[] m_arr;
-                m_arr = new T[m_cap];
-
-                for (int i = 0; i < m_size; i++)
+                if constexpr (std::is_trivially_copyable_v<T>)
                 {
-                    if (i < index) m_arr[i] = tmp[i];
-                    else m_arr[i] = tmp[i + 1];
+                    copyRing(elems, tail, n, true);
                 }
-
-                delete[] tmp;
+                else
+                {
+                    uint i = 0;
+                    try
+                    {
+                        for (; i < n; i++)
+                        {
+                            new (m_slots + ((tail + i) & m_mask)) T(elems[i]);
+                        }
+                    }
+                    catch (...)
+                    {
+                        m_tail.store(tail + i, std::memory_order_release);
+                        throw;
+                    }
+                }
+                m_tail.store(tail + n, std::memory_order_release);
+                return n;
             }
 
             /*
-                @brief Removes the last element in the array list.
-                @return The removed element.
+                @brief Removes the element at the front of the queue, if there is one.
+                Runtime complexity: O(1)
+                @param out Set to the removed element, left unchanged if the queue is empty.
+                @return True if an element was removed, false if the queue is empty.
              */
-            T pop()
+            bool tryPop(T& out)
             {
-                T elem = m_arr[m_size - 1];
-                remove(m_size - 1);
-                return elem;
+                size_t head = m_head.load(std::memory_order_relaxed);
+                if (head == m_cachedTail)
+                {
+                    m_cachedTail = m_tail.load(std::memory_order_acquire);
+                    if (head == m_cachedTail) return false;
+                }
+
+                T* slot = m_slots + (head & m_mask);
+                out = std::move(*slot);
+                slot->~T();
+                m_head.store(head + 1, std::memory_order_release);
+                return true;
             }
 
             /*
-                @brief Removes all occurrences of a given element in the array list.
-                @param elem The element to remove.
+                @brief Removes up to a number of elements from the front of the queue, freeing their room for the producer at once.
+                If moving an element out throws, the elements before it are removed and the rest stay in the queue.
+                Runtime complexity: O(n)
+                @param out The array to move the removed elements to, in order.
+                @param count The maximum number of elements to remove.
+                @return The number of elements removed.
              */
-            
-            void removeAll(T elem)
+            uint tryPopN(T* out, uint count)
             {
-                T* tmp = new T[m_size];
-                for (int i = 0; i < m_size; i++)
+                size_t head = m_head.load(std::memory_order_relaxed);
+                size_t available = m_cachedTail - head;
+                if (available < count)
                 {
-                    tmp[i] = m_arr[i];
+                    m_cachedTail = m_tail.load(std::memory_order_acquire);
+                    available = m_cachedTail - head;
                 }
+                uint n = available < count ? (uint)available : count;
 
-                delete[] m_arr;
-                m_arr = new T[m_cap];
-
-                int ogSize = m_size;
-
-                for (int i = 0; i < ogSize; i++)
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    copyRing(out, head, n, false);
+                }
+                else
                 {
-                    if (tmp[i] == elem)
+                    uint i = 0;
+                    try
                     {
-                        m_size--;
-                        continue;
+                        for (; i < n; i++)
+                        {
+                            T* slot = m_slots + ((head + i) & m_mask);
+                            out[i] = std::move(*slot);
+                            slot->~T();
+                        }
+                    }
+                    catch (...)
+                    {
+                        m_head.store(head + i, std::memory_order_release);
+                        throw;
                     }
-                    
-                    m_arr[i - (ogSize - m_size)] = tmp[i];
                 }
-
-                delete[] tmp;
+                m_head.store(head + n, std::memory_order_release);
+                return n;
             }
 
             /*
-                @brief Returns the underlying array/pointer.
-                @return The array list data.
+                @brief Returns the number of elements in the queue.
+             *  Only exact if no other thread is using the queue.
+                @return The number of elements in the queue.
              */
-            T* data()
+            uint size() const
             {
-                return m_arr;
+                size_t head = m_head.load(std::memory_order_acquire);
+                size_t tail = m_tail.load(std::memory_order_acquire);
+                return tail - head > m_mask ? (tail < head ? 0 : m_mask + 1) : (uint)(tail - head);
             }
 
-            T& operator[](int index)
+            /*
+                @brief Checks if the queue is empty.
+             *  Only exact if no other thread is using the queue.
+                @return True if the queue is empty, false otherwise.
+             */
+            bool empty() const
             {
-                if (index < 0 || index >= m_size) 
-                {
-                    Sapphire::Err("DSA::ArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
-                    throw std::runtime_error("Sapphire: DSA::ArrayList --> array index " + std::to_string(index) + " is out of bounds (size: " + std::to_string(m_size) + ")");
-                }
-                return m_arr[index];
+                return size() == 0;
             }
 
-            ArrayList<T>& operator=(const ArrayList<T>& other)
+            /*
+                @brief Returns the number of elements the queue can hold.
+                @return The capacity, always a power of two.
+             */
+            uint capacity() const
             {
-                if (m_arr != nullptr) delete[] m_arr;
-                m_arr = new T[other.m_cap];
-                m_size = other.m_size;
-                m_cap = other.m_cap;
-                for (int i = 0; i < m_size; i++)
-                {
-                    m_arr[i] = other.m_arr[i];
-                }
-                return *this;
+                return (uint)(m_mask + 1);
             }
 
-            friend bool operator==(const ArrayList<T>& arr1, const ArrayList<T>& arr2)
+        private:
+            // Each index sits on its own cache line with the other side's index as its owner last saw it,
+            // so the owner can skip reading the other line until the cached value says the queue is full or empty.
+            alignas(64) std::atomic<size_t> m_tail;
+            size_t m_cachedHead;
+
+            alignas(64) std::atomic<size_t> m_head;
+            size_t m_cachedTail;
+
+            alignas(64) T* m_slots;
+            size_t m_mask;
+            [[no_unique_address]] A m_alloc;
+
+            // Copies n trivially copyable elements into (or out of) the ring starting at a position, in at most two pieces.
+            void copyRing(const T* arr, size_t position, uint n, bool into)
             {
-                if (arr1.m_size != arr2.m_size) return false;
-                for (int i = 0; i < arr1.m_size; i++)
+                size_t start = position & m_mask;
+                size_t first = m_mask + 1 - start < n ? m_mask + 1 - start : n;
+                if (into)
                 {
-                    if (arr1.m_arr[i] != arr2.m_arr[i]) return false;
+                    std::memcpy((void*)(m_slots + start), arr, first * sizeof(T));
+                    std::memcpy((void*)m_slots, arr + first, (n - first) * sizeof(T));
+                }
+                else
+                {
+                    std::memcpy((void*)arr, m_slots + start, first * sizeof(T));
+                    std::memcpy((void*)(arr + first), m_slots, (n - first) * sizeof(T));
                 }
-                return true;
             }
+        };
 
-            friend bool operator!=(const ArrayList<T>& arr1, const ArrayList<T>& arr2)
-            {
-                return !(arr1 == arr2);
-            }
+        /*
+            @brief A bounded queue that any number of threads can push to and pop from without locks.
+            Each slot of the ring buffer carries a sequence number that says whether it is free or full for a given lap,
+            so a thread claims a slot with a single compare-and-swap on the shared index and never waits on a lock
+            (Dmitry Vyukov's bounded MPMC queue). The batch operations claim a run of consecutive slots with one
+            compare-and-swap, which keeps contention on the indices low under heavy traffic.
+         *  A pop can report the queue as empty while a push that claimed an earlier slot is still writing its element.
+         !  Elements must be nothrow movable, because a claimed slot cannot be given back.
+            @param A The allocator to allocate the ring buffer with, which is rebound for the slots.
+         */
+        template<typename T, typename A = Memory::HeapAllocator<T>>
+        class MpmcQueue
+        {
+            static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>, "Sapphire: DSA::MpmcQueue --> the element type must be nothrow movable");
 
-            class Iterator
+            struct Slot
             {
-            public:
-                using iterator_category = std::forward_iterator_tag;
-                using difference_type = std::ptrdiff_t;
-                using value_type = T;
-                using pointer = T*;
-                using reference = T&;
+                std::atomic<size_t> sequence;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
 
-                Iterator(pointer ptr) : m_ptr(ptr) {}
-                
-                reference operator*() const 
-                { 
-                    return *m_ptr; 
-                }
-                
-                pointer operator->() 
-                {
-                    return m_ptr; 
-                }
+            using SlotAllocator = typename std::allocator_traits<A>::template rebind_alloc<Slot>;
 
-                Iterator& operator++() 
+        public:
+            /*
+                @brief Creates an empty queue.
+             !  Throws std::invalid_argument if the capacity is 0.
+                @param capacity The number of elements the queue can hold, rounded up to a power of two.
+                @param alloc The allocator to use.
+             */
+            MpmcQueue(uint capacity, const A& alloc = A()) : m_alloc(alloc)
+            {
+                if (capacity == 0)
                 {
-                    m_ptr++; return *this;
+                    Sapphire::Err("DSA::MpmcQueue --> the capacity must be at least 1");
+                    throw std::invalid_argument("Sapphire: DSA::MpmcQueue --> the capacity must be at least 1");
                 }
 
-                Iterator operator++(int) 
+                size_t cap = 1;
+                while (cap < capacity) cap <<= 1;
+                m_slots = std::allocator_traits<SlotAllocator>::allocate(m_alloc, cap);
+                m_mask = cap - 1;
+                for (size_t i = 0; i < cap; i++)
                 {
-                    Iterator tmp = *this; ++(*this); return tmp; 
+                    new (m_slots + i) Slot;
+                    m_slots[i].sequence.store(i, std::memory_order_relaxed);
                 }
-
-                friend bool operator==(const Iterator& it1, const Iterator& it2) 
-                { 
-                    return it1.m_ptr == it2.m_ptr; 
-                };
-
-                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
-                {
-                    return it1.m_ptr != it2.m_ptr; 
-                };
-
-            private:
-                pointer m_ptr;
-            };
-
-            Iterator begin() 
-            {
-                return Iterator(m_arr); 
-            }
-
-            Iterator end() 
-            {
-                return Iterator(m_arr + m_size); 
+                m_pushPos.store(0, std::memory_order_relaxed);
+                m_popPos.store(0, std::memory_order_relaxed);
             }
 
-        private:
-            uint m_cap;
-            T* m_arr;
-            uint m_size;
-        };
-
-        /*
-            @brief A class to represent a pair of values.
-         */
-        template<typename T1, typename T2>
-        struct Pair
-        {
-            T1 first;
-            T2 second;
+            MpmcQueue(const MpmcQueue<T, A>&) = delete;
+            MpmcQueue<T, A>& operator=(const MpmcQueue<T, A>&) = delete;
 
             /*
-                @brief Creates an empty pair (with garbage values).
+                @brief Destroys the queue and the elements still in it.
+             !  Must not be called while other threads are still using the queue.
              */
-            Pair() {}
+            ~MpmcQueue()
+            {
+                size_t end = m_pushPos.load(std::memory_order_acquire);
+                for (size_t i = m_popPos.load(std::memory_order_relaxed); i != end; i++)
+                {
+                    elementAt(i)->~T();
+                }
+                for (size_t i = 0; i <= m_mask; i++)
+                {
+                    m_slots[i].~Slot();
+                }
+                std::allocator_traits<SlotAllocator>::deallocate(m_alloc, m_slots, m_mask + 1);
+            }
 
             /*
-                @brief Creates a pair from two given values.
-                @param first The first value.
-                @param second The second value.
+                @brief Adds a copy of an element at the back of the queue, if there is room.
+                Runtime complexity: O(1) without contention
+                @param elem The element to add.
+                @return True if the element was added, false if the queue is full.
              */
-            Pair(T1 first, T2 second)
+            bool tryPush(const T& elem)
             {
-                this->first = first;
-                this->second = second;
+                if constexpr (std::is_nothrow_copy_constructible_v<T>) return pushOne(elem);
+                else
+                {
+                    // Copy before claiming a slot, so a throwing copy leaves the queue untouched.
+                    T copy(elem);
+                    return pushOne(std::move(copy));
+                }
             }
 
-            Pair<T1, T2>& operator=(const Pair<T1, T2>& other)
+            /*
+                @brief Moves an element to the back of the queue, if there is room.
+                The element is left untouched if the queue is full.
+                Runtime complexity: O(1) without contention
+                @param elem The element to add.
+                @return True if the element was added, false if the queue is full.
+             */
+            bool tryPush(T&& elem)
             {
-                first = other.first;
-                second = other.second;
-                return *this;
+                return pushOne(std::move(elem));
             }
 
-            friend bool operator==(const Pair<T1, T2>& pair1, const Pair<T1, T2>& pair2)
+            /*
+                @brief Adds as many elements of an array as there is room for.
+                The elements take consecutive slots claimed at once, so they stay together in the queue,
+                unless copying may throw, in which case they are pushed one at a time.
+                Runtime complexity: O(n) without contention
+                @param elems The elements to add, in order.
+                @param count The number of elements.
+                @return The number of elements added, from the start of the array.
+             */
+            uint tryPushN(const T* elems, uint count)
             {
-                return pair1.first == pair2.first && pair1.second == pair2.second;
+                if constexpr (std::is_nothrow_copy_constructible_v<T>)
+                {
+                    size_t first;
+                    size_t n = claim(m_pushPos, 0, count, first);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        new (elementAt(first + i)) T(elems[i]);
+                        m_slots[(first + i) & m_mask].sequence.store(first + i + 1, std::memory_order_release);
+                    }
+                    return (uint)n;
+                }
+                else
+                {
+                    uint i = 0;
+                    while (i < count && tryPush(elems[i])) i++;
+                    return i;
+                }
             }
 
-            friend bool operator!=(const Pair<T1, T2>& pair1, const Pair<T1, T2>& pair2)
+            /*
+                @brief Removes the element at the front of the queue, if there is one.
+                Runtime complexity: O(1) without contention
+                @param out Set to the removed element, left unchanged if the queue is empty.
+                @return True if an element was removed, false if the queue is empty.
+             */
+            bool tryPop(T& out)
             {
-                return !(pair1 == pair2);
+                return tryPopN(&out, 1) == 1;
             }
-        };
 
-        /*
-            @brief A class to represent a hash map, known as std::map in C++ and a HashMap in Java and some other languages.
-         */
-        template<typename K, typename V>
-        class HashMap
-        {
-        public:
             /*
-                @brief Creates an empty hash map.
+                @brief Removes up to a number of consecutive elements from the front of the queue, claimed at once.
+                Fewer elements are removed if the queue holds fewer, or if a push before them is still writing its element.
+                Runtime complexity: O(n) without contention
+                @param out The array to move the removed elements to, in order.
+                @param count The maximum number of elements to remove.
+                @return The number of elements removed.
              */
-            HashMap() {};
+            uint tryPopN(T* out, uint count)
+            {
+                size_t first;
+                size_t n = claim(m_popPos, 1, count, first);
+                for (size_t i = 0; i < n; i++)
+                {
+                    T* elem = elementAt(first + i);
+                    out[i] = std::move(*elem);
+                    elem->~T();
+                    m_slots[(first + i) & m_mask].sequence.store(first + i + m_mask + 1, std::memory_order_release);
+                }
+                return (uint)n;
+            }
 
             /*
-                @brief Creates a hash map from a given array list of pairs.
-                @param list The array list to copy.
+                @brief Returns the number of elements in the queue, including pushes still in progress.
+             *  Only exact if no other thread is using the queue.
+                @return The number of elements in the queue.
              */
-            HashMap(ArrayList<Pair<K, V>> list) 
+            uint size() const
             {
-                this->list = list;
+                size_t pop = m_popPos.load(std::memory_order_acquire);
+                size_t push = m_pushPos.load(std::memory_order_acquire);
+                return push - pop > m_mask ? (push < pop ? 0 : m_mask + 1) : (uint)(push - pop);
             }
 
             /*
-                @brief Creates a hash map from a given initializer list of pairs.
-                @param list The initializer list to copy.
+                @brief Checks if the queue is empty.
+             *  Only exact if no other thread is using the queue.
+                @return True if the queue is empty, false otherwise.
              */
-            HashMap(std::initializer_list<Pair<K, V>> list)
+            bool empty() const
             {
-                this->list = ArrayList(list);
+                return size() == 0;
             }
 
-            V& operator[](K key)
+            /*
+                @brief Returns the number of elements the queue can hold.
+                @return The capacity, always a power of two.
+             */
+            uint capacity() const
             {
-                for (int i = 0; i < list.size(); i++)
-                {
-                    if (list[i].first == key) return list[i].second;
-                }
-                Sapphire::Err("DSA::HashMap --> key " + std::to_string(key) + " not found");
-                throw std::runtime_error("Sapphire: DSA::HashMap --> key " + std::to_string(key) + " not found");
+                return (uint)(m_mask + 1);
             }
 
-            HashMap<K, V>& operator=(const HashMap<K, V>& other)
-            {
-                list = other.list;
-                return *this;
-            }
+        private:
+            // The indices are on cache lines of their own, so producers and consumers only contend among themselves.
+            alignas(64) std::atomic<size_t> m_pushPos;
+            alignas(64) std::atomic<size_t> m_popPos;
+
+            alignas(64) Slot* m_slots;
+            size_t m_mask;
+            [[no_unique_address]] SlotAllocator m_alloc;
 
-            friend bool operator==(const HashMap<K, V>& map1, const HashMap<K, V>& map2)
+            T* elementAt(size_t position)
             {
-                return map1.list == map2.list;
+                return (T*)m_slots[position & m_mask].storage;
             }
 
-            friend bool operator!=(const HashMap<K, V>& map1, const HashMap<K, V>& map2)
+            template<typename U>
+            bool pushOne(U&& elem)
             {
-                return !(map1 == map2);
+                size_t position;
+                if (claim(m_pushPos, 0, 1, position) == 0) return false;
+                new (elementAt(position)) T(std::forward<U>(elem));
+                m_slots[position & m_mask].sequence.store(position + 1, std::memory_order_release);
+                return true;
             }
 
-            void set(K key, V value)
+            // Claims up to count consecutive positions from an index, and returns how many were claimed.
+            // The slot of a position is ready when its sequence equals the position plus the offset:
+            // 0 for a push (free on this lap), 1 for a pop (filled on this lap).
+            size_t claim(std::atomic<size_t>& index, size_t offset, size_t count, size_t& first)
             {
-                for (int i = 0; i < list.size(); i++)
+                size_t position = index.load(std::memory_order_relaxed);
+                while (true)
                 {
-                    if (list[i].first == key)
+                    size_t n = 0;
+                    intptr_t lag = 0;
+                    while (n < count)
                     {
-                        list[i].second = value;
-                        return;
+                        lag = (intptr_t)(m_slots[(position + n) & m_mask].sequence.load(std::memory_order_acquire) - (position + n + offset));
+                        if (lag != 0) break;
+                        n++;
                     }
-                }
-
-                list.add(Pair<K, V>(key, value));
-            }
-
-            class Iterator
-            {
-            public:
-                using iterator_category = std::forward_iterator_tag;
-                using difference_type = std::ptrdiff_t;
-                using value_type = Pair<K, V>;
-                using pointer = Pair<K, V>*;
-                using reference = Pair<K, V>&;
-
-                Iterator(pointer ptr) : m_ptr(ptr) {}
-                
-                reference operator*() const 
-                { 
-                    return *m_ptr; 
-                }
-                
-                pointer operator->() 
-                {
-                    return m_ptr; 
-                }
 
-                Iterator& operator++() 
-                {
-                    m_ptr++; return *this;
-                }
+                    if (n == 0)
+                    {
+                        // A slot still on the previous lap means the queue is full (or empty when popping),
+                        // one on a later lap means another thread took the position first.
+                        if (lag < 0) return 0;
+                        position = index.load(std::memory_order_relaxed);
+                        continue;
+                    }
 
-                Iterator operator++(int) 
-                {
-                    Iterator tmp = *this; ++(*this); return tmp; 
+                    // The sequences seen cannot change before the index moves past them, so a successful swap owns them all.
+                    if (index.compare_exchange_weak(position, position + n, std::memory_order_relaxed))
+                    {
+                        first = position;
+                        return n;
+                    }
                 }
-
-                friend bool operator==(const Iterator& it1, const Iterator& it2) 
-                { 
-                    return it1.m_ptr == it2.m_ptr; 
-                };
-
-                friend bool operator!=(const Iterator& it1, const Iterator& it2) 
-                {
-                    return it1.m_ptr != it2.m_ptr; 
-                };
-
-            private:
-                pointer m_ptr;
-            };
-
-            Iterator begin() 
-            {
-                return Iterator(list.data()); 
-            }
-
-            Iterator end() 
-            {
-                return Iterator(list.data() + list.size()); 
             }
-            
-        private:
-            ArrayList<Pair<K, V>> list;
         };
         
     }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <fstream>
 #include <filesystem>
+#include <functional>
 
 /*
     @brief Sapphire is a C++ library that provides a large set of tools for developers.
@@ -287,6 +288,27 @@ namespace Sapphire
          */
         std::vector<std::string> GetDirsInDirRecursive(const std::string& path);
 
+        /*
+            @brief Calls a function for every file and directory in a directory and its subdirectories,
+            listing the subdirectories concurrently on the threads of the default Parallel pool.
+            Ideal for large directory trees, where listing directories one at a time is slow.
+         *  Symbolic links to directories are reported as directories, but not followed.
+         !  The function is called from several threads at once, in no particular order.
+         !  Rethrows the first exception thrown by the function or by listing a directory, once the walk has stopped.
+            @param path The path of the directory to iterate through.
+            @param fn A function taking the path of a file or directory, and whether it is a directory.
+         */
+        void ParallelForEachInDirRecursive(const std::string& path, const std::function<void(const std::string& path, bool isDir)>& fn);
+
+        /*
+            @brief Iterates through all files in a directory and its subdirectories,
+            listing the subdirectories concurrently on the threads of the default Parallel pool.
+         *  The files are in no particular order.
+            @param path The path of the directory to iterate through.
+            @return A vector containing all files in the directory and its subdirectories.
+         */
+        std::vector<std::string> ParallelGetFilesInDirRecursive(const std::string& path);
+
         /*
             @brief Writes to a file.
          *  Member variables of any File objects created from the file will remain unchanged.
@@ -335,6 +357,23 @@ namespace Sapphire
          */
         std::vector<std::string> ReadLines(const std::string& path);
 
+        /*
+            @brief Writes raw bytes to a file, without the newline translation of text mode.
+            Unlike Write(), does not return a File object, which would read the whole file back as text.
+         *  If writing to a new file in a directory that doesn't exist, use CreateDir() first.
+            @param path The path of the file to write to.
+            @param contents The bytes to write to the file.
+            @return True if every byte was written, false otherwise.
+         */
+        bool WriteBinary(const std::string& path, const std::string& contents);
+
+        /*
+            @brief Reads the raw bytes of a file, without the newline translation of text mode.
+            @param path The path of the file to read.
+            @return The bytes of the file, or an empty string if it could not be read.
+         */
+        std::string ReadBinary(const std::string& path);
+
         /*
             @brief Gets the size of a file in bytes.
             @param path The path of the file to get the size of.
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+    @brief Sapphire is a C++ library that provides a large set of tools for developers.
+    Every Sapphire function is under this namespace.
+ */
+namespace Sapphire
+{
+
+    /*
+        @brief A namespace containing memory allocators.
+        Every DSA container takes an allocator as its last template parameter, except two:
+        SoAList, whose list of field types leaves no room for one, so its columns use HeapAllocator,
+        and StringTable, which keeps its strings in arenas of its own.
+     */
+    namespace Memory
+    {
+
+        /*
+            @brief The default allocator of the DSA containers, allocating from the heap.
+            Trivially copyable types are allocated with malloc, so their storage can be grown in place with realloc.
+         *  Allocated memory is uninitialized, no elements are constructed.
+         */
+        template<typename T>
+        class HeapAllocator
+        {
+        public:
+            using value_type = T;
+
+            HeapAllocator() {}
+
+            template<typename U>
+            HeapAllocator(const HeapAllocator<U>&) {}
+
+            /*
+                @brief Allocates uninitialized storage for a number of elements.
+                @param count The number of elements.
+                @return A pointer to the storage.
+             */
+            T* allocate(size_t count)
+            {
+                if constexpr (USE_MALLOC)
+                {
+                    void* p = std::malloc(count * sizeof(T));
+                    if (p == nullptr && count != 0) throw std::bad_alloc();
+                    return (T*)p;
+                }
+                else return (T*)::operator new(count * sizeof(T), std::align_val_t(alignof(T)));
+            }
+
+            /*
+                @brief Frees storage returned by allocate() or reallocate().
+                @param p The storage to free.
+                @param count The number of elements the storage was allocated for.
+             */
+            void deallocate(T* p, size_t)
+            {
+                if constexpr (USE_MALLOC) std::free(p);
+                else ::operator delete(p, std::align_val_t(alignof(T)));
+            }
+
+            /*
+                @brief Resizes storage, keeping its contents, possibly without copying.
+             !  Only available for trivially copyable types.
+                @param p The storage to resize.
+                @param count The number of elements the storage was allocated for.
+                @param newCount The new number of elements.
+                @return A pointer to the resized storage.
+             */
+            template<typename U = T, typename = std::enable_if_t<std::is_trivially_copyable_v<U> && alignof(U) <= alignof(std::max_align_t)>>
+            T* reallocate(T* p, size_t, size_t newCount)
+            {
+                void* q = std::realloc(p, newCount * sizeof(T));
+                if (q == nullptr && newCount != 0) throw std::bad_alloc();
+                return (T*)q;
+            }
+
+            friend bool operator==(const HeapAllocator<T>&, const HeapAllocator<T>&)
+            {
+                return true;
+            }
+
+            friend bool operator!=(const HeapAllocator<T>&, const HeapAllocator<T>&)
+            {
+                return false;
+            }
+
+        private:
+            static constexpr bool USE_MALLOC = std::is_trivially_copyable_v<T> && alignof(T) <= alignof(std::max_align_t);
+        };
+
+        /*
+            @brief A bump-pointer allocator for memory that is all freed at once.
+            Allocating is a pointer increment, and reset() frees everything in O(1) while keeping the blocks for reuse.
+            Ideal for request-scoped work: allocate freely while handling a request, then reset.
+         *  Destructors of objects in the arena are never called, so only put objects there that do not need them,
+         *  or that are destroyed by their owners (like the elements of a DSA container using an ArenaAllocator).
+         *  Not thread-safe.
+         */
+        class Arena
+        {
+        public:
+            /*
+                @brief Creates an arena that allocates blocks of the given size from the heap.
+                No memory is allocated until the first allocation.
+                @param blockSize The size of each block in bytes.
+                Allocations larger than a block get a block of their own.
+                64 KiB by default.
+             */
+            Arena(size_t blockSize = 64 * 1024);
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            /*
+                @brief Destroys the arena and frees all of its blocks.
+             */
+            ~Arena();
+
+            /*
+                @brief Allocates uninitialized memory from the arena.
+                @param size The number of bytes to allocate.
+                @param alignment The alignment of the memory, must be a power of two.
+                @return A pointer to the memory, valid until the next reset() or release().
+             */
+            void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+            /*
+                @brief Allocates uninitialized memory for a number of objects.
+                @param count The number of objects.
+                @return A pointer to the memory, valid until the next reset() or release().
+             */
+            template<typename T>
+            T* allocate(size_t count)
+            {
+                return (T*)allocate(count * sizeof(T), alignof(T));
+            }
+
+            /*
+                @brief Constructs an object in the arena.
+             *  Its destructor will never be called by the arena.
+                @param args The arguments to construct the object with.
+                @return A pointer to the object.
+             */
+            template<typename T, typename... Args>
+            T* create(Args&&... args)
+            {
+                return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            }
+
+            /*
+                @brief Frees everything allocated from the arena in O(1).
+                The blocks are kept and reused by later allocations.
+             */
+            void reset();
+
+            /*
+                @brief Frees everything allocated from the arena and gives its blocks back to the heap.
+             */
+            void release();
+
+            /*
+                @brief Gets the number of bytes handed out since the last reset, including alignment padding.
+                @return The number of bytes used.
+             */
+            size_t getBytesUsed();
+
+            /*
+                @brief Gets the number of bytes the arena holds in blocks.
+                @return The number of bytes reserved from the heap.
+             */
+            size_t getBytesReserved();
+
+        private:
+            struct Block
+            {
+                Block* next;
+                size_t size;
+            };
+
+            Block* m_head;
+            Block* m_current;
+            size_t m_offset;
+            size_t m_blockSize;
+            size_t m_usedInFullBlocks;
+        };
+
+        /*
+            @brief A standard-compatible allocator that allocates from an Arena.
+            Pass it to a DSA container so that its storage is freed by resetting the arena.
+         *  Deallocating does nothing, the memory is reclaimed when the arena is reset.
+         *  The arena must outlive every container using it.
+         */
+        template<typename T>
+        class ArenaAllocator
+        {
+        public:
+            using value_type = T;
+
+            /*
+                @brief Creates an allocator for the given arena.
+                @param arena The arena to allocate from.
+             */
+            ArenaAllocator(Arena& arena) : m_arena(&arena) {}
+
+            template<typename U>
+            ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.getArena()) {}
+
+            T* allocate(size_t count)
+            {
+                return m_arena->allocate<T>(count);
+            }
+
+            void deallocate(T*, size_t) {}
+
+            /*
+                @brief Gets the arena this allocator allocates from.
+                @return A pointer to the arena.
+             */
+            Arena* getArena() const
+            {
+                return m_arena;
+            }
+
+            friend bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<T>& b)
+            {
+                return a.m_arena == b.m_arena;
+            }
+
+            friend bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<T>& b)
+            {
+                return a.m_arena != b.m_arena;
+            }
+
+        private:
+            Arena* m_arena;
+        };
+
+        /*
+            @brief A fixed-size allocator for single objects of one type, backed by a free list.
+            Slots are carved out of chunks allocated from the heap, and freed slots are reused first,
+            so creating and destroying objects costs no heap traffic once the pool has warmed up.
+         *  Chunks are only given back to the heap when the pool is destroyed.
+         *  Not thread-safe.
+         */
+        template<typename T>
+        class Pool
+        {
+        public:
+            /*
+                @brief Creates an empty pool.
+                No memory is allocated until the first allocation.
+                @param slotsPerChunk The number of objects in each chunk allocated from the heap.
+                256 by default.
+             */
+            Pool(size_t slotsPerChunk = 256)
+            {
+                m_chunks = nullptr;
+                m_free = nullptr;
+                m_slotsPerChunk = slotsPerChunk == 0 ? 1 : slotsPerChunk;
+                m_live = 0;
+            }
+
+            Pool(const Pool<T>&) = delete;
+            Pool<T>& operator=(const Pool<T>&) = delete;
+
+            /*
+                @brief Destroys the pool and frees all of its chunks.
+             !  Does not call the destructors of objects that are still alive.
+             */
+            ~Pool()
+            {
+                while (m_chunks != nullptr)
+                {
+                    Chunk* next = m_chunks->next;
+                    ::operator delete(m_chunks, std::align_val_t(CHUNK_ALIGN));
+                    m_chunks = next;
+                }
+            }
+
+            /*
+                @brief Allocates uninitialized memory for one object.
+                Runtime complexity: O(1)
+                @return A pointer to the memory.
+             */
+            T* allocate()
+            {
+                if (m_free == nullptr) addChunk();
+                Slot* slot = m_free;
+                m_free = slot->next;
+                m_live++;
+                return (T*)slot;
+            }
+
+            /*
+                @brief Gives memory returned by allocate() back to the pool.
+                Runtime complexity: O(1)
+                @param p The memory to free.
+             */
+            void deallocate(T* p)
+            {
+                Slot* slot = (Slot*)p;
+                slot->next = m_free;
+                m_free = slot;
+                m_live--;
+            }
+
+            /*
+                @brief Constructs an object in the pool.
+                @param args The arguments to construct the object with.
+                @return A pointer to the object.
+             */
+            template<typename... Args>
+            T* create(Args&&... args)
+            {
+                T* p = allocate();
+                try
+                {
+                    return new (p) T(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    deallocate(p);
+                    throw;
+                }
+            }
+
+            /*
+                @brief Destroys an object created with create() and gives its memory back to the pool.
+                @param p The object to destroy.
+             */
+            void destroy(T* p)
+            {
+                p->~T();
+                deallocate(p);
+            }
+
+            /*
+                @brief Gets the number of objects currently allocated from the pool.
+                @return The number of live objects.
+             */
+            size_t getLiveCount()
+            {
+                return m_live;
+            }
+
+        private:
+            union Slot
+            {
+                Slot* next;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
+
+            struct Chunk
+            {
+                Chunk* next;
+            };
+
+            static constexpr size_t CHUNK_ALIGN = alignof(Slot) > alignof(Chunk) ? alignof(Slot) : alignof(Chunk);
+            static constexpr size_t HEADER_SIZE = (sizeof(Chunk) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+            Chunk* m_chunks;
+            Slot* m_free;
+            size_t m_slotsPerChunk;
+            size_t m_live;
+
+            void addChunk()
+            {
+                Chunk* chunk = (Chunk*)::operator new(HEADER_SIZE + m_slotsPerChunk * sizeof(Slot), std::align_val_t(CHUNK_ALIGN));
+                chunk->next = m_chunks;
+                m_chunks = chunk;
+
+                Slot* slots = (Slot*)((unsigned char*)chunk + HEADER_SIZE);
+                for (size_t i = m_slotsPerChunk; i > 0; i--)
+                {
+                    slots[i - 1].next = m_free;
+                    m_free = &slots[i - 1];
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Core.h"
+
+/*
+    @brief Sapphire is a C++ library that provides a large set of tools for developers.
+    Every Sapphire function is under this namespace.
+ */
+namespace Sapphire
+{
+
+    /*
+        @brief A namespace containing a work-stealing thread pool and the parallel algorithms built on it.
+        Everything runs on the default pool unless told otherwise, so threads are created once and reused by every call.
+     */
+    namespace Parallel
+    {
+
+        /*
+            @brief A pool of worker threads that run submitted tasks.
+            Each worker has its own task queue: it runs the newest task of its own queue first,
+            and steals the oldest task of another queue when its own is empty, so busy workers keep their caches warm
+            while idle workers take the largest pieces of remaining work.
+            Threads waiting on a TaskGroup run queued tasks instead of blocking, so tasks can safely wait on tasks of their own.
+         */
+        class ThreadPool
+        {
+        public:
+            /*
+                @brief Creates a thread pool and starts its workers.
+                @param threads The number of worker threads.
+                Enter 0 to use one per hardware thread.
+                0 by default.
+             */
+            ThreadPool(uint threads = 0);
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /*
+                @brief Runs every task that is still queued, then stops and joins the workers.
+             */
+            ~ThreadPool();
+
+            /*
+                @brief Queues a task to run on one of the workers.
+                Tasks submitted from a worker go to its own queue, others are spread over the queues in turn.
+             *  Exceptions thrown by the task are logged with Sapphire::Err() and dropped. Use a TaskGroup to get them back.
+                @param task The task to run.
+             */
+            void submit(std::function<void()> task);
+
+            /*
+                @brief Runs one queued task on the calling thread, if there is one.
+                Used to help out while waiting for other tasks instead of blocking.
+                @return True if a task was run, false if every queue was empty.
+             */
+            bool tryRunTask();
+
+            /*
+                @brief Gets the number of worker threads in the pool.
+                @return The number of worker threads.
+             */
+            uint getThreadCount() const;
+
+        private:
+            struct Queue
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+            };
+
+            std::unique_ptr<Queue[]> m_queues;
+            std::unique_ptr<std::thread[]> m_threads;
+            uint m_threadCount;
+            std::atomic<uint> m_nextQueue;
+            std::atomic<size_t> m_pending;
+            std::mutex m_sleepMutex;
+            std::condition_variable m_wake;
+            bool m_stopping;
+
+            void workerLoop(uint index);
+            bool runTask(uint first);
+        };
+
+        /*
+            @brief Gets the pool that the parallel algorithms of Sapphire run on.
+            Unless SetDefaultPool() was called, it is created on first use with one worker per hardware thread.
+            @return The default pool.
+         */
+        ThreadPool& GetDefaultPool();
+
+        /*
+            @brief Sets the pool that the parallel algorithms of Sapphire run on.
+         *  Must not be called while a parallel algorithm is running, and the pool must outlive every later call.
+            @param pool The pool to use.
+         */
+        void SetDefaultPool(ThreadPool& pool);
+
+        /*
+            @brief A set of tasks that can be waited on together.
+            Tasks run on a thread pool, and wait() returns once all of them have finished.
+            If any task throws, wait() rethrows the first exception after every task has finished.
+         *  The destructor waits for the remaining tasks, but drops their exceptions.
+         */
+        class TaskGroup
+        {
+        public:
+            /*
+                @brief Creates an empty task group.
+                @param pool The pool to run the tasks on.
+                The default pool by default.
+             */
+            TaskGroup(ThreadPool& pool = GetDefaultPool());
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+            /*
+                @brief Waits for the remaining tasks.
+             */
+            ~TaskGroup();
+
+            /*
+                @brief Queues a task in the group.
+                @param fn The task to run, a function taking no arguments.
+             */
+            template<typename Fn>
+            void run(Fn&& fn)
+            {
+                m_pending++;
+                try
+                {
+                    m_pool->submit([this, fn = std::forward<Fn>(fn)]() mutable
+                    {
+                        try
+                        {
+                            fn();
+                        }
+                        catch (...)
+                        {
+                            setError(std::current_exception());
+                        }
+                        finish();
+                    });
+                }
+                catch (...)
+                {
+                    finish();
+                    throw;
+                }
+            }
+
+            /*
+                @brief Waits for every task of the group, running queued tasks on the calling thread in the meantime.
+                The group can be reused afterwards.
+             !  Rethrows the first exception thrown by a task.
+             */
+            void wait();
+
+        private:
+            ThreadPool* m_pool;
+            std::atomic<size_t> m_pending;
+            std::mutex m_mutex;
+            std::condition_variable m_done;
+            std::exception_ptr m_error;
+
+            void setError(std::exception_ptr error);
+            void finish();
+            void waitAll();
+        };
+
+        namespace Detail
+        {
+            // Chunks per thread when a parallel loop picks its own chunk size, so uneven chunks still balance out.
+            constexpr size_t CHUNKS_PER_THREAD = 8;
+
+            /*
+                @brief Runs fn(i) for every i in [0, taskCount) on the calling thread and up to threads - 1 tasks of the default pool.
+                Threads take the next task from a shared counter, so uneven tasks still balance out.
+                If a task throws, the remaining tasks are skipped and the first exception is rethrown once every thread has finished.
+                @param threads The number of threads to use, including the calling thread, 0 for every thread of the default pool.
+             */
+            template<typename Fn>
+            void RunTasks(uint threads, size_t taskCount, Fn&& fn)
+            {
+                if (threads == 0) threads = GetDefaultPool().getThreadCount();
+
+                std::atomic<size_t> next(0);
+                auto worker = [&]()
+                {
+                    try
+                    {
+                        for (size_t i = next++; i < taskCount; i = next++) fn(i);
+                    }
+                    catch (...)
+                    {
+                        next = taskCount;
+                        throw;
+                    }
+                };
+
+                // Declared after the counter, so that if the calling thread throws, the helpers are waited for before it goes away.
+                TaskGroup group;
+                size_t helpers = (threads < taskCount ? threads : taskCount);
+                for (size_t i = 1; i < helpers; i++) group.run(worker);
+                worker();
+                group.wait();
+            }
+
+            /*
+                @brief Picks how many indices each chunk of a parallel loop covers.
+             */
+            inline size_t ChunkSize(size_t count, size_t grain)
+            {
+                if (grain != 0) return grain;
+                size_t chunks = (size_t)GetDefaultPool().getThreadCount() * CHUNKS_PER_THREAD;
+                return count / chunks + 1;
+            }
+        }
+
+        /*
+            @brief Runs a function for every index in a range, spread over the threads of the default pool.
+            The range is cut into chunks of consecutive indices, which threads take as they become free.
+         !  The function is called from several threads at once.
+         !  If the function throws, the remaining chunks are skipped and the first exception is rethrown.
+            @param begin The first index, inclusive.
+            @param end The last index, exclusive.
+            @param fn A function taking an index.
+            @param grain The number of indices per chunk.
+            Enter 0 to pick one from the number of threads.
+            0 by default.
+         */
+        template<typename Fn>
+        void ParallelFor(size_t begin, size_t end, Fn&& fn, size_t grain = 0)
+        {
+            if (begin >= end) return;
+
+            size_t count = end - begin;
+            size_t chunkSize = Detail::ChunkSize(count, grain);
+            Detail::RunTasks(0, (count + chunkSize - 1) / chunkSize, [&](size_t chunk)
+            {
+                size_t first = begin + chunk * chunkSize;
+                size_t last = end - first < chunkSize ? end : first + chunkSize;
+                for (size_t i = first; i < last; i++) fn(i);
+            });
+        }
+
+        /*
+            @brief Reduces a range of indices to one value, spread over the threads of the default pool.
+            The range is cut into chunks of consecutive indices, each reduced on its own, and the results of the chunks
+            are combined in order, so the result does not depend on the number of threads even if combine is not commutative.
+         !  The functions are called from several threads at once.
+         !  If a function throws, the remaining chunks are skipped and the first exception is rethrown.
+         !  The result type must be default constructible.
+            @param begin The first index, inclusive.
+            @param end The last index, exclusive.
+            @param identity The result of an empty range, which combine must leave unchanged.
+            @param fn A function taking the first and last (exclusive) index of a chunk and returning its result.
+            @param combine A function taking two results and returning their combination.
+            @param grain The number of indices per chunk.
+            Enter 0 to pick one from the number of threads.
+            0 by default.
+            @return The combination of the results of all chunks.
+         */
+        template<typename T, typename Fn, typename Combine>
+        T ParallelReduce(size_t begin, size_t end, T identity, Fn&& fn, Combine&& combine, size_t grain = 0)
+        {
+            if (begin >= end) return identity;
+
+            size_t count = end - begin;
+            size_t chunkSize = Detail::ChunkSize(count, grain);
+            size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+            std::unique_ptr<T[]> results(new T[chunks]);
+            Detail::RunTasks(0, chunks, [&](size_t chunk)
+            {
+                size_t first = begin + chunk * chunkSize;
+                size_t last = end - first < chunkSize ? end : first + chunkSize;
+                results[chunk] = fn(first, last);
+            });
+
+            T result = std::move(identity);
+            for (size_t i = 0; i < chunks; i++) result = combine(std::move(result), std::move(results[i]));
+            return result;
+        }
+
+        /*
+            @brief Runs functions concurrently on the default pool, and returns once all of them have finished.
+            The first function runs on the calling thread.
+         !  If a function throws, the first exception is rethrown once every function has finished.
+            @param fns The functions to run, each taking no arguments.
+         */
+        template<typename Fn, typename... Fns>
+        void ParallelInvoke(Fn&& fn, Fns&&... fns)
+        {
+            TaskGroup group;
+            (group.run(std::forward<Fns>(fns)), ...);
+            fn();
+            group.wait();
+        }
+    }
+
+}
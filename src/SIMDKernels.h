@@ -0,0 +1,226 @@
+// The SIMD kernels behind DSA::LinearSearch, MinIndex and MaxIndex, and the word kernels of DSA::Bitset and RoaringBitmap.
+// No include guard on purpose: Sapphire.cpp includes this file once per instruction set, inside a namespace
+// compiled for that instruction set, after defining VECTOR_BYTES, Bytes, ByteMask(), PopCountBytes() and SumBytes() for it.
+
+template<typename T>
+struct VecOf
+{
+    typedef T Type __attribute__((vector_size(VECTOR_BYTES)));
+};
+
+template<typename T>
+using Vec = typename VecOf<T>::Type;
+
+template<typename T>
+constexpr size_t LANES = VECTOR_BYTES / sizeof(T);
+
+// Elements per block when searching for the minimum or maximum, a multiple of 4 vectors of any element type.
+constexpr size_t EXTREMUM_BLOCK = 1024;
+
+template<typename T>
+inline Vec<T> Load(const T* p)
+{
+    Vec<T> v;
+    __builtin_memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template<typename T>
+inline Vec<T> Broadcast(T x)
+{
+    return Vec<T>{} + x;
+}
+
+// Returns a bit per byte, set where the comparison mask is set, so the first matching lane is ctz / sizeof(T).
+template<typename M>
+inline ulonglong MaskBits(M mask)
+{
+    return ByteMask((Bytes)mask);
+}
+
+template<typename T>
+size_t Find(const T* arr, size_t size, T elem)
+{
+    constexpr size_t L = LANES<T>;
+    Vec<T> key = Broadcast(elem);
+
+    size_t i = 0;
+    for (; i + 4 * L <= size; i += 4 * L)
+    {
+        auto m0 = Load(arr + i) == key;
+        auto m1 = Load(arr + i + L) == key;
+        auto m2 = Load(arr + i + 2 * L) == key;
+        auto m3 = Load(arr + i + 3 * L) == key;
+        if (MaskBits(m0 | m1 | m2 | m3) != 0)
+        {
+            ulonglong bits;
+            if ((bits = MaskBits(m0)) != 0) return i + __builtin_ctzll(bits) / sizeof(T);
+            if ((bits = MaskBits(m1)) != 0) return i + L + __builtin_ctzll(bits) / sizeof(T);
+            if ((bits = MaskBits(m2)) != 0) return i + 2 * L + __builtin_ctzll(bits) / sizeof(T);
+            return i + 3 * L + __builtin_ctzll(MaskBits(m3)) / sizeof(T);
+        }
+    }
+
+    for (; i + L <= size; i += L)
+    {
+        ulonglong bits = MaskBits(Load(arr + i) == key);
+        if (bits != 0) return i + __builtin_ctzll(bits) / sizeof(T);
+    }
+
+    for (; i < size; i++)
+    {
+        if (arr[i] == elem) return i;
+    }
+    return size;
+}
+
+// Finds the first index of the minimum (or maximum if IsMax) in a non-empty array, with the same result as a scalar
+// scan that keeps the first element that beats the best so far: a NaN at index 0 wins, NaNs anywhere else never do.
+// Each block is reduced into 4 vector accumulators seeded with the best value so far, which a NaN lane can never replace,
+// and only the block that last improved the best value is scanned again for its index.
+template<bool IsMax, typename T>
+size_t Extremum(const T* arr, size_t size)
+{
+    constexpr size_t L = LANES<T>;
+    T best = arr[0];
+    if (best != best) return 0;
+
+    size_t bestBlock = size;
+    size_t i = 0;
+    for (; i + EXTREMUM_BLOCK <= size; i += EXTREMUM_BLOCK)
+    {
+        Vec<T> acc0 = Broadcast(best), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (size_t j = i; j < i + EXTREMUM_BLOCK; j += 4 * L)
+        {
+            Vec<T> x0 = Load(arr + j), x1 = Load(arr + j + L), x2 = Load(arr + j + 2 * L), x3 = Load(arr + j + 3 * L);
+            if constexpr (IsMax)
+            {
+                acc0 = x0 > acc0 ? x0 : acc0;
+                acc1 = x1 > acc1 ? x1 : acc1;
+                acc2 = x2 > acc2 ? x2 : acc2;
+                acc3 = x3 > acc3 ? x3 : acc3;
+            }
+            else
+            {
+                acc0 = x0 < acc0 ? x0 : acc0;
+                acc1 = x1 < acc1 ? x1 : acc1;
+                acc2 = x2 < acc2 ? x2 : acc2;
+                acc3 = x3 < acc3 ? x3 : acc3;
+            }
+        }
+
+        if constexpr (IsMax)
+        {
+            acc0 = acc1 > acc0 ? acc1 : acc0;
+            acc2 = acc3 > acc2 ? acc3 : acc2;
+            acc0 = acc2 > acc0 ? acc2 : acc0;
+        }
+        else
+        {
+            acc0 = acc1 < acc0 ? acc1 : acc0;
+            acc2 = acc3 < acc2 ? acc3 : acc2;
+            acc0 = acc2 < acc0 ? acc2 : acc0;
+        }
+
+        T blockBest = acc0[0];
+        for (size_t k = 1; k < L; k++)
+        {
+            if (IsMax ? acc0[k] > blockBest : acc0[k] < blockBest) blockBest = acc0[k];
+        }
+        if (IsMax ? blockBest > best : blockBest < best)
+        {
+            best = blockBest;
+            bestBlock = i;
+        }
+    }
+
+    size_t bestIndex = bestBlock == size ? 0 : bestBlock + Find(arr + bestBlock, EXTREMUM_BLOCK, best);
+    for (; i < size; i++)
+    {
+        if (IsMax ? arr[i] > best : arr[i] < best)
+        {
+            best = arr[i];
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
+
+template<typename T>
+inline void Store(T* p, Vec<T> v)
+{
+    __builtin_memcpy(p, &v, sizeof(v));
+}
+
+template<BitOp Op>
+inline Vec<uint64_t> Combine(Vec<uint64_t> a, Vec<uint64_t> b)
+{
+    if constexpr (Op == BitOp::AND) return a & b;
+    else if constexpr (Op == BitOp::OR) return a | b;
+    else if constexpr (Op == BitOp::XOR) return a ^ b;
+    else return a & ~b;
+}
+
+template<BitOp Op>
+inline uint64_t Combine(uint64_t a, uint64_t b)
+{
+    if constexpr (Op == BitOp::AND) return a & b;
+    else if constexpr (Op == BitOp::OR) return a | b;
+    else if constexpr (Op == BitOp::XOR) return a ^ b;
+    else return a & ~b;
+}
+
+// dst may be a or b itself: every vector is loaded before the vector at the same index is stored.
+template<BitOp Op>
+void Bitwise(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    constexpr size_t L = LANES<uint64_t>;
+
+    size_t i = 0;
+    for (; i + 4 * L <= count; i += 4 * L)
+    {
+        Vec<uint64_t> r0 = Combine<Op>(Load(a + i), Load(b + i));
+        Vec<uint64_t> r1 = Combine<Op>(Load(a + i + L), Load(b + i + L));
+        Vec<uint64_t> r2 = Combine<Op>(Load(a + i + 2 * L), Load(b + i + 2 * L));
+        Vec<uint64_t> r3 = Combine<Op>(Load(a + i + 3 * L), Load(b + i + 3 * L));
+        Store(dst + i, r0);
+        Store(dst + i + L, r1);
+        Store(dst + i + 2 * L, r2);
+        Store(dst + i + 3 * L, r3);
+    }
+
+    for (; i + L <= count; i += L) Store(dst + i, Combine<Op>(Load(a + i), Load(b + i)));
+    for (; i < count; i++) dst[i] = Combine<Op>(a[i], b[i]);
+}
+
+inline void Bitwise(BitOp op, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    switch (op)
+    {
+        case BitOp::AND: Bitwise<BitOp::AND>(dst, a, b, count); break;
+        case BitOp::OR: Bitwise<BitOp::OR>(dst, a, b, count); break;
+        case BitOp::XOR: Bitwise<BitOp::XOR>(dst, a, b, count); break;
+        default: Bitwise<BitOp::AND_NOT>(dst, a, b, count); break;
+    }
+}
+
+// Counts the bits of 4 vectors at a time into bytes with PopCountBytes(), at most 32 per byte,
+// then sums the bytes into 64-bit lanes with SumBytes() before they can overflow.
+inline size_t PopCount(const uint64_t* words, size_t count)
+{
+    constexpr size_t L = LANES<uint64_t>;
+    Vec<uint64_t> total{};
+
+    size_t i = 0;
+    for (; i + 4 * L <= count; i += 4 * L)
+    {
+        Bytes bytes = PopCountBytes((Bytes)Load(words + i)) + PopCountBytes((Bytes)Load(words + i + L))
+            + PopCountBytes((Bytes)Load(words + i + 2 * L)) + PopCountBytes((Bytes)Load(words + i + 3 * L));
+        total += (Vec<uint64_t>)SumBytes(bytes);
+    }
+
+    size_t result = 0;
+    for (size_t k = 0; k < L; k++) result += total[k];
+    for (; i < count; i++) result += __builtin_popcountll(words[i]);
+    return result;
+}
@@ -4,6 +4,12 @@
 #include "System.h"
 #include "Console.h"
 #include "FileSystem.h"
+#include "Memory.h"
+#include "Parallel.h"
+
+#ifdef SIMD_DISPATCH
+    #include <immintrin.h>
+#endif
 
 Sapphire::Logger* p_logger;
 Sapphire::System::SystemInfo sysinfo;
@@ -489,6 +495,614 @@ void Sapphire::Err(const std::string& message)
     if (p_logger != nullptr) p_logger->err(message);
 }
 
+#ifdef SIMD_DISPATCH
+
+namespace Sapphire::DSA::Detail::Simd
+{
+    namespace Sse2
+    {
+        constexpr size_t VECTOR_BYTES = 16;
+
+        typedef char Bytes __attribute__((vector_size(VECTOR_BYTES)));
+
+        inline ulonglong ByteMask(Bytes v)
+        {
+            return (uint)_mm_movemask_epi8((__m128i)v);
+        }
+
+        typedef unsigned char UnsignedBytes __attribute__((vector_size(VECTOR_BYTES)));
+
+        // SSE2 has no byte shuffle, so each byte counts its own bits with shifts and masks.
+        inline Bytes PopCountBytes(Bytes v)
+        {
+            UnsignedBytes x = (UnsignedBytes)v;
+            x = x - ((x >> 1) & 0x55);
+            x = (x & 0x33) + ((x >> 2) & 0x33);
+            return (Bytes)((x + (x >> 4)) & 0x0f);
+        }
+
+        inline Bytes SumBytes(Bytes v)
+        {
+            return (Bytes)_mm_sad_epu8((__m128i)v, _mm_setzero_si128());
+        }
+
+        #include "SIMDKernels.h"
+    }
+
+    #pragma GCC push_options
+    #pragma GCC target("avx2")
+    namespace Avx2
+    {
+        constexpr size_t VECTOR_BYTES = 32;
+
+        typedef char Bytes __attribute__((vector_size(VECTOR_BYTES)));
+
+        inline ulonglong ByteMask(Bytes v)
+        {
+            return (uint)_mm256_movemask_epi8((__m256i)v);
+        }
+
+        // Each nibble looks up its bit count in a 16-entry table, repeated in both 128-bit lanes of the shuffle.
+        inline Bytes PopCountBytes(Bytes v)
+        {
+            const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i nibble = _mm256_set1_epi8(0x0f);
+            __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256((__m256i)v, nibble));
+            __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16((__m256i)v, 4), nibble));
+            return (Bytes)_mm256_add_epi8(low, high);
+        }
+
+        inline Bytes SumBytes(Bytes v)
+        {
+            return (Bytes)_mm256_sad_epu8((__m256i)v, _mm256_setzero_si256());
+        }
+
+        #include "SIMDKernels.h"
+    }
+    #pragma GCC pop_options
+
+    #pragma GCC push_options
+    #pragma GCC target("avx512f,avx512bw")
+    namespace Avx512
+    {
+        constexpr size_t VECTOR_BYTES = 64;
+
+        typedef char Bytes __attribute__((vector_size(VECTOR_BYTES)));
+
+        inline ulonglong ByteMask(Bytes v)
+        {
+            return _mm512_movepi8_mask((__m512i)v);
+        }
+
+        // Each nibble looks up its bit count in a 16-entry table, repeated in every 128-bit lane of the shuffle.
+        // The table is packed four bytes per dword (0, 1, 1, 2 | 1, 2, 2, 3 | 1, 2, 2, 3 | 2, 3, 3, 4), as
+        // broadcasting a 128-bit vector trips GCC's -Wmaybe-uninitialized in its own intrinsic headers.
+        inline Bytes PopCountBytes(Bytes v)
+        {
+            const __m512i table = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+            const __m512i nibble = _mm512_set1_epi8(0x0f);
+            __m512i low = _mm512_shuffle_epi8(table, _mm512_and_si512((__m512i)v, nibble));
+            __m512i high = _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16((__m512i)v, 4), nibble));
+            return (Bytes)_mm512_add_epi8(low, high);
+        }
+
+        inline Bytes SumBytes(Bytes v)
+        {
+            return (Bytes)_mm512_sad_epu8((__m512i)v, _mm512_setzero_si512());
+        }
+
+        #include "SIMDKernels.h"
+    }
+    #pragma GCC pop_options
+
+    enum class InstructionSet
+    {
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    // Detected on first use rather than during static initialization, so kernels can be called from other static initializers.
+    static InstructionSet GetInstructionSet()
+    {
+        static const InstructionSet instructionSet = []()
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return InstructionSet::AVX512;
+            if (__builtin_cpu_supports("avx2")) return InstructionSet::AVX2;
+            return InstructionSet::SSE2;
+        }();
+        return instructionSet;
+    }
+
+    template<typename T>
+    static size_t FindDispatch(const T* arr, size_t size, T elem)
+    {
+        switch (GetInstructionSet())
+        {
+            case InstructionSet::AVX512: return Avx512::Find(arr, size, elem);
+            case InstructionSet::AVX2: return Avx2::Find(arr, size, elem);
+            default: return Sse2::Find(arr, size, elem);
+        }
+    }
+
+    template<bool IsMax, typename T>
+    static size_t ExtremumDispatch(const T* arr, size_t size)
+    {
+        switch (GetInstructionSet())
+        {
+            case InstructionSet::AVX512: return Avx512::Extremum<IsMax>(arr, size);
+            case InstructionSet::AVX2: return Avx2::Extremum<IsMax>(arr, size);
+            default: return Sse2::Extremum<IsMax>(arr, size);
+        }
+    }
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const int8_t* arr, size_t size, int8_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const uint8_t* arr, size_t size, uint8_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const int16_t* arr, size_t size, int16_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const uint16_t* arr, size_t size, uint16_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const int32_t* arr, size_t size, int32_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const uint32_t* arr, size_t size, uint32_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const int64_t* arr, size_t size, int64_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const uint64_t* arr, size_t size, uint64_t elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const float* arr, size_t size, float elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::Find(const double* arr, size_t size, double elem)
+{
+    return FindDispatch(arr, size, elem);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const int8_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const int8_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const uint8_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const uint8_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const int16_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const int16_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const uint16_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const uint16_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const int32_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const int32_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const uint32_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const uint32_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const int64_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const int64_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const uint64_t* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const uint64_t* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const float* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const float* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MinIndex(const double* arr, size_t size)
+{
+    return ExtremumDispatch<false>(arr, size);
+}
+
+size_t Sapphire::DSA::Detail::Simd::MaxIndex(const double* arr, size_t size)
+{
+    return ExtremumDispatch<true>(arr, size);
+}
+
+void Sapphire::DSA::Detail::Simd::Bitwise(BitOp op, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    switch (GetInstructionSet())
+    {
+        case InstructionSet::AVX512: Avx512::Bitwise(op, dst, a, b, count); break;
+        case InstructionSet::AVX2: Avx2::Bitwise(op, dst, a, b, count); break;
+        default: Sse2::Bitwise(op, dst, a, b, count); break;
+    }
+}
+
+size_t Sapphire::DSA::Detail::Simd::PopCount(const uint64_t* words, size_t count)
+{
+    switch (GetInstructionSet())
+    {
+        case InstructionSet::AVX512: return Avx512::PopCount(words, count);
+        case InstructionSet::AVX2: return Avx2::PopCount(words, count);
+        default: return Sse2::PopCount(words, count);
+    }
+}
+
+#else
+
+void Sapphire::DSA::Detail::Simd::Bitwise(BitOp op, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t count)
+{
+    switch (op)
+    {
+        case BitOp::AND: for (size_t i = 0; i < count; i++) dst[i] = a[i] & b[i]; break;
+        case BitOp::OR: for (size_t i = 0; i < count; i++) dst[i] = a[i] | b[i]; break;
+        case BitOp::XOR: for (size_t i = 0; i < count; i++) dst[i] = a[i] ^ b[i]; break;
+        default: for (size_t i = 0; i < count; i++) dst[i] = a[i] & ~b[i]; break;
+    }
+}
+
+size_t Sapphire::DSA::Detail::Simd::PopCount(const uint64_t* words, size_t count)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++) result += Sapphire::DSA::Detail::PopCount(words[i]);
+    return result;
+}
+
+#endif
+
+Sapphire::Memory::Arena::Arena(size_t blockSize)
+{
+    m_head = nullptr;
+    m_current = nullptr;
+    m_offset = 0;
+    m_blockSize = blockSize == 0 ? 64 * 1024 : blockSize;
+    m_usedInFullBlocks = 0;
+}
+
+Sapphire::Memory::Arena::~Arena()
+{
+    release();
+}
+
+void* Sapphire::Memory::Arena::allocate(size_t size, size_t alignment)
+{
+    if (m_current != nullptr)
+    {
+        uintptr_t data = (uintptr_t)(m_current + 1);
+        uintptr_t start = (data + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (start - data + size <= m_current->size)
+        {
+            m_offset = start - data + size;
+            return (void*)start;
+        }
+        m_usedInFullBlocks += m_offset;
+    }
+
+    // Reuse the next block kept from before a reset if it is big enough, otherwise put a new block in front of it.
+    Block* next = m_current != nullptr ? m_current->next : m_head;
+    if (next == nullptr || next->size < size + alignment)
+    {
+        size_t blockSize = size + alignment > m_blockSize ? size + alignment : m_blockSize;
+        Block* block = (Block*)std::malloc(sizeof(Block) + blockSize);
+        if (block == nullptr) throw std::bad_alloc();
+        block->size = blockSize;
+        block->next = next;
+        if (m_current != nullptr) m_current->next = block;
+        else m_head = block;
+        next = block;
+    }
+
+    m_current = next;
+    m_offset = 0;
+    return allocate(size, alignment);
+}
+
+void Sapphire::Memory::Arena::reset()
+{
+    m_current = m_head;
+    m_offset = 0;
+    m_usedInFullBlocks = 0;
+}
+
+void Sapphire::Memory::Arena::release()
+{
+    while (m_head != nullptr)
+    {
+        Block* next = m_head->next;
+        std::free(m_head);
+        m_head = next;
+    }
+    m_current = nullptr;
+    m_offset = 0;
+    m_usedInFullBlocks = 0;
+}
+
+size_t Sapphire::Memory::Arena::getBytesUsed()
+{
+    return m_usedInFullBlocks + m_offset;
+}
+
+size_t Sapphire::Memory::Arena::getBytesReserved()
+{
+    size_t total = 0;
+    for (Block* block = m_head; block != nullptr; block = block->next)
+    {
+        total += block->size;
+    }
+    return total;
+}
+
+// The pool and queue the current thread works for, so tasks submitted from a worker go to its own queue.
+thread_local Sapphire::Parallel::ThreadPool* t_workerPool = nullptr;
+thread_local uint t_workerIndex = 0;
+std::atomic<Sapphire::Parallel::ThreadPool*> p_defaultPool(nullptr);
+
+Sapphire::Parallel::ThreadPool::ThreadPool(uint threads)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    m_threadCount = threads;
+    m_nextQueue = 0;
+    m_pending = 0;
+    m_stopping = false;
+    m_queues.reset(new Queue[threads]);
+    m_threads.reset(new std::thread[threads]);
+    for (uint i = 0; i < threads; i++)
+    {
+        m_threads[i] = std::thread([this, i]() { workerLoop(i); });
+    }
+}
+
+Sapphire::Parallel::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (uint i = 0; i < m_threadCount; i++) m_threads[i].join();
+}
+
+void Sapphire::Parallel::ThreadPool::submit(std::function<void()> task)
+{
+    // Counted before it is queued, so the count never drops below the number of queued tasks.
+    uint index = t_workerPool == this ? t_workerIndex : m_nextQueue++ % m_threadCount;
+    m_pending++;
+    try
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index].mutex);
+        m_queues[index].tasks.push_back(std::move(task));
+    }
+    catch (...)
+    {
+        m_pending--;
+        throw;
+    }
+
+    // Taking the sleep lock orders this against a worker that has just found nothing to do and is about to sleep.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool Sapphire::Parallel::ThreadPool::tryRunTask()
+{
+    return runTask(t_workerPool == this ? t_workerIndex : m_nextQueue % m_threadCount);
+}
+
+uint Sapphire::Parallel::ThreadPool::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+void Sapphire::Parallel::ThreadPool::workerLoop(uint index)
+{
+    t_workerPool = this;
+    t_workerIndex = index;
+
+    while (true)
+    {
+        if (runTask(index)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_pending > 0; });
+        if (m_stopping && m_pending == 0) return;
+    }
+}
+
+bool Sapphire::Parallel::ThreadPool::runTask(uint first)
+{
+    if (m_pending == 0) return false;
+
+    // The own queue is used as a stack so the newest task, whose data is still cached, runs first.
+    // Other queues are stolen from at the other end, where the oldest and usually largest tasks are.
+    std::function<void()> task;
+    for (uint i = 0; i < m_threadCount && !task; i++)
+    {
+        uint index = (first + i) % m_threadCount;
+        Queue& queue = m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        bool own = t_workerPool == this && index == t_workerIndex;
+        if (own)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    m_pending--;
+    try
+    {
+        task();
+    }
+    catch (const std::exception& e)
+    {
+        Sapphire::Err("Parallel::ThreadPool --> task threw an exception: " + std::string(e.what()));
+    }
+    catch (...)
+    {
+        Sapphire::Err("Parallel::ThreadPool --> task threw an exception");
+    }
+    return true;
+}
+
+Sapphire::Parallel::ThreadPool& Sapphire::Parallel::GetDefaultPool()
+{
+    ThreadPool* pool = p_defaultPool.load(std::memory_order_acquire);
+    if (pool != nullptr) return *pool;
+
+    static ThreadPool defaultPool;
+    ThreadPool* expected = nullptr;
+    p_defaultPool.compare_exchange_strong(expected, &defaultPool, std::memory_order_acq_rel);
+    return *p_defaultPool.load(std::memory_order_acquire);
+}
+
+void Sapphire::Parallel::SetDefaultPool(ThreadPool& pool)
+{
+    p_defaultPool.store(&pool, std::memory_order_release);
+}
+
+Sapphire::Parallel::TaskGroup::TaskGroup(ThreadPool& pool)
+{
+    m_pool = &pool;
+    m_pending = 0;
+}
+
+Sapphire::Parallel::TaskGroup::~TaskGroup()
+{
+    waitAll();
+}
+
+void Sapphire::Parallel::TaskGroup::wait()
+{
+    waitAll();
+    if (m_error)
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void Sapphire::Parallel::TaskGroup::setError(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_error) m_error = error;
+}
+
+void Sapphire::Parallel::TaskGroup::finish()
+{
+    // Decrement under the lock, so a waiter cannot see zero and destroy the group while this is still using it.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_pending == 0) m_done.notify_all();
+}
+
+void Sapphire::Parallel::TaskGroup::waitAll()
+{
+    while (m_pending > 0)
+    {
+        if (m_pool->tryRunTask()) continue;
+
+        // Every task of the group has been picked up. Sleep until one finishes, but check back now and then in case
+        // a running task queues more work that this thread could help with.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, std::chrono::milliseconds(1), [this]() { return m_pending == 0; });
+    }
+
+    // The task that finished last may still hold the lock.
+    std::lock_guard<std::mutex> lock(m_mutex);
+}
+
 Sapphire::System::DisplayDevice::DisplayDevice() 
 {
     cardName = "";
@@ -1668,6 +2282,50 @@ std::vector<std::string> Sapphire::FileSystem::GetDirsInDirRecursive(const std::
     return paths;
 }
 
+void Sapphire::FileSystem::ParallelForEachInDirRecursive(const std::string& path, const std::function<void(const std::string& path, bool isDir)>& fn)
+{
+    if (p_logger != nullptr) if (!Exists(path))
+    {
+        p_logger->err("failed to iterate through directory (ParallelForEachInDirRecursive), path does not exist: \"" + path + "\"");
+        return;
+    }
+
+    // Every directory is listed by its own task, which queues a task for each of its subdirectories in the same group.
+    Sapphire::Parallel::TaskGroup group;
+    std::function<void(const std::filesystem::path&)> walk = [&](const std::filesystem::path& dir)
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            bool isDir = entry.is_directory();
+            fn(entry.path().string(), isDir);
+            if (isDir && !entry.is_symlink()) group.run([&walk, sub = entry.path()]() { walk(sub); });
+        }
+    };
+
+    group.run([&walk, root = std::filesystem::path(path)]() { walk(root); });
+    group.wait();
+}
+
+std::vector<std::string> Sapphire::FileSystem::ParallelGetFilesInDirRecursive(const std::string& path)
+{
+    if (p_logger != nullptr) if (!Exists(path))
+    {
+        p_logger->err("failed to iterate through directory (ParallelGetFilesInDirRecursive), path does not exist: \"" + path + "\"");
+        return {};
+    }
+
+    std::vector<std::string> paths;
+    std::mutex pathsMutex;
+    ParallelForEachInDirRecursive(path, [&](const std::string& file, bool isDir)
+    {
+        if (isDir) return;
+        std::lock_guard<std::mutex> lock(pathsMutex);
+        paths.push_back(file);
+    });
+
+    return paths;
+}
+
 Sapphire::FileSystem::File Sapphire::FileSystem::Write(const std::string& path, const std::string& contents)
 {
     if (p_logger != nullptr) if (GetDir(path) != "" && !Exists(GetDir(path))) 
@@ -1761,6 +2419,33 @@ std::vector<std::string> Sapphire::FileSystem::ReadLines(const std::string& path
     return lines;
 }
 
+bool Sapphire::FileSystem::WriteBinary(const std::string& path, const std::string& contents)
+{
+    if (GetDir(path) != "" && !Exists(GetDir(path)))
+    {
+        if (p_logger != nullptr) p_logger->err("failed to write to file, directory does not exist: \"" + GetDir(path) + "\"");
+        return false;
+    }
+
+    std::ofstream ostream(path, std::ios_base::binary);
+    ostream.write(contents.data(), contents.size());
+    ostream.close();
+
+    return !ostream.fail();
+}
+
+std::string Sapphire::FileSystem::ReadBinary(const std::string& path)
+{
+    if (!Exists(path))
+    {
+        if (p_logger != nullptr) p_logger->err("failed to read file, path does not exist: \"" + path + "\"");
+        return "";
+    }
+
+    std::ifstream istream(path, std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(istream), std::istreambuf_iterator<char>());
+}
+
 int Sapphire::FileSystem::GetSize(const std::string& path)
 {
     if (p_logger != nullptr) if (!Exists(path))